@@ -4,8 +4,12 @@ precision highp float;
 out vec4 FragColor;
 
 uniform vec4 u_color;
+uniform int u_material;
 uniform sampler2D u_diffuse;
 
+// gpu::MaterialParams, color then metallic and roughness, sized by gpu::createBuiltinUBOs
+#include "material_block.glsl"
+
 in vec2 UV;
 
 // in vec3 color;
@@ -13,6 +17,6 @@ in vec2 UV;
 void main()
 {
     vec4 diffuse = texture(u_diffuse, UV);
-    FragColor = vec4(diffuse * u_color);
+    FragColor = vec4(diffuse * u_materials[u_material * 2] * u_color);
     // FragColor = vec4(color, 1.0);
 }
\ No newline at end of file
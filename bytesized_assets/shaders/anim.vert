@@ -16,11 +16,20 @@ layout (std140) uniform CameraBlock
 //uniform mat4 u_view;
 uniform mat4 u_model;
 
-const int MAX_BONES = 32;
 const int MAX_BONE_INFLUENCE = 4;
-layout (std140) uniform SkinBlock {
-    mat4 u_bones[MAX_BONES];
-};
+const int PALETTE_WIDTH = 1024;
+uniform highp sampler2D u_skinPalette;
+uniform int u_paletteOffset;
+
+mat4 bone(uint index)
+{
+    int texel = (u_paletteOffset + int(index)) * 4;
+    ivec2 p = ivec2(texel % PALETTE_WIDTH, texel / PALETTE_WIDTH);
+    return mat4(texelFetch(u_skinPalette, p, 0),
+        texelFetch(u_skinPalette, p + ivec2(1, 0), 0),
+        texelFetch(u_skinPalette, p + ivec2(2, 0), 0),
+        texelFetch(u_skinPalette, p + ivec2(3, 0), 0));
+}
 
 out vec3 N;
 out vec2 UV;
@@ -39,10 +48,10 @@ const vec3 colors[6] = vec3[](
 
 void main()
 {
-    mat4 skinMatrix = u_bones[int(aJoints.x)] * aWeights.x
-        + u_bones[int(aJoints.y)] * aWeights.y
-        + u_bones[int(aJoints.z)] * aWeights.z
-        + u_bones[int(aJoints.w)] * aWeights.w;
+    mat4 skinMatrix = bone(aJoints.x) * aWeights.x
+        + bone(aJoints.y) * aWeights.y
+        + bone(aJoints.z) * aWeights.z
+        + bone(aJoints.w) * aWeights.w;
 
     mat4 world = u_model * skinMatrix;
 
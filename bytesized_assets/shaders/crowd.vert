@@ -0,0 +1,69 @@
+#version 330 core
+
+layout (location=0) in vec3 aPos;
+layout (location=1) in vec3 aNormal;
+layout (location=2) in vec2 aUV;
+layout (location=3) in uvec4 aJoints;
+layout (location=4) in vec4 aWeights;
+layout (location=7) in mat4 aModel;
+// first frame, frame count, frames per second, looping
+layout (location=11) in vec4 aClip;
+// time offset, playback rate
+layout (location=12) in vec2 aTiming;
+
+layout (std140) uniform CameraBlock
+{
+    mat4 u_projection;
+    mat4 u_view;
+    vec3 u_cameraPos;
+};
+
+uniform highp sampler2D u_animationBake;
+uniform float u_time;
+// the baked mesh relative to the skinned node, glTF meshes often sit on a child of it
+uniform mat4 u_mesh;
+
+mat4 bone(int frame, uint index)
+{
+    ivec2 p = ivec2(int(index) * 4, frame);
+    return mat4(texelFetch(u_animationBake, p, 0),
+        texelFetch(u_animationBake, p + ivec2(1, 0), 0),
+        texelFetch(u_animationBake, p + ivec2(2, 0), 0),
+        texelFetch(u_animationBake, p + ivec2(3, 0), 0));
+}
+
+// neighbouring frames are close enough for their matrices to be blended linearly
+mat4 bone(int frame, int next, float t, uint index)
+{
+    return mix(bone(frame, index), bone(next, index), t);
+}
+
+out vec3 N;
+out vec2 UV;
+out vec3 C;
+out vec3 P;
+
+void main()
+{
+    float last = max(aClip.y - 1.0, 1.0);
+    float f = (u_time * aTiming.y + aTiming.x) * aClip.z;
+    f = aClip.w > 0.5 ? mod(f, last) : clamp(f, 0.0, last);
+    int frame = int(aClip.x) + int(f);
+    int next = int(aClip.x) + min(int(f) + 1, int(aClip.y) - 1);
+    float t = fract(f);
+
+    mat4 skinMatrix = bone(frame, next, t, aJoints.x) * aWeights.x
+        + bone(frame, next, t, aJoints.y) * aWeights.y
+        + bone(frame, next, t, aJoints.z) * aWeights.z
+        + bone(frame, next, t, aJoints.w) * aWeights.w;
+
+    mat4 world = aModel * u_mesh * skinMatrix;
+
+    UV = aUV;
+    vec3 p = vec3(world * vec4(aPos, 1.0));
+    N = normalize(vec3(world * vec4(aNormal, 0.0)));
+    C = u_cameraPos;
+    P = p;
+
+    gl_Position = u_projection * u_view * vec4(p, 1.0);
+}
@@ -4,6 +4,7 @@ precision highp float;
 out vec4 FragColor;
 
 uniform vec4 u_color;
+uniform int u_material;
 uniform sampler2D u_diffuse;
 
 in vec3 N;
@@ -18,6 +19,9 @@ layout (std140) uniform LightBlock
     vec3 u_ambient;
 };
 
+// gpu::MaterialParams, color then metallic and roughness, sized by gpu::createBuiltinUBOs
+#include "material_block.glsl"
+
 const float toon_levels = 3.0;
 const float toon_factor = 1.0 / toon_levels;
 
@@ -26,7 +30,7 @@ void main()
     const vec3 up = vec3(0,1,0);
     const vec3 L = normalize(vec3(-1,1,1));
     vec4 diffuse = texture(u_diffuse, UV);
-    vec4 color = diffuse * u_color;
+    vec4 color = diffuse * u_materials[u_material * 2] * u_color;
     if(color.a < 0.001)  {
         discard;
     }
@@ -0,0 +1,24 @@
+#version 330 core
+precision highp float;
+
+out vec4 FragColor;
+
+uniform sampler2D u_diffuse;
+uniform vec4 u_bg_color;
+uniform int u_text;
+
+in vec4 Color;
+in vec2 UV;
+
+void main()
+{
+    vec4 diffuse = texture(u_diffuse, UV);
+    if(u_text != 0) {
+        FragColor = diffuse.r < 0.01 ? u_bg_color : vec4(diffuse.r) * Color;
+        return;
+    }
+    if(diffuse.a < 0.1) {
+        discard;
+    }
+    FragColor = diffuse * Color;
+}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <list>
 
 using ReplaceList = std::list<std::pair<const char *, const char *>>;
 
-void embed_to_cpp(const char *path, const char *out_dir, const ReplaceList &replaceList);
\ No newline at end of file
+void embed_to_cpp(const char *path, const char *out_dir, const ReplaceList &replaceList);
+void embed_data_to_cpp(const char *path, const uint8_t *bytes, size_t len, const char *out_file);
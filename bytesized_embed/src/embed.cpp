@@ -41,6 +41,12 @@ void embed_to_cpp(const char *in_file, const char *out_file, const ReplaceList &
         content = str;
     }
 
+    embed_data_to_cpp(in_file, reinterpret_cast<const uint8_t *>(content.data()),
+                      content.length(), out_file);
+}
+
+void embed_data_to_cpp(const char *in_file, const uint8_t *bytes, size_t len,
+                       const char *out_file) {
     in_file = dex::filename(in_file);
     std::string symbol_name{in_file};
     dex::replace(symbol_name, '.', '_');
@@ -53,15 +59,16 @@ void embed_to_cpp(const char *in_file, const char *out_file, const ReplaceList &
     FILE *file = fopen(out_file, "w");
     if (file == NULL) {
         printf("file can't be opened (w): %s\n", out_file);
+        return;
     }
     WRITE_TEXT(file, "#pragma once\nstatic const unsigned char _embed_");
     fwrite(symbol_name.c_str(), symbol_name.length(), 1, file);
     WRITE_TEXT(file, "[] = {");
 
     static char arr[] = " 0x00,";
-    for (size_t i{0}; i < content.length(); ++i) {
-        arr[3] = dex::to_hex(content[i] >> 4 & 0xF);
-        arr[4] = dex::to_hex(content[i] & 0xF);
+    for (size_t i{0}; i < len; ++i) {
+        arr[3] = dex::to_hex(bytes[i] >> 4 & 0xF);
+        arr[4] = dex::to_hex(bytes[i] & 0xF);
         fwrite(arr, sizeof(arr) - 1, 1, file);
     }
 
@@ -1,9 +1,48 @@
 #include "embed.h"
+#include "stb_image.h"
+#include "texpack.h"
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <utility>
 
-enum ParseMode { PARSE_NONE, PARSE_IN, PARSE_REPLACE_A, PARSE_REPLACE_B, PARSE_OUT };
+enum ParseMode {
+    PARSE_NONE,
+    PARSE_IN,
+    PARSE_REPLACE_A,
+    PARSE_REPLACE_B,
+    PARSE_OUT,
+    PARSE_TEXTURE
+};
+
+static bool _parseFormat(const char *name, texpack::Format &format) {
+    static constexpr std::pair<const char *, texpack::Format> formats[] = {
+        {"rgba8", texpack::RGBA8}, {"bc1", texpack::BC1},        {"bc3", texpack::BC3},
+        {"bc5", texpack::BC5},     {"etc2", texpack::ETC2_RGB8}, {"etc2a", texpack::ETC2_RGBA8},
+    };
+    for (const auto &[key, value] : formats) {
+        if (strcmp(name, key) == 0) {
+            format = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool _embedTexture(const char *infile, const char *outfile, texpack::Format format,
+                          bool flip) {
+    int iw, ih, ic;
+    stbi_set_flip_vertically_on_load(flip);
+    uint8_t *idata = stbi_load(infile, &iw, &ih, &ic, 4);
+    if (idata == nullptr) {
+        printf("Error: Failed to decode image: %s\n", infile);
+        return false;
+    }
+    auto packed = texpack::pack(idata, iw, ih, format);
+    stbi_image_free(idata);
+    embed_data_to_cpp(infile, packed.data(), packed.size(), outfile);
+    return true;
+}
 int main(int argc, char *argv[]) {
     printf("embed_main: %s\n", argv[0]);
     ParseMode mode = PARSE_NONE;
@@ -11,6 +50,8 @@ int main(int argc, char *argv[]) {
     const char *infile = nullptr;
     const char *replaceA = nullptr;
     const char *replaceB = nullptr;
+    const char *textureFormat = nullptr;
+    bool flip{false};
     ReplaceList replaceList;
     for (int i{1}; i < argc; ++i) {
         if (strcmp(argv[i], "-i") == 0) {
@@ -19,6 +60,10 @@ int main(int argc, char *argv[]) {
             mode = PARSE_OUT;
         } else if (strcmp(argv[i], "-r") == 0) {
             mode = PARSE_REPLACE_A;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            mode = PARSE_TEXTURE;
+        } else if (strcmp(argv[i], "-f") == 0) {
+            flip = true;
         } else {
             switch (mode) {
             default:
@@ -40,6 +85,10 @@ int main(int argc, char *argv[]) {
                 replaceList.emplace_back(replaceA, replaceB);
                 mode = PARSE_NONE;
                 break;
+            case PARSE_TEXTURE:
+                textureFormat = argv[i];
+                mode = PARSE_NONE;
+                break;
             }
         }
     }
@@ -52,6 +101,14 @@ int main(int argc, char *argv[]) {
         str = std::string{infile} + ".hpp";
         outfile = str.c_str();
     }
+    if (textureFormat) {
+        texpack::Format format;
+        if (!_parseFormat(textureFormat, format)) {
+            printf("Error: Unknown texture format: %s\n", textureFormat);
+            return 1;
+        }
+        return _embedTexture(infile, outfile, format, flip) ? 0 : 1;
+    }
     embed_to_cpp(infile, outfile, replaceList);
     return 0;
 }
\ No newline at end of file
@@ -3,12 +3,14 @@
 #include "embed/anim_frag.hpp"
 #include "embed/anim_vert.hpp"
 #include "embed/billboard_vert.hpp"
+#include "embed/crowd_vert.hpp"
 #include "embed/object_frag.hpp"
 #include "embed/object_vert.hpp"
 #include "embed/screen_vert.hpp"
 #include "embed/text_frag.hpp"
 #include "embed/text_vert.hpp"
 #include "embed/texture_frag.hpp"
+#include "embed/ui_frag.hpp"
 #include "embed/ui_vert.hpp"
 #include "gpu.h"
 #include "uniform.h"
@@ -29,7 +31,9 @@ namespace builtin {
     __SHADER(ANIM_FRAG, _embed_anim_frag, GL_FRAGMENT_SHADER)                                      \
     __SHADER(TEXT_FRAG, _embed_text_frag, GL_FRAGMENT_SHADER)                                      \
     __SHADER(UI_VERT, _embed_ui_vert, GL_VERTEX_SHADER)                                            \
-    __SHADER(BILLBOARD_VERT, _embed_billboard_vert, GL_VERTEX_SHADER)
+    __SHADER(UI_FRAG, _embed_ui_frag, GL_FRAGMENT_SHADER)                                          \
+    __SHADER(BILLBOARD_VERT, _embed_billboard_vert, GL_VERTEX_SHADER)                              \
+    __SHADER(CROWD_VERT, _embed_crowd_vert, GL_VERTEX_SHADER)
 
 enum Shader {
 #define __SHADER(label, str, type) label,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "bdf.h"
+#include "blur_renderer.h"
 #include "camera.h"
 #include "clicknpick.h"
 #include "console.h"
@@ -10,6 +11,7 @@
 #include "gui.h"
 #include "panel.h"
 #include "persist.h"
+#include "staticbatch.h"
 #include "window.h"
 #include <list>
 
@@ -92,7 +94,7 @@ struct Engine : public window::IWindowApp,
 
     void _openCollection(const gpu::Collection &collection);
 
-    void renderClickables(gpu::ShaderProgram *shaderProgram, uint8_t &id) override;
+    void addClickables() override;
     bool nodeClicked(size_t index) override;
 
     bool saveNodeInfo(gpu::Node *node, uint32_t &info) override;
@@ -119,13 +121,14 @@ struct Engine : public window::IWindowApp,
     gpu::ShaderProgram *animProgram;
     gpu::ShaderProgram *textProgram;
     gpu::ShaderProgram *uiProgram;
-    gpu::ShaderProgram *uiTextProgram;
-    gpu::ShaderProgram *clickProgram;
-    gpu::ShaderProgram *clickAnimProgram;
     gpu::ShaderProgram *screenProgram;
     std::vector<gpu::Node *> nodes;
     std::vector<gpu::Node *> skinNodes;
-    std::vector<gpu::Node *> textNodes;
+    std::vector<gpu::Text *> texts;
+    gpu::TextBatch textBatch;
+    StaticBatch staticBatch;
+    BlurRenderer blurRenderer;
+    StaticBatch saveFileBatch;
     GUI gui;
     std::list<gpu::Collection> _collections;
     persist::SaveFile _saveFile;
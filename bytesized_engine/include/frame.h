@@ -1,9 +1,10 @@
 #pragma once
 
 #include "gpu.h"
+#include "sprite.h"
 
 struct Frame {
-    void createPanel(float width, float height, gpu::Texture *texture);
+    void createPanel(float width, float height, gpu::Texture *texture, const AtlasRegion &region);
     void createText(const bdf::Font &font, float x, float y, float scale, const char *value,
                     bool center, const Color &textColor);
 
@@ -19,10 +20,13 @@ struct Frame {
     float width() const;
     float height() const;
 
-    void renderPanels(gpu::ShaderProgram *shaderProgram);
-    void renderTexts(gpu::ShaderProgram *shaderProgram);
+    void addPanels(gpu::UIBatch &uiBatch);
+    void addTexts(gpu::UIBatch &uiBatch);
 
     gpu::Node *node;
     gpu::Text *text;
+    gpu::Texture *texture;
+    AtlasRegion region;
+    Color color;
     std::vector<Frame> children;
-};
\ No newline at end of file
+};
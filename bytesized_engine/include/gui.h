@@ -11,15 +11,19 @@ struct GUI {
         FPS = (1 << 1),
         NODE_INFO = (1 << 2),
         TITLE = (1 << 3),
+        STATS = (1 << 4),
         EVERYTHING = 0xFFFFFFFF,
     };
     void create(bdf::Font *font, float width, float height, float em, Options options);
 
-    void render(gpu::ShaderProgram *frameProgram, gpu::ShaderProgram *textProgram);
+    /// @brief Draws all panels, then all texts, through one UI batch.
+    void render(gpu::ShaderProgram *shaderProgram);
 
     gpu::Text *setTitleText(const char *value);
     gpu::Text *setConsoleText(const char *value);
     gpu::Text *setFps(float fps);
+    gpu::Text *setStats(const char *value);
+    void showStats(bool visible);
     void setNodeInfo(const char *scene, const char *name, uint32_t id, const char *mesh,
                      const char *componentInfo, const glm::vec3 &translation,
                      const glm::vec3 &euler, const glm::vec3 &scale);
@@ -31,6 +35,10 @@ struct GUI {
     float em;
     glm::mat4 projection;
     glm::mat4 view;
+    Color textColor{0x081820};
+    gpu::Texture *atlas{nullptr};
+    gpu::Texture *nodeInfoTexture{nullptr};
+    gpu::UIBatch uiBatch;
 
     enum NodeInfoDetail {
         NODE_INFO_TITLE,
@@ -43,6 +51,13 @@ struct GUI {
     };
     gpu::Text *nodeInfoRows[NODE_INFO_COUNT];
 
-    enum Frames { FRAME_FPS, FRAME_CONSOLE, FRAME_NODE_INFO, FRAME_TITLE, FRAME_COUNT };
+    enum Frames {
+        FRAME_FPS,
+        FRAME_CONSOLE,
+        FRAME_NODE_INFO,
+        FRAME_TITLE,
+        FRAME_STATS,
+        FRAME_COUNT
+    };
     Frame frames[FRAME_COUNT];
 };
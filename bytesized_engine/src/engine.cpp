@@ -9,12 +9,18 @@
 #include "gpu.h"
 #include "gpu_primitive.h"
 #include "gui.h"
+#include "jobs.h"
+#include "occlusion.h"
 #include "persist.h"
+#include "picking.h"
 #include "playercontroller.h"
 #include "primer.h"
+#include "rendergraph.h"
 #include "skydome.h"
 #include <algorithm>
+#include <cfloat>
 #include <list>
+#include <unordered_map>
 
 gpu::Collection *Engine::addCollection(const library::Collection &collection) {
     return &_collections.emplace_back(collection);
@@ -23,7 +29,6 @@ gpu::Collection *Engine::addGLB(const uint8_t *data) {
     return addCollection(*library::loadGLB(data, true));
 }
 
-static gpu::Framebuffer *fbo{nullptr};
 static persist::SessionData sessionData;
 static gpu::Node *gridNode{nullptr};
 constexpr gpu::Plane<1, 1> grid(64.0f);
@@ -160,17 +165,6 @@ void Engine::attachController(gpu::Node *node, geom::Geometry::Type type) {
     ctrl.jumpCount = 2;
 }
 
-static const char *_clickNPickFrag = BYTESIZED_GLSL_VERSION R"(
-precision highp float;
-out vec4 FragColor;
-in vec2 UV;
-uniform float u_object_id;
-void main()
-{ 
-    FragColor.r = u_object_id / 255.0;
-}
-)";
-
 void Engine::init(int drawableWidth, int drawableHeight) {
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
@@ -188,6 +182,12 @@ void Engine::init(int drawableWidth, int drawableHeight) {
     // create all gpu objects
     gpu::allocate();
 
+    jobs::start();
+
+#ifdef BYTESIZED_SHADERCACHE_DIR
+    gpu::openProgramCache(BYTESIZED_SHADERCACHE_DIR);
+#endif
+
     gpu::createBuiltinUBOs();
 
     auto builtinGeoms = _collections.emplace_back(*gpu::createBuiltinPrimitives());
@@ -195,22 +195,32 @@ void Engine::init(int drawableWidth, int drawableHeight) {
     font = bdf::createFont((const char *)_embed_boxxy_bdf, sizeof(_embed_boxxy_bdf));
     gui.create(font, _windowWidth, _windowHeight, 2.0f, GUI::EVERYTHING);
 
-    const glm::vec4 defaultColor = Color::green.vec4();
+    // u_color tints the material color from the MaterialBlock
+    const glm::vec4 defaultColor = Color::white.vec4();
 
-    shaderProgram = gpu::createShaderProgram(
-        builtin::shader(builtin::OBJECT_VERT), builtin::shader(builtin::OBJECT_FRAG),
-        {{"u_color", defaultColor}, {"u_diffuse", 0}, {"u_model", glm::mat4{1.0f}}});
+    shaderProgram = gpu::createShaderProgram(builtin::shader(builtin::OBJECT_VERT),
+                                             builtin::shader(builtin::OBJECT_FRAG),
+                                             {{"u_color", defaultColor},
+                                              {"u_material", 0},
+                                              {"u_diffuse", 0},
+                                              {"u_model", glm::mat4{1.0f}}});
 
-    billboardProgram = gpu::createShaderProgram(
-        builtin::shader(builtin::BILLBOARD_VERT), builtin::shader(builtin::OBJECT_FRAG),
-        {{"u_color", defaultColor}, {"u_diffuse", 0}, {"u_model", glm::mat4{1.0f}}});
+    billboardProgram = gpu::createShaderProgram(builtin::shader(builtin::BILLBOARD_VERT),
+                                                builtin::shader(builtin::OBJECT_FRAG),
+                                                {{"u_color", defaultColor},
+                                                 {"u_material", 0},
+                                                 {"u_diffuse", 0},
+                                                 {"u_model", glm::mat4{1.0f}}});
 
     animProgram = gpu::createShaderProgram(builtin::shader(builtin::ANIM_VERT),
                                            builtin::shader(builtin::OBJECT_FRAG),
                                            {//{"u_projection", perspectiveProjection},
                                             //{"u_view", glm::mat4{1.0f}},
                                             {"u_color", defaultColor},
+                                            {"u_material", 0},
                                             {"u_diffuse", 0},
+                                            {"u_skinPalette", int(gpu::SKIN_PALETTE_UNIT)},
+                                            {"u_paletteOffset", 0},
                                             {"u_model", glm::mat4{1.0f}}});
 
     const Color bgColor(0xe0f8d0);
@@ -224,20 +234,12 @@ void Engine::init(int drawableWidth, int drawableHeight) {
                                             {"u_metallic", 1.0f},
                                             {"u_time", 0.0f}});
 
-    gpu::Shader *clickNPickShader = gpu::createShader(GL_FRAGMENT_SHADER, _clickNPickFrag);
-    clickProgram = gpu::createShaderProgram(builtin::shader(builtin::OBJECT_VERT), clickNPickShader,
-                                            {{"u_model", glm::mat4{1.0f}}, {"u_object_id", 0.0f}});
-    clickAnimProgram =
-        gpu::createShaderProgram(builtin::shader(builtin::ANIM_VERT), clickNPickShader,
-                                 {{"u_model", glm::mat4{1.0f}}, {"u_object_id", 0.0f}});
     gpu::builtinUBO(gpu::UBO_CAMERA)
         ->bindShaders({
             shaderProgram,
             billboardProgram,
             animProgram,
             textProgram,
-            clickProgram,
-            clickAnimProgram,
         });
     gpu::builtinUBO(gpu::UBO_LIGHT)
         ->bindShaders({
@@ -246,46 +248,34 @@ void Engine::init(int drawableWidth, int drawableHeight) {
             animProgram,
             textProgram,
         });
-    gpu::builtinUBO(gpu::UBO_SKINNING)->bindShaders({animProgram, clickAnimProgram});
+    gpu::builtinUBO(gpu::UBO_MATERIAL)
+        ->bindShaders({
+            shaderProgram,
+            billboardProgram,
+            animProgram,
+        });
 
     uiProgram = gpu::createShaderProgram(builtin::shader(builtin::UI_VERT),
-                                         builtin::shader(builtin::TEXTURE_FRAG),
+                                         builtin::shader(builtin::UI_FRAG),
                                          {{"u_projection", gui.projection},
                                           {"u_view", gui.view},
+                                          {"u_bg_color", bgColor.vec4()},
                                           {"u_diffuse", 0},
-                                          {"u_model", glm::mat4{1.0f}}});
-
-    uiTextProgram = gpu::createShaderProgram(builtin::shader(builtin::UI_VERT),
-                                             builtin::shader(builtin::TEXT_FRAG),
-                                             {{"u_projection", gui.projection},
-                                              {"u_view", gui.view},
-                                              {"u_bg_color", bgColor.vec4()},
-                                              {"u_text_color", textColor.vec4()},
-                                              {"u_diffuse", 0},
-                                              {"u_model", glm::mat4{1.0f}},
-                                              {"u_metallic", 0.0f},
-                                              {"u_time", 0.0f}});
+                                          {"u_text", 0}});
 
     skydome::create();
     screenProgram =
         gpu::createShaderProgram(builtin::shader(builtin::SCREEN_VERT),
                                  builtin::shader(builtin::TEXTURE_FRAG), {{"u_texture", 0}});
-    fbo = gpu::createFramebuffer();
-    fbo->bind();
-    fbo->createTexture(GL_COLOR_ATTACHMENT0, _windowWidth * 2, _windowHeight * 2,
-                       gpu::ChannelSetting::RGB, GL_UNSIGNED_BYTE);
-    fbo->createDepthStencil(_windowWidth * 2, _windowHeight * 2);
-    fbo->checkStatus("engine.fbo");
-    fbo->unbind();
-    _clickNPick.create(_windowWidth, _windowHeight, perspectiveProjection, 0.1f, clickProgram);
-    _clickNPick.shaderPrograms.push_back(clickAnimProgram);
+    _clickNPick.create(_windowWidth, _windowHeight, perspectiveProjection, _camera);
 
     gridNode = gpu::createNode();
     gridNode->hidden = true;
     gridNode->mesh = gpu::createMesh();
     auto gridPrim = gpu::createPrimitive(grid.positions, grid.normals, grid.uvs, grid.CELLS,
                                          grid.indices, grid.CELLS * 6);
-    gridNode->mesh->primitives.emplace_back(gridPrim, gpu::builtinMaterial(gpu::GRID_TILE));
+    gridNode->mesh->primitives.emplace_back(
+        gridPrim, gpu::retainMaterial(gpu::builtinMaterial(gpu::GRID_TILE)));
     gridNode->translation = {0.0f, 0.01f, 0.0f};
     gridNode->rotation = glm::angleAxis(glm::radians(-90.0f), glm::vec3{1.0f, 0.0f, 0.0f});
     gridNode->scale = glm::vec3{64.0f, 64.0f, 64.0f};
@@ -295,6 +285,10 @@ void Engine::init(int drawableWidth, int drawableHeight) {
     _console.setSetting("wiremode", "0");
     _console.setSetting("tstep", "0");
     _console.setSetting("rstep", "0");
+    _console.setSetting("occlusion", "1");
+    _console.setSetting("blur", "0");
+    _console.setSetting("animlod", "1");
+    _console.setSetting("stats", "0");
     _console.addCustomCommand(":static ", [this](const char *key) {
         if (auto sel = _editor.selectedNode()) {
             attachCollider(sel, _parseGeometryType(key + strlen(":static ")), false);
@@ -319,6 +313,50 @@ void Engine::init(int drawableWidth, int drawableHeight) {
         }
         return false;
     });
+    _console.addCustomCommand(":passes", [](const char * /*key*/) {
+        for (const auto &pass : rendergraph::stats()) {
+            printf("%-12s %s %.3f ms\n", pass.name, pass.culled ? "culled" : "      ", pass.cpuMs);
+        }
+        printf("%zu transient textures\n", rendergraph::textureCount());
+        return true;
+    });
+    _console.addCustomCommand(":stats.capture ", [](const char *cmd) {
+        return gpu::Stats_startCapture(cmd + strlen(":stats.capture "));
+    });
+    _console.addCustomCommand(":stats.stop", [](const char * /*key*/) {
+        gpu::Stats_stopCapture();
+        return true;
+    });
+    _console.addCustomCommand(":stats", [](const char * /*key*/) {
+        gpu::Stats_print();
+        return true;
+    });
+    // :budget dc=<draw calls> tri=<triangles> st=<state changes> buf=<bytes> tex=<bytes>
+    _console.addCustomCommand(":budget", [](const char *cmd) {
+        gpu::RenderBudget budget{};
+        const char *p = cmd + strlen(":budget");
+        char key[8];
+        unsigned long long value;
+        int consumed;
+        while (sscanf(p, " %7[a-z]=%llu%n", key, &value, &consumed) == 2) {
+            if (strcmp(key, "dc") == 0) {
+                budget.drawCalls = static_cast<uint32_t>(value);
+            } else if (strcmp(key, "tri") == 0) {
+                budget.triangles = value;
+            } else if (strcmp(key, "st") == 0) {
+                budget.stateChanges = static_cast<uint32_t>(value);
+            } else if (strcmp(key, "buf") == 0) {
+                budget.bufferBytes = value;
+            } else if (strcmp(key, "tex") == 0) {
+                budget.textureBytes = value;
+            } else {
+                return false;
+            }
+            p += consumed;
+        }
+        gpu::Stats_setBudget(budget);
+        return true;
+    });
     _console.addCustomCommand(":c.pitch=", [this](const char *cmd) {
         _camera.targetView.pitch = std::atof(cmd + strlen(":c.pitch="));
         return true;
@@ -406,8 +444,17 @@ bool Engine::update(float dt) {
                 vec.hidden = true;
             }
         }
+        _clickNPick.update();
     }
     _camera.update(dt);
+    // with animlod off every skin is sampled every tick
+    static const gpu::AnimationLodSettings fullRate{0.0f, 0.0f, 0.0f, FLT_MAX,
+                                                    gpu::RATE_EVERY_TICK};
+    gpu::AnimationLod_update(perspectiveProjection, _camera.view(),
+                             _panel && _panel->type == Panel::SAVE_FILE ? _saveFile.nodes
+                                                                        : skinNodes,
+                             _console.settingBool("animlod") ? gpu::AnimationLodSettings{}
+                                                             : fullRate);
     gpu::animate(dt);
     return true;
 }
@@ -429,6 +476,44 @@ void Engine::endGame() {
     _editor.disable(false);
 }
 
+static void _renderSelected(gpu::ShaderProgram *shaderProgram, gpu::Node *node) {
+    // own materials, the builtin white is shared by billboards and untextured meshes
+    static gpu::Material *fillMat = [] {
+        gpu::Material *mat = gpu::createMaterial(gpu::builtinMaterial(gpu::WHITE)->textures[0]);
+        mat->color = Color(0x44AAFF) * Color::opacity(0.4f);
+        return mat;
+    }();
+    static gpu::Material *wireMat = [] {
+        gpu::Material *mat = gpu::createMaterial(gpu::builtinMaterial(gpu::WHITE)->textures[0]);
+        mat->color = Color(0x44FFAA) * Color::opacity(0.7f);
+        return mat;
+    }();
+    gpu::setOverrideMaterial(fillMat);
+    node->render(shaderProgram);
+    gpu::setOverrideMaterial(wireMat);
+    node->recursive([](gpu::Node *n) { n->wireframe = true; });
+    node->render(shaderProgram);
+    node->recursive([](gpu::Node *n) { n->wireframe = false; });
+    gpu::setOverrideMaterial(nullptr);
+}
+
+static void _tintController(gpu::Node *node) {
+    if (auto entity = node->entity) {
+        if (Controller *ctrl = CController::get_pointer(entity)) {
+            static gpu::Material *ctrlMat =
+                gpu::createMaterial(gpu::builtinMaterial(gpu::WHITE)->textures[0]);
+            auto meshNode = node->find([](gpu::Node *node) { return node->mesh; });
+            gpu::Material *&material = meshNode->mesh->primitives.front().second;
+            if (material != ctrlMat) {
+                gpu::freeMaterial(material);
+                material = gpu::retainMaterial(ctrlMat);
+            }
+            meshNode->material()->color =
+                (ctrl && ctrl->state == Controller::STATE_ON_GROUND) ? Color::blue : Color::red;
+        }
+    }
+}
+
 static void _renderNodes(Editor &editor, gpu::ShaderProgram *shaderProgram,
                          std::vector<gpu::Node *> &nodes, bool skinned) {
     for (auto *node : nodes) {
@@ -439,34 +524,211 @@ static void _renderNodes(Editor &editor, gpu::ShaderProgram *shaderProgram,
             continue;
         }
         if (node == editor.selectedNode()) {
-            auto mat = gpu::builtinMaterial(gpu::BuiltinMaterial::WHITE);
-            mat->color = Color(0x44AAFF) * Color::opacity(0.4f);
-            gpu::setOverrideMaterial(mat);
-            node->render(shaderProgram);
-            mat->color = Color(0x44FFAA) * Color::opacity(0.7f);
-            node->recursive([](gpu::Node *n) { n->wireframe = true; });
-            node->render(shaderProgram);
-            node->recursive([](gpu::Node *n) { n->wireframe = false; });
-            gpu::setOverrideMaterial(nullptr);
+            _renderSelected(shaderProgram, node);
             continue;
         }
-        if (auto entity = node->entity) {
-            if (Controller *ctrl = CController::get_pointer(entity)) {
-                static gpu::Material *ctrlMat =
-                    gpu::createMaterial(gpu::builtinMaterial(gpu::WHITE)->textures.at(GL_TEXTURE0));
-                auto meshNode = node->find([](gpu::Node *node) { return node->mesh; });
-                meshNode->mesh->primitives.front().second = ctrlMat;
-                meshNode->material()->color =
-                    (ctrl && ctrl->state == Controller::STATE_ON_GROUND) ? Color::blue : Color::red;
+        _tintController(node);
+        node->render(shaderProgram);
+    }
+}
+
+/// @brief Nodes that nothing moves at runtime, these are baked into a StaticBatch when staged.
+static bool _isStatic(gpu::Node *node) {
+    return node->skin == nullptr && !CActor::has(node->entity) &&
+           !CController::has(node->entity) && !CBillboard::has(node->entity);
+}
+
+/// @brief The selected node is edited and leaves the batch, the one selected before goes back.
+static void _bakeStatic(StaticBatch &batch, gpu::Node *selected) {
+    if (gpu::Node *previous = batch.exclude(selected)) {
+        if (_isStatic(previous)) {
+            batch.add(previous);
+        }
+    }
+    batch.bake();
+}
+
+static constexpr size_t RECORD_GRAIN = 16;
+
+/// @brief Static nodes are recorded on the workers, one command buffer per range of root nodes,
+/// then merged, sorted and replayed here on the GL thread.
+static void _recordNodes(Editor &editor, gpu::ShaderProgram *shaderProgram,
+                         std::vector<gpu::Node *> &nodes, StaticBatch &baked, bool cull) {
+    static std::vector<gpu::CommandBuffer> buffers;
+    static std::vector<gpu::DrawCommand> commands;
+    gpu::Node *selected = editor.selectedNode();
+    // the controller material is shared, tint it before any worker reads it
+    for (auto *node : nodes) {
+        if (node->skin == nullptr && node != selected) {
+            _tintController(node);
+        }
+    }
+    buffers.resize((nodes.size() + RECORD_GRAIN - 1) / RECORD_GRAIN);
+    jobs::parallelFor(nodes.size(), RECORD_GRAIN,
+                      [&nodes, &baked, selected](size_t begin, size_t end) {
+                          gpu::CommandBuffer &buffer = buffers[begin / RECORD_GRAIN];
+                          buffer.clear();
+                          for (size_t i{begin}; i < end; ++i) {
+                              gpu::Node *node = nodes[i];
+                              if (node->skin || node == selected || CBillboard::has(node->entity) ||
+                                  baked.contains(node)) {
+                                  continue;
+                              }
+                              node->record(buffer);
+                          }
+                      });
+    gpu::mergeCommands(buffers, commands);
+    gpu::submitCommands(shaderProgram, commands);
+    baked.render(shaderProgram, cull);
+    if (selected && selected->skin == nullptr &&
+        std::find(nodes.begin(), nodes.end(), selected) != nodes.end()) {
+        _renderSelected(shaderProgram, selected);
+    }
+}
+
+static bool _isOccluder(gpu::Node *node) {
+    return node->libraryNode && node->libraryNode->name.starts_with("O__");
+}
+
+// keyed by pointers into the staged collections, cleared when they are unstaged
+static std::unordered_map<const library::Mesh *, occlusion::Bounds> _meshBoundsCache;
+
+struct Occluder {
+    glm::mat4 model;
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+};
+static std::unordered_map<const gpu::Node *, Occluder> _occluders;
+
+static const occlusion::Bounds &_meshBounds(const library::Mesh *mesh) {
+    auto &cache = _meshBoundsCache;
+    auto it = cache.find(mesh);
+    if (it == cache.end()) {
+        occlusion::Bounds bounds{glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX}};
+        for (const auto &primitive : mesh->primitives) {
+            auto [positions, length] = primitive.positions();
+            for (size_t i{0}; i < length; ++i) {
+                bounds.min = glm::min(bounds.min, positions[i]);
+                bounds.max = glm::max(bounds.max, positions[i]);
             }
         }
-        node->render(shaderProgram);
+        it = cache.emplace(mesh, bounds).first;
     }
+    return it->second;
+}
+
+template <typename T>
+static void _appendOccluder(Occluder &occluder, const glm::vec3 *positions, size_t length,
+                            const T *indices, size_t count) {
+    const uint32_t base = static_cast<uint32_t>(occluder.positions.size());
+    for (size_t i{0}; i < length; ++i) {
+        occluder.positions.emplace_back(occluder.model * glm::vec4{positions[i], 1.0f});
+    }
+    for (size_t i{0}; i < count; ++i) {
+        occluder.indices.push_back(base + indices[i]);
+    }
+}
+
+static void _addOccluders(gpu::Node *node) {
+    node->recursive([](gpu::Node *n) {
+        if (!_isOccluder(n) || n->mesh == nullptr || n->mesh->libraryMesh == nullptr) {
+            return;
+        }
+        n->hidden = true;
+        // occluders are kept in world space and only transformed again when they move
+        const glm::mat4 &model = n->model();
+        auto [it, added] = _occluders.try_emplace(n);
+        Occluder &occluder = it->second;
+        if (added || occluder.model != model) {
+            occluder.model = model;
+            occluder.positions.clear();
+            occluder.indices.clear();
+            for (const auto &primitive : n->mesh->libraryMesh->primitives) {
+                auto [positions, length] = primitive.positions();
+                library::Accessor *indices = primitive.indices;
+                if (indices == nullptr) {
+                    continue;
+                }
+                if (indices->componentType == GL_UNSIGNED_INT) {
+                    _appendOccluder(occluder, positions, length,
+                                    (const uint32_t *)indices->data(), indices->count);
+                } else if (indices->componentType == GL_UNSIGNED_SHORT) {
+                    _appendOccluder(occluder, positions, length,
+                                    (const uint16_t *)indices->data(), indices->count);
+                }
+            }
+        }
+        occlusion::addOccluder(glm::mat4{1.0f}, occluder.positions.data(),
+                               occluder.positions.size(), occluder.indices.data(),
+                               occluder.indices.size());
+    });
+}
+
+static std::vector<gpu::Node *> &_cullNodes(const glm::mat4 &viewProjection,
+                                            const std::vector<gpu::Node *> &nodes,
+                                            const StaticBatch &baked) {
+    static std::vector<gpu::Node *> visibleNodes;
+    static std::vector<gpu::Node *> occludees;
+    static std::vector<occlusion::Bounds> bounds;
+    static std::vector<uint8_t> visible;
+    occlusion::begin(viewProjection);
+    for (gpu::Node *node : nodes) {
+        _addOccluders(node);
+    }
+    occlusion::rasterize();
+
+    visibleNodes.clear();
+    occludees.clear();
+    bounds.clear();
+    for (gpu::Node *node : nodes) {
+        // baked nodes still occlude, their cells are tested by the batch
+        if (baked.contains(node)) {
+            continue;
+        }
+        occlusion::Bounds b{glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX}};
+        node->recursive([&b](gpu::Node *n) {
+            if (n->hidden || n->mesh == nullptr || n->mesh->libraryMesh == nullptr) {
+                return;
+            }
+            const occlusion::Bounds &local = _meshBounds(n->mesh->libraryMesh);
+            const glm::mat4 &model = n->model();
+            for (int i{0}; i < 8; ++i) {
+                glm::vec3 corner{model * glm::vec4{(i & 1) ? local.max.x : local.min.x,
+                                                   (i & 2) ? local.max.y : local.min.y,
+                                                   (i & 4) ? local.max.z : local.min.z, 1.0f}};
+                b.min = glm::min(b.min, corner);
+                b.max = glm::max(b.max, corner);
+            }
+        });
+        // skinned meshes move outside of their bind pose bounds
+        if (node->skin || b.min.x > b.max.x) {
+            visibleNodes.push_back(node);
+            continue;
+        }
+        occludees.push_back(node);
+        bounds.push_back(b);
+    }
+    visible.resize(occludees.size());
+    occlusion::testVisibility(bounds.data(), bounds.size(), visible.data());
+    for (size_t i{0}; i < occludees.size(); ++i) {
+        if (visible[i]) {
+            visibleNodes.push_back(occludees[i]);
+        }
+    }
+    return visibleNodes;
 }
 
 void Engine::draw() {
     const glm::mat4 &view = _camera.view();
 
+    gpu::Stats_beginFrame();
+    gpu::UniformStream_beginFrame();
+    gpu::TextureLoader_upload();
+    gpu::updateSkinPalettes(_panel && _panel->type == Panel::SAVE_FILE ? _saveFile.nodes
+                                                                       : skinNodes);
+    _bakeStatic(_panel && _panel->type == Panel::SAVE_FILE ? saveFileBatch : staticBatch,
+                _editor.selectedNode());
+
     gpu::CameraBlock_setViewPos(view, _camera.currentView.center -
                                           _camera.orientation() * _camera.currentView.distance);
 
@@ -474,92 +736,120 @@ void Engine::draw() {
         _iGame->gameDraw();
     } else {
         float t = Time::seconds();
-        _clickNPick.update();
 
-        fbo->bind();
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-        glStencilMask(0x00);
-        // glViewport(0.0f, 0.0f, window::DRAWABLE_WIDTH * 0.5f, window::DRAWABLE_HEIGHT);
-
-        if (_console.settingBool("wiremode")) {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        }
-
-        if (_panel) {
-            if (_panel->type == Panel::SAVE_FILE) {
-                shaderProgram->use();
-                _renderNodes(_editor, shaderProgram, _saveFile.nodes, false);
-
-                billboardProgram->use();
-                for (gpu::Node *node : _saveFile.nodes) {
-                    if (auto *billboard = CBillboard::get_pointer(node->entity)) {
-                        billboardProgram->uniforms.at("u_color") << Color::white.vec4();
-                        billboardProgram->uniforms.at("u_model") << node->model();
-                        glActiveTexture(GL_TEXTURE0);
-                        billboard->texture->bind();
-                        node->primitive()->render();
+        rendergraph::begin(_drawableWidth, _drawableHeight);
+        const uint32_t width = _windowWidth * 2;
+        const uint32_t height = _windowHeight * 2;
+        const rendergraph::TextureDesc colorDesc{width, height, gpu::ChannelSetting::RGB,
+                                                 GL_UNSIGNED_BYTE};
+        const rendergraph::Resource sceneColor =
+            rendergraph::createTexture("scene.color", colorDesc);
+        const rendergraph::Resource sceneDepth = rendergraph::createTexture(
+            "scene.depth", {width, height, gpu::ChannelSetting::DS, GL_UNSIGNED_INT_24_8});
+
+        rendergraph::addPass("scene", {}, {sceneColor, sceneDepth}, [this, &view, t] {
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+            glStencilMask(0x00);
+
+            if (_console.settingBool("wiremode")) {
+                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            }
+            const bool cull = _console.settingBool("occlusion");
+
+            if (_panel) {
+                if (_panel->type == Panel::SAVE_FILE) {
+                    shaderProgram->use();
+                    _recordNodes(_editor, shaderProgram,
+                                 cull ? _cullNodes(perspectiveProjection * view, _saveFile.nodes,
+                                                   saveFileBatch)
+                                      : _saveFile.nodes,
+                                 saveFileBatch, cull);
+
+                    billboardProgram->use();
+                    gpu::bindMaterial(billboardProgram, gpu::builtinMaterial(gpu::WHITE));
+                    for (gpu::Node *node : _saveFile.nodes) {
+                        if (auto *billboard = CBillboard::get_pointer(node->entity)) {
+                            billboardProgram->uniforms.at("u_model") << node->model();
+                            billboard->texture->bind();
+                            node->primitive()->render();
+                        }
                     }
-                }
 
-                animProgram->use();
-                // animProgram->uniforms.at("u_view") << view;
-                _renderNodes(_editor, animProgram, _saveFile.nodes, true);
-            } else {
-                // render objects
-                shaderProgram->use();
-                _renderNodes(_editor, shaderProgram, nodes, false);
-
-                // render skeletal animations
-                animProgram->use();
-                // animProgram->uniforms.at("u_view") << view;
-                _renderNodes(_editor, animProgram, skinNodes, true);
-
-                // render texts
-                textProgram->use();
-                textProgram->uniforms.at("u_time") << t;
-                for (gpu::Node *node : textNodes) {
-                    node->render(textProgram);
+                    animProgram->use();
+                    _renderNodes(_editor, animProgram, _saveFile.nodes, true);
+                } else {
+                    // render objects
+                    shaderProgram->use();
+                    _recordNodes(_editor, shaderProgram,
+                                 cull ? _cullNodes(perspectiveProjection * view, nodes,
+                                                   staticBatch)
+                                      : nodes,
+                                 staticBatch, cull);
+
+                    // render skeletal animations
+                    animProgram->use();
+                    _renderNodes(_editor, animProgram, skinNodes, true);
+
+                    // render texts
+                    textProgram->use();
+                    textProgram->uniforms.at("u_time") << t;
+                    for (gpu::Text *text : texts) {
+                        if (!text->node->hidden) {
+                            textBatch.add(text);
+                        }
+                    }
+                    textBatch.draw(textProgram);
                 }
             }
-        }
-
-        if (_iEngineApp) {
-            _iEngineApp->appDraw();
-        }
 
-        if (_console.settingBool("wiremode")) {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        }
+            if (_iEngineApp) {
+                _iEngineApp->appDraw();
+            }
 
-        shaderProgram->use();
+            if (_console.settingBool("wiremode")) {
+                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            }
+        });
 
-        glDepthFunc(GL_LEQUAL);
-        gridNode->render(shaderProgram);
-        skydome::render();
-        glDepthFunc(GL_LESS);
+        rendergraph::addPass("overlay", {sceneColor, sceneDepth}, {sceneColor, sceneDepth}, [this] {
+            shaderProgram->use();
 
-        glDisable(GL_DEPTH_TEST);
-        for (auto &vector : axisVectors) {
-            gpu::renderVector(shaderProgram, vector);
-        }
-        for (auto &vector : vectors) {
-            gpu::renderVector(shaderProgram, vector);
-        }
+            glDepthFunc(GL_LEQUAL);
+            gridNode->render(shaderProgram);
+            skydome::render();
+            glDepthFunc(GL_LESS);
 
-        glEnable(GL_DEPTH_TEST);
+            glDisable(GL_DEPTH_TEST);
+            for (auto &vector : axisVectors) {
+                gpu::renderVector(shaderProgram, vector);
+            }
+            for (auto &vector : vectors) {
+                gpu::renderVector(shaderProgram, vector);
+            }
+            glEnable(GL_DEPTH_TEST);
+        });
 
-        gui.render(uiProgram, uiTextProgram);
+        // the gui is drawn over the blurred scene, the scene color is then free for the blur
+        const rendergraph::Resource composite =
+            _console.settingBool("blur") ? blurRenderer.addPasses(sceneColor, colorDesc)
+                                         : sceneColor;
 
-        fbo->unbind();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        rendergraph::addPass("gui", {composite, sceneDepth}, {composite, sceneDepth},
+                             [this] { gui.render(uiProgram); });
 
-        glActiveTexture(GL_TEXTURE0);
-        fbo->textures.at(GL_COLOR_ATTACHMENT0)->bind();
+        rendergraph::addPass("screen", {composite}, {rendergraph::BACKBUFFER}, [this, composite] {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+            gpu::Texture_activeUnit(0);
+            rendergraph::texture(composite)->bind();
+            screenProgram->use();
+            gpu::renderScreen();
+        });
 
-        screenProgram->use();
-        gpu::renderScreen();
+        rendergraph::execute();
     }
+    gpu::UniformStream_endFrame();
+    gpu::Stats_endFrame();
 }
 
 static void _changePanel(Panel *panel, Camera &camera) {
@@ -631,7 +921,16 @@ void Engine::inputChanged(bool visible, const char * /*value*/) {
     gui.setConsoleText(visible ? _console.commandLine : nullptr);
 }
 
-void Engine::fps(float fps) { gui.setFps(fps); }
+void Engine::fps(float fps) {
+    gui.setFps(fps);
+    const bool stats = _console.settingBool("stats");
+    gui.showStats(stats);
+    if (stats) {
+        static char buf[64] = {};
+        gpu::Stats_summary(buf, sizeof(buf));
+        gui.setStats(buf);
+    }
+}
 
 void Engine::listNodes() {
     for (const auto &collection : _collections) {
@@ -738,6 +1037,7 @@ bool Engine::closeSaveFile() {
         ecs::entities().clear();
         _editor.clearHistory();
         _saveFile.nodes.clear();
+        saveFileBatch.dispose();
         return true;
     }
     return false;
@@ -753,6 +1053,11 @@ bool Engine::openSaveFile(const char *fpath) {
     closeSaveFile();
     strcpy(_saveFile.path, fpath);
     loadWorld(fpath, _saveFile);
+    for (gpu::Node *node : _saveFile.nodes) {
+        if (_isStatic(node)) {
+            saveFileBatch.add(node);
+        }
+    }
     _editor.selectNode(nullptr);
     if (_iEngineApp) {
         _iEngineApp->appLoad();
@@ -825,16 +1130,44 @@ bool Engine::openScene(const char *name) {
     return false;
 }
 
-void Engine::renderClickables(gpu::ShaderProgram *sp, uint8_t &id) {
-    if (sp == clickProgram) {
-        for (gpu::Node *node : nodes) {
-            sp->uniforms.at("u_object_id") << static_cast<float>(id++);
-            node->render(sp);
+static std::unordered_map<const library::Primitive *, uint32_t> _pickingMeshes;
+
+static uint32_t _pickingMesh(const library::Primitive *primitive) {
+    auto &cache = _pickingMeshes;
+    auto it = cache.find(primitive);
+    if (it == cache.end()) {
+        auto [positions, length] = primitive->positions();
+        library::Accessor *indices = primitive->indices;
+        uint32_t mesh;
+        if (indices && indices->componentType == GL_UNSIGNED_INT) {
+            mesh = picking::createMesh(positions, length, (const uint32_t *)indices->data(),
+                                       indices->count);
+        } else if (indices && indices->componentType == GL_UNSIGNED_SHORT) {
+            mesh = picking::createMesh(positions, length, (const uint16_t *)indices->data(),
+                                       indices->count);
+        } else {
+            // an empty mesh, unindexed primitives are never hit
+            mesh = picking::createMesh(positions, 0, (const uint16_t *)nullptr, 0);
         }
-    } else if (sp == clickAnimProgram) {
-        for (gpu::Node *skinnedNode : skinNodes) {
-            sp->uniforms.at("u_object_id") << static_cast<float>(id++);
-            skinnedNode->render(sp);
+        it = cache.emplace(primitive, mesh).first;
+    }
+    return it->second;
+}
+
+void Engine::addClickables() {
+    size_t index{0};
+    // skinned meshes are picked in their bind pose
+    for (const auto *list : {&nodes, &skinNodes}) {
+        for (gpu::Node *node : *list) {
+            node->recursive([index](gpu::Node *n) {
+                if (n->hidden || n->mesh == nullptr || n->mesh->libraryMesh == nullptr) {
+                    return;
+                }
+                for (const auto &primitive : n->mesh->libraryMesh->primitives) {
+                    picking::addInstance(index, _pickingMesh(&primitive), n->model());
+                }
+            });
+            ++index;
         }
     }
 }
@@ -894,11 +1227,15 @@ void Engine::nodeSelected(gpu::Node *node) { _updateNodeInfo(gui, node); }
 void Engine::nodeAdded(gpu::Node *node) {
     _saveFile.nodes.emplace_back(node);
     _saveFile.dirty = true;
+    if (_isStatic(node)) {
+        saveFileBatch.add(node);
+    }
     _editor.selectNode(node);
 }
 
 void Engine::nodeRemoved(gpu::Node *node) {
     _saveFile.nodes.erase(std::find(_saveFile.nodes.begin(), _saveFile.nodes.end(), node));
+    saveFileBatch.remove(node);
     _saveFile.dirty = true;
     _editor.selectNode(nullptr);
 }
@@ -955,7 +1292,12 @@ gpu::Node *Engine::cycleNode(gpu::Node *cur, bool reverse) {
     return nodes.empty() ? nullptr : nodes.front();
 }
 
-Engine::~Engine() { gpu::dispose(); }
+Engine::~Engine() {
+    jobs::stop();
+    rendergraph::dispose();
+    picking::dispose();
+    gpu::dispose();
+}
 
 [[maybe_unused]] inline static void printNode(gpu::Node *node, std::string tab) {
     printf("%s%s", tab.c_str(), node->libraryNode->name.c_str());
@@ -970,8 +1312,14 @@ Engine::~Engine() { gpu::dispose(); }
 }
 
 void Engine::unstage() {
+    staticBatch.dispose();
     nodes.clear();
     skinNodes.clear();
+    _meshBoundsCache.clear();
+    _occluders.clear();
+    // picking meshes are built from the unstaged primitives
+    picking::dispose();
+    _pickingMeshes.clear();
 };
 
 void Engine::stage(const gpu::Scene &scene) {
@@ -980,6 +1328,9 @@ void Engine::stage(const gpu::Scene &scene) {
             skinNodes.emplace_back(node);
         } else {
             nodes.emplace_back(node);
+            if (_isStatic(node)) {
+                staticBatch.add(node);
+            }
         }
     }
 }
@@ -1043,10 +1394,10 @@ bool Engine::loadEntity(ecs::Entity *entity, gpu::Node *node, uint32_t info, uin
     if (node->skin) {
         auto *collection = findCollection(node->libraryNode->scene->name.c_str());
         for (const auto &anim : collection->animations) {
-            node->skin->animations.emplace_back(
-                gpu::createAnimation(*anim->libraryAnimation, node));
+            node->skin->addAnimation(gpu::createAnimation(*anim->libraryAnimation, node));
         }
-        node->skin->playback = gpu::createPlayback(node->skin->animations.front());
+        node->skin->playback =
+            gpu::createPlayback(node->skin->animations.front(), node->skin);
         // skinAnim.playAnimation("Idle");
     }
     return true;
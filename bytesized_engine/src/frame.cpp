@@ -1,57 +1,19 @@
 #include "frame.h"
 
-struct VertexData {
-    constexpr VertexData()
-        : positions{
-              {0.0f, 0.0f, 0.0f},
-              {1.0f, 0.0f, 0.0f},
-              {0.0f, 1.0f, 0.0f},
-              {1.0f, 1.0f, 0.0f},
-          },
-          normals{
-              {0.0f, 0.0f, 1.0f},
-              {0.0f, 0.0f, 1.0f},
-              {0.0f, 0.0f, 1.0f},
-              {0.0f, 0.0f, 1.0f},
-          },
-          uvs{
-              {0.0f, 0.0f},
-              {1.0f, 0.0f},
-              {0.0f, 1.0f},
-              {1.0f, 1.0f},
-          },
-          indices{0, 1, 2, 1, 3, 2} {}
-    glm::vec3 positions[4];
-    glm::vec3 normals[4];
-    glm::vec2 uvs[4];
-    uint16_t indices[6];
-};
-static constexpr VertexData _vertexData;
-
-static gpu::Primitive *_framePrimitive() {
-    static gpu::Primitive *primitive = nullptr;
-    if (primitive == nullptr) {
-        primitive = gpu::createPrimitive(_vertexData.positions, _vertexData.normals,
-                                         _vertexData.uvs, 4, _vertexData.indices, 6);
-    }
-    return primitive;
-}
-
-void Frame::createPanel(float width, float height, gpu::Texture *texture) {
+void Frame::createPanel(float width, float height, gpu::Texture *texture_,
+                        const AtlasRegion &region_) {
     node = gpu::createNode();
     node->scale = {width, height, 1.0f};
-    node->mesh = gpu::createMesh();
-    auto mat = gpu::createMaterial();
-    mat->color = Color::white;
-    mat->textures.emplace(GL_TEXTURE0, texture);
-    node->mesh->primitives.emplace_back(_framePrimitive(), mat);
+    texture = texture_;
+    region = region_;
+    color = Color::white;
 }
 
 void Frame::createText(const bdf::Font &font, float x, float y, float scale, const char *value,
                        bool center, const Color &textColor) {
     text = gpu::createText(font, value, center);
     node = text->node;
-    text->node->material(0)->color = textColor;
+    color = textColor;
     text->node->translation = {x, y, 0.0f};
     text->node->scale = {scale, scale, 1.0f};
 }
@@ -79,30 +41,26 @@ float Frame::width() const { return node->scale.x; }
 
 float Frame::height() const { return node->scale.y; }
 
-void Frame::renderPanels(gpu::ShaderProgram *shaderProgram) {
-    if (node->hidden) {
-        return;
-    }
-    if (text) {
+void Frame::addPanels(gpu::UIBatch &uiBatch) {
+    if (node->hidden || text) {
         return;
     }
+    uiBatch.quad(texture, {node->translation.x, node->translation.y},
+                 {node->scale.x, node->scale.y}, region.bottomLeft, region.size, color.vec4());
     for (auto &child : children) {
-        if (child.text == nullptr) {
-            child.renderPanels(shaderProgram);
-        }
+        child.addPanels(uiBatch);
     }
-    node->render(shaderProgram);
 }
 
-void Frame::renderTexts(gpu::ShaderProgram *shaderProgram) {
+void Frame::addTexts(gpu::UIBatch &uiBatch) {
     if (node->hidden) {
         return;
     }
     if (text) {
-        text->node->render(shaderProgram);
+        uiBatch.text(text, color.vec4());
     } else {
         for (auto &child : children) {
-            child.renderTexts(shaderProgram);
+            child.addTexts(uiBatch);
         }
     }
 }
\ No newline at end of file
@@ -3,9 +3,48 @@
 #include "embed/tframe_png.hpp"
 #include "embed/ui_png.hpp"
 #include "gpu_primitive.h"
+#include "stb_image.h"
 #include "systime.h"
 #include <glm/gtc/quaternion.hpp>
 
+struct AtlasImage {
+    const uint8_t *data;
+    size_t len;
+};
+
+// Packs the panel images side by side into one texture so that all panels draw together.
+static gpu::Texture *_createAtlas(const AtlasImage *images, size_t count, AtlasRegion *regions) {
+    std::vector<uint8_t *> pixels(count);
+    std::vector<glm::ivec2> sizes(count);
+    int width{0};
+    int height{1};
+    stbi_set_flip_vertically_on_load_thread(true);
+    for (size_t i{0}; i < count; ++i) {
+        int channels;
+        pixels[i] = stbi_load_from_memory(images[i].data, static_cast<int>(images[i].len),
+                                          &sizes[i].x, &sizes[i].y, &channels, 4);
+        if (pixels[i] == nullptr) {
+            sizes[i] = {0, 0};
+        }
+        width += sizes[i].x + 1;
+        height = std::max(height, sizes[i].y);
+    }
+    std::vector<uint8_t> atlas(width * height * 4);
+    for (size_t i{0}, x{0}; i < count; ++i) {
+        for (int y{0}; y < sizes[i].y; ++y) {
+            std::copy_n(pixels[i] + y * sizes[i].x * 4, sizes[i].x * 4,
+                        atlas.begin() + (y * width + x) * 4);
+        }
+        regions[i] = {glm::vec2{static_cast<float>(x) / width, 0.0f},
+                      glm::vec2{static_cast<float>(sizes[i].x) / width,
+                                static_cast<float>(sizes[i].y) / height}};
+        x += sizes[i].x + 1;
+        stbi_image_free(pixels[i]);
+    }
+    return gpu::createTexture(atlas.data(), width, height, gpu::ChannelSetting::RGBA,
+                              GL_UNSIGNED_BYTE);
+}
+
 void GUI::create(bdf::Font *font_, float width_, float height_, float em_, Options options) {
     font = font_;
     width = width_;
@@ -13,67 +52,75 @@ void GUI::create(bdf::Font *font_, float width_, float height_, float em_, Optio
     em = em_;
     projection = glm::ortho(0.0f, width, 0.0f, height, -1.0f, 1.0f);
     view = glm::mat4{1.0f};
+    const AtlasImage images[] = {
+        {_embed_console_png, sizeof(_embed_console_png)},
+        {_embed_tframe_png, sizeof(_embed_tframe_png)},
+    };
+    AtlasRegion regions[2];
+    atlas = _createAtlas(images, 2, regions);
     if (options & TITLE) {
         auto &titleFrame = frames[FRAME_TITLE];
         titleFrame.createText(*font, width - 192.0f, font->ph * 0.5f * em, em, "untitled*", false,
-                              Color::black);
+                              textColor);
     }
     if (options & COMMAND_LINE) {
         auto &consoleFrame = frames[FRAME_CONSOLE];
-        consoleFrame.createPanel(512, 48,
-                                 gpu::createTextureFromMem((uint8_t *)_embed_console_png,
-                                                           sizeof(_embed_console_png), true));
+        consoleFrame.createPanel(512, 48, atlas, regions[0]);
         consoleFrame.setPosition(6.0f, 2.0f);
         consoleFrame.setHidden(true);
         auto &textFrame = consoleFrame.children.emplace_back();
-        textFrame.createText(*font, 48, 16, em, "", false, Color::black);
+        textFrame.createText(*font, 48, 16, em, "", false, textColor);
     }
     if (options & FPS) {
         auto &fpsFrame = frames[FRAME_FPS];
-        fpsFrame.createPanel(192, 48,
-                             gpu::createTextureFromMem((uint8_t *)_embed_tframe_png,
-                                                       sizeof(_embed_tframe_png), true));
+        fpsFrame.createPanel(192, 48, atlas, regions[1]);
         fpsFrame.setPosition(6.0f, height - fpsFrame.height() - 10.0f);
         auto &textFrame = fpsFrame.children.emplace_back();
         textFrame.createText(*font, 24.0f, height - 16.0f - font->ph * em, em, "fps: N/A", false,
-                             Color::black);
+                             textColor);
+    }
+    if (options & STATS) {
+        auto &statsFrame = frames[FRAME_STATS];
+        statsFrame.createPanel(384, 48, atlas, regions[1]);
+        statsFrame.setPosition(204.0f, height - statsFrame.height() - 10.0f);
+        statsFrame.setHidden(true);
+        auto &textFrame = statsFrame.children.emplace_back();
+        textFrame.createText(*font, 222.0f, height - 16.0f - font->ph * em * 0.75f, em * 0.75f, "",
+                             false, textColor);
     }
     if (options & NODE_INFO) {
         for (size_t i{0}; i < NODE_INFO_COUNT; ++i) {
             nodeInfoRows[i] = gpu::createText(*font, "", false);
-            nodeInfoRows[i]->node->material(0)->color = Color::black;
             float s = em * 0.75f;
             nodeInfoRows[i]->node->translation = {width - 256.0f * 1.33f - 16.0f,
                                                   height - 24.0f - (i + 1) * (font->ph * s), 0.0f};
             nodeInfoRows[i]->node->scale = {s, s, s};
         }
+        // packed offline with its mips, see embed_textures
+        nodeInfoTexture = gpu::createTextureFromMem(_embed_ui_png, sizeof(_embed_ui_png), false);
         auto &nodeInfoFrame = frames[FRAME_NODE_INFO];
-        nodeInfoFrame.createPanel(
-            256 * 1.33f, 128 * 1.33f,
-            gpu::createTextureFromMem((uint8_t *)_embed_ui_png, sizeof(_embed_ui_png), true));
+        nodeInfoFrame.createPanel(256 * 1.33f, 128 * 1.33f, nodeInfoTexture,
+                                  {glm::vec2{0.0f}, glm::vec2{1.0f}});
         nodeInfoFrame.setPosition(width - nodeInfoFrame.width() - 36.0f,
                                   height - nodeInfoFrame.height() - 6.0f);
         nodeInfoFrame.setHidden(true);
     }
 }
 
-void GUI::render(gpu::ShaderProgram *frameProgram, gpu::ShaderProgram *textProgram) {
-    const float t = Time::seconds();
-    textProgram->use();
-    textProgram->uniforms.at("u_time") << t;
+void GUI::render(gpu::ShaderProgram *shaderProgram) {
+    shaderProgram->use();
     for (auto &frame : frames) {
-        frame.renderTexts(textProgram);
+        frame.addPanels(uiBatch);
+    }
+    for (auto &frame : frames) {
+        frame.addTexts(uiBatch);
     }
-
     for (gpu::Text *text : nodeInfoRows) {
-        if (text) {
-            text->node->render(textProgram);
+        if (text && !text->node->hidden) {
+            uiBatch.text(text, textColor.vec4());
         }
     }
-    frameProgram->use();
-    for (auto &frame : frames) {
-        frame.renderPanels(frameProgram);
-    }
+    uiBatch.draw(shaderProgram);
 }
 
 gpu::Text *GUI::setTitleText(const char *value) {
@@ -104,6 +151,19 @@ gpu::Text *GUI::setFps(float fps) {
     return frames[FRAME_FPS].children[0].text;
 }
 
+gpu::Text *GUI::setStats(const char *value) {
+    if (frames[FRAME_STATS]) {
+        frames[FRAME_STATS].children[0].text->setText(value, false);
+    }
+    return frames[FRAME_STATS].children[0].text;
+}
+
+void GUI::showStats(bool visible) {
+    if (frames[FRAME_STATS]) {
+        frames[FRAME_STATS].setHidden(!visible);
+    }
+}
+
 void GUI::setNodeInfo(const char *scene, const char *name, uint32_t id, const char *mesh,
                       const char *componentInfo, const glm::vec3 &translation,
                       const glm::vec3 &euler, const glm::vec3 &scale) {
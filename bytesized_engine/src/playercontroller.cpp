@@ -9,6 +9,8 @@ static constexpr float JUMP_HEIGHT = 0.8f;
 static constexpr float JUMP_TIME = 0.3f;
 static constexpr float GRAVITY = (-2.0f * JUMP_HEIGHT) / (JUMP_TIME * JUMP_TIME);
 static constexpr float JUMP_V0 = -GRAVITY * JUMP_TIME;
+// take-offs blend in quicker than the default crossfade so the jump does not look late
+static constexpr float JUMP_FADE = 0.1f;
 
 static geom::Collision collision;
 
@@ -270,9 +272,9 @@ void PlayerController_setPlayerAnimation(Character &character) {
         break;
     case Controller::STATE_JUMPING:
         if (character.ctrl->jumpCount) {
-            skin->playAnimation("Jumping");
+            skin->playAnimation("Jumping", JUMP_FADE);
         } else {
-            skin->playAnimation("DoubleJump");
+            skin->playAnimation("DoubleJump", JUMP_FADE);
         }
         // skin->playAnimation("Jumping");
         break;
@@ -293,7 +295,7 @@ void PlayerController_setPlayerAnimation(Character &character) {
         skin->playAnimation("WallHang");
         break;
     case Controller::STATE_WALL_JUMP:
-        skin->playAnimation("Jumping");
+        skin->playAnimation("Jumping", JUMP_FADE);
         break;
     }
 }
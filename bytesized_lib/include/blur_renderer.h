@@ -1,14 +1,15 @@
 #pragma once
 
 #include "gpu.h"
+#include "rendergraph.h"
 
+/// @brief A separable gaussian blur declared as render graph passes, horizontal and vertical in
+/// turn. The ping-pong targets are transient, the graph lets them share two textures.
 struct BlurRenderer {
-    void create(const glm::ivec2 &resolution, gpu::ShaderProgram *shaderProgram_ = nullptr);
+    /// @brief Adds the passes blurring input into textures of desc, returns the blurred one.
+    rendergraph::Resource addPasses(rendergraph::Resource input,
+                                    const rendergraph::TextureDesc &desc, size_t amount = 10);
 
-    gpu::Texture *blur(gpu::Texture *inputTexture);
-
-    gpu::Texture *outputTexture();
-
-    gpu::Framebuffer *blurFBO[2];
-    gpu::ShaderProgram *shaderProgram;
-};
\ No newline at end of file
+    /// @brief Uses a shared blur program when left unset.
+    gpu::ShaderProgram *shaderProgram{nullptr};
+};
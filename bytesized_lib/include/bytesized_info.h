@@ -17,6 +17,9 @@
 #ifndef BYTESIZED_TEXTURE_COUNT
 #define BYTESIZED_TEXTURE_COUNT 20
 #endif
+#ifndef BYTESIZED_TEXTURE_UNITS
+#define BYTESIZED_TEXTURE_UNITS 16
+#endif
 #ifndef BYTESIZED_MATERIAL_COUNT
 #define BYTESIZED_MATERIAL_COUNT 20
 #endif
@@ -47,6 +50,21 @@
 #ifndef BYTESIZED_TEXT_COUNT
 #define BYTESIZED_TEXT_COUNT 10
 #endif
+#ifndef BYTESIZED_TEXTBATCH_GLYPHS
+#define BYTESIZED_TEXTBATCH_GLYPHS 4096
+#endif
+#ifndef BYTESIZED_UIBATCH_QUADS
+#define BYTESIZED_UIBATCH_QUADS 2048
+#endif
+#ifndef BYTESIZED_SPRITE_COUNT
+#define BYTESIZED_SPRITE_COUNT 256
+#endif
+#ifndef BYTESIZED_TILEMAP_CHUNK
+#define BYTESIZED_TILEMAP_CHUNK 32
+#endif
+#ifndef BYTESIZED_STATIC_CELL
+#define BYTESIZED_STATIC_CELL 32.0f
+#endif
 #ifndef BYTESIZED_FRAMEBUFFER_COUNT
 #define BYTESIZED_FRAMEBUFFER_COUNT 10
 #endif
@@ -56,6 +74,64 @@
 #ifndef BYTESIZED_PLAYBACK_COUNT
 #define BYTESIZED_PLAYBACK_COUNT 10
 #endif
+#ifndef BYTESIZED_ANIMATION_TRANSLATION_ERROR
+#define BYTESIZED_ANIMATION_TRANSLATION_ERROR 0.001f
+#endif
+#ifndef BYTESIZED_ANIMATION_ROTATION_ERROR
+#define BYTESIZED_ANIMATION_ROTATION_ERROR 0.002f
+#endif
+#ifndef BYTESIZED_ANIMATION_SCALE_ERROR
+#define BYTESIZED_ANIMATION_SCALE_ERROR 0.001f
+#endif
+#ifndef BYTESIZED_ANIMATION_CROSSFADE
+#define BYTESIZED_ANIMATION_CROSSFADE 0.2f
+#endif
+#ifndef BYTESIZED_ANIMATION_BUDGET
+#define BYTESIZED_ANIMATION_BUDGET 16.0f
+#endif
+#ifndef BYTESIZED_ANIMATION_BAKE_RATE
+#define BYTESIZED_ANIMATION_BAKE_RATE 30.0f
+#endif
+#ifndef BYTESIZED_GEOMETRYARENA_COUNT
+#define BYTESIZED_GEOMETRYARENA_COUNT 8
+#endif
+#ifndef BYTESIZED_GEOMETRYARENA_VERTICES
+#define BYTESIZED_GEOMETRYARENA_VERTICES 65536
+#endif
+#ifndef BYTESIZED_GEOMETRYARENA_INDICES
+#define BYTESIZED_GEOMETRYARENA_INDICES 196608
+#endif
+#ifndef BYTESIZED_SKINPALETTE_BONES
+#define BYTESIZED_SKINPALETTE_BONES 4096
+#endif
+#ifndef BYTESIZED_UNIFORMSTREAM_FRAMES
+#define BYTESIZED_UNIFORMSTREAM_FRAMES 3
+#endif
+#ifndef BYTESIZED_UNIFORMSTREAM_SIZE
+#define BYTESIZED_UNIFORMSTREAM_SIZE 65536
+#endif
+#ifndef BYTESIZED_TEXTURELOAD_COUNT
+#define BYTESIZED_TEXTURELOAD_COUNT 32
+#endif
+#ifndef BYTESIZED_TEXTURELOAD_UPLOADS
+#define BYTESIZED_TEXTURELOAD_UPLOADS 4
+#endif
+// define BYTESIZED_SHADERCACHE_DIR to keep linked program binaries there, off by default
+#ifndef BYTESIZED_WORKER_COUNT
+#ifdef __EMSCRIPTEN__
+#define BYTESIZED_WORKER_COUNT 0
+#else
+#define BYTESIZED_WORKER_COUNT 3
+#endif
+#endif
+
+#ifndef __EMSCRIPTEN__
+#define BYTESIZED_USE_BASEVERTEX 1
+#endif
+#if !defined(__EMSCRIPTEN__) && !defined(__ANDROID__)
+#define BYTESIZED_USE_MULTIDRAW 1
+#define BYTESIZED_USE_BUFFER_STORAGE 1
+#endif
 
 #if BYTESIZED_SKIN_COUNT > 0 & BYTESIZED_ANIMATION_COUNT > 0 & BYTESIZED_PLAYBACK_COUNT > 0
 #define BYTESIZED_USE_SKINNING 1
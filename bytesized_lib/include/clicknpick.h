@@ -1,11 +1,13 @@
 #pragma once
 
-#include "gpu.h"
+#include "camera.h"
+#include "picking.h"
 #include "window.h"
-#include <cstring>
 
 struct IClickNPick {
-    virtual void renderClickables(gpu::ShaderProgram *shaderProgram, uint8_t &id) = 0;
+    /// @brief Adds every clickable object with picking::addInstance, object is the index passed to
+    /// nodeClicked.
+    virtual void addClickables() = 0;
     virtual bool nodeClicked(size_t index) = 0;
 };
 
@@ -13,48 +15,42 @@ struct ClickNPick : public window::IMouseListener, public window::IMouseMotionLi
 
     ClickNPick(IClickNPick *iClickNPick_) : iClickNPick{iClickNPick_} {}
 
-    void create(uint32_t width, uint32_t height, const glm::mat4 &projection, float scale,
-                gpu::ShaderProgram *shaderProgram) {
+    void create(uint32_t width, uint32_t height, const glm::mat4 &projection, Camera &camera) {
         window::registerMouseListener(this);
         window::registerMouseMotionListener(this);
         _width = width;
         _height = height;
-        _scale = scale;
-        fbo = gpu::createFramebuffer();
-        fbo->bind();
-        fbo->createTexture(GL_COLOR_ATTACHMENT0, width * scale, height * scale,
-                           gpu::ChannelSetting::RGB, GL_UNSIGNED_BYTE);
-        fbo->createRenderBufferDS(width * scale, height * scale);
-        // fbo->createDepthStencil(width * scale, height * scale);
-        // unsigned int attachments[1] = {GL_COLOR_ATTACHMENT0};
-        // glDrawBuffers(1, attachments);
-        fbo->checkStatus("clicknpick.fbo");
-        fbo->unbind();
-        shaderPrograms.push_back(shaderProgram);
+        _projection = &projection;
+        _camera = &camera;
     }
 
+    /// @brief Casts a ray through the mouse position, 0 when nothing is hit otherwise the index of
+    /// the object plus one.
+    size_t pick() {
+        picking::begin();
+        iClickNPick->addClickables();
+        picking::build();
+        const glm::mat4 inverseViewProjection = glm::inverse(*_projection * _camera->view());
+        picking::Hit hit;
+        if (picking::raycast(picking::screenRay(inverseViewProjection, mx, my, _width, _height),
+                             hit)) {
+            return hit.object + 1;
+        }
+        return 0;
+    }
+
+    /// @brief Picks the hovered object again only if the mouse moved since the last update.
     void update() {
-        fbo->bind();
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-        static int vp[4] = {};
-        glGetIntegerv(GL_VIEWPORT, vp);
-        glViewport(0, 0, _width * _scale, _height * _scale);
-        uint8_t id = 1;
-        for (auto *shaderProgram : shaderPrograms) {
-            shaderProgram->use();
-            assert(id < 255);
-            iClickNPick->renderClickables(shaderProgram, id);
+        if (_moved) {
+            objectId = pick();
+            _moved = false;
         }
-        uint8_t pixel[4];
-        glReadPixels((int)(mx * _scale), (int)(my * _scale), 1, 1, GL_RGBA, GL_UNSIGNED_BYTE,
-                     pixel);
-        objectId = pixel[0];
-        fbo->unbind();
-        glViewport(vp[0], vp[1], vp[2], vp[3]);
     }
 
     bool mouseDown(int /*button*/, int /*x*/, int /*y*/) override {
+        // objects may have moved under a resting mouse, so clicks always pick
+        objectId = pick();
+        _moved = false;
         if (objectId > 0) {
             return iClickNPick->nodeClicked(objectId - 1);
         }
@@ -63,17 +59,18 @@ struct ClickNPick : public window::IMouseListener, public window::IMouseMotionLi
     bool mouseUp(int /*button*/, int /*x*/, int /*y*/) override { return false; }
     bool mouseMoved(float x, float y, float /*xrel*/, float /*yrel*/) override {
         mx = x;
-        my = _height - y;
+        my = y;
+        _moved = true;
         return false;
     }
 
     IClickNPick *iClickNPick;
     uint32_t _width;
     uint32_t _height;
-    float _scale;
-    std::vector<gpu::ShaderProgram *> shaderPrograms;
-    gpu::Framebuffer *fbo{nullptr};
-    float mx;
-    float my;
-    uint8_t objectId{0};
-};
\ No newline at end of file
+    const glm::mat4 *_projection{nullptr};
+    Camera *_camera{nullptr};
+    float mx{0.0f};
+    float my{0.0f};
+    bool _moved{false};
+    size_t objectId{0};
+};
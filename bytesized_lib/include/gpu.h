@@ -4,8 +4,21 @@
 #include "bytesized_info.h"
 #include "color.h"
 #include "ecs.h"
+#include "gpu_animlod.h"
+#include "gpu_arena.h"
+#include "gpu_commands.h"
+#include "gpu_crowdbatch.h"
+#include "gpu_instancestream.h"
+#include "gpu_programcache.h"
+#include "gpu_resourcecache.h"
 #include "gpu_skinning.h"
+#include "gpu_spritebatch.h"
+#include "gpu_stats.h"
+#include "gpu_textbatch.h"
 #include "gpu_texture.h"
+#include "gpu_textureloader.h"
+#include "gpu_uibatch.h"
+#include "gpu_uniformstream.h"
 #include "library_types.h"
 #include "opengl.h"
 #include "recycler.hpp"
@@ -13,6 +26,7 @@
 #include "uniform.h"
 #include "vector.h"
 #include "vertexobject.h"
+#include <array>
 #include <functional>
 #include <glm/glm.hpp>
 #include <string>
@@ -22,6 +36,8 @@ namespace gpu {
 
 struct Shader {
     uint32_t id;
+    uint64_t hash;
+    std::string source; // expanded source, kept until the first link when compiling lazily
 };
 
 struct ShaderProgram {
@@ -37,18 +53,40 @@ struct ShaderProgram {
 bool Shader_compile(const gpu::Shader &id, const char *src);
 void Shader_createProgram(ShaderProgram &shaderProgram);
 
+/// @brief Slot i is bound to texture unit i, the slots follow library::Material.
+static constexpr size_t MATERIAL_TEXTURE_SLOTS = library::Material::TEX_COUNT;
+
 struct Material {
+    /// @brief Index into the MaterialBlock, set when the material is created.
+    uint32_t id;
     Color color;
     float metallic;
     float roughness;
-    std::unordered_map<uint32_t, Texture *> textures;
+    std::array<Texture *, MATERIAL_TEXTURE_SLOTS> textures;
+    uint32_t refs;
 };
 
+/// @brief Parameters of every material live in one uniform buffer, a draw only selects its row
+/// with u_material. Rows are uploaded again only when a material's parameters changed.
+struct MaterialParams {
+    glm::vec4 color;
+    glm::vec4 metallicRoughness;
+};
+static constexpr uint32_t MATERIAL_BLOCK_ROWS = 64;
+static_assert(BYTESIZED_MATERIAL_COUNT <= MATERIAL_BLOCK_ROWS,
+              "MaterialBlock in object.frag holds MATERIAL_BLOCK_ROWS materials");
+// material_block.glsl declares two vec4 of u_materials per MaterialParams
+static_assert(sizeof(MaterialParams) == 2 * sizeof(glm::vec4),
+              "index u_materials in object.frag and anim.frag along with MaterialParams");
+
 void bindMaterial(ShaderProgram *shaderProgram, Material *material);
 
 struct VertexArray {
     uint32_t id;
-    void bind() { glBindVertexArray(id); }
+    void bind() {
+        Stats_stateChange(StateChange::VERTEX_ARRAY);
+        glBindVertexArray(id);
+    }
     void unbind() { glBindVertexArray(0); }
 };
 static_assert(sizeof(VertexArray) == sizeof(uint32_t));
@@ -58,8 +96,13 @@ struct Primitive {
     std::vector<uint32_t *> vbos;
     uint32_t *ebo;
     uint32_t count;
+    GeometryArena *arena;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t refs;
 
     void render();
+    void renderInstanced(uint32_t instances);
 };
 
 struct UniformBuffer {
@@ -80,6 +123,7 @@ struct UniformBuffer {
 struct Mesh {
     const library::Mesh *libraryMesh;
     std::vector<std::pair<Primitive *, Material *>> primitives;
+    uint32_t refs;
 };
 
 struct Node : TRS {
@@ -112,6 +156,10 @@ struct Node : TRS {
 #endif
 
     void render(ShaderProgram *shaderProgram);
+    /// @brief Records the draws of this node and its children without any GL calls. Trees that
+    /// share no nodes may be recorded on different threads. Skins are not handled, skinned nodes
+    /// are drawn with render.
+    void record(CommandBuffer &buffer);
     Node *childByName(const char *name);
     const std::string &name() const;
     const std::string &meshName() const;
@@ -134,12 +182,16 @@ struct Text {
     const bdf::Font *bdfFont;
     Node *node;
 
-    void init();
+    /// @brief Lays out the glyphs again only when value or center changed, drawn by a TextBatch.
     void setText(const char *value, bool center);
     float width() const;
     float height() const;
 
     const char *value;
+    std::string content;
+    bool centered;
+    uint32_t version; // changes whenever the glyphs do
+    std::vector<glm::vec4> glyphs; // lower left corner and atlas uv of each glyph
 };
 
 struct Framebuffer {
@@ -165,13 +217,23 @@ void setOverrideMaterial(gpu::Material *material);
 
 VertexArray *createVertexArray();
 uint32_t *createVertexBuffer();
+void freeVertexBuffer(uint32_t *vbo);
+
+// Meshes, primitives, materials and textures are reference counted. Created resources hold one
+// reference owned by the caller, functions that store a resource retain it and free releases one
+// reference. Writing a resource into a struct by hand hands over the caller's reference.
 
 Mesh *createMesh();
 Mesh *createMesh(gpu::Primitive *primitive, gpu::Material *material = nullptr);
+Mesh *retainMesh(Mesh *mesh);
+/// @brief Releases the primitives and materials of the mesh along with it.
+void freeMesh(Mesh *mesh);
 Primitive *createPrimitive(const glm::vec3 *positions, const glm::vec3 *normals,
                            const glm::vec2 *uvs, size_t vertex_count, const uint16_t *indices,
                            size_t index_count);
 Primitive *createPrimitive(const VertexObject &vertexObject);
+Primitive *retainPrimitive(Primitive *primitive);
+void freePrimitive(Primitive *primitive);
 
 enum BuiltinMaterial { CHECKERS, GRID_TILE, WHITE, COLOR_MAP, MATERIAL_COUNT };
 Material *builtinMaterial(BuiltinMaterial builtinMaterial);
@@ -189,12 +251,16 @@ Texture *createTexture(const bdf::Font &font);
 Text *createText(const bdf::Font &font, const char *text, bool center);
 void freeText(gpu::Text *text);
 
+Texture *retainTexture(Texture *texture);
 void freeTexture(Texture *texture);
+uint32_t textureRefs(const Texture *texture);
 
 Material *createMaterial();
 Material *createMaterial(const Color &color);
 Material *createMaterial(gpu::Texture *texture);
 Material *createMaterial(const library::Material &material);
+Material *retainMaterial(Material *material);
+/// @brief Releases the textures of the material along with it.
 void freeMaterial(Material *material);
 
 Node *createNode();
@@ -208,11 +274,14 @@ Scene *createScene();
 Scene *createScene(const library::Scene &scene);
 void freeScene(gpu::Scene *scene);
 
+/// @brief A len of 0 creates no buffer, for blocks bound by the uniform stream.
 UniformBuffer *createUniformBuffer(uint32_t bindingPoint, const char *label, uint32_t len,
                                    void *data = NULL);
 void freeUniformBuffer(UniformBuffer *ubo);
 
 void createSharedSource(const char *name, const char *src);
+/// @brief Identical variants, same type and expanded source, share one Shader. With a program
+/// cache open, compiling is postponed until a program has to be linked from source.
 Shader *createShader(uint32_t type, const char *src,
                      const std::unordered_set<std::string> &defines = {});
 void freeShader(Shader *shader);
@@ -228,11 +297,14 @@ struct CameraBlock {
 };
 void CameraBlock_setProjection(const glm::mat4 &projection);
 void CameraBlock_setViewPos(const glm::mat4 &view, const glm::vec3 &pos);
-static constexpr int MAX_BONES = 32;
-struct SkinBlock {
-    glm::mat4 bones[MAX_BONES];
-};
-SkinBlock &getSkinBlock();
+#ifdef BYTESIZED_USE_SKINNING
+static constexpr int MAX_BONES = 256;
+static constexpr uint32_t SKIN_PALETTE_UNIT = 7;
+static constexpr uint32_t ANIMATION_BAKE_UNIT = 8;
+/// @brief Computes the bone palettes of all skinned nodes below nodes into one frame-wide
+/// palette texture, uploaded once. Draws index it with u_paletteOffset.
+void updateSkinPalettes(const std::vector<Node *> &nodes);
+#endif
 
 struct LightBlock {
     glm::vec4 lightHigh;
@@ -249,9 +321,7 @@ struct GUIBlock {
 enum BuiltinUBO {
     UBO_CAMERA,
     UBO_LIGHT,
-#ifdef BYTESIZED_USE_SKINNING
-    UBO_SKINNING,
-#endif
+    UBO_MATERIAL,
 };
 UniformBuffer *builtinUBO(BuiltinUBO bultinUBO);
 void createBuiltinUBOs();
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "bytesized_info.h"
+
+#ifdef BYTESIZED_USE_SKINNING
+
+#include "gpu_skinning.h"
+
+namespace gpu {
+
+/// @brief Rows of one animation in an AnimationBake. Frames are spread evenly over the clip, the
+/// first at startTime and the last at endTime, frameRate frames per second apart.
+struct BakedClip {
+    std::string_view name;
+    uint32_t firstFrame;
+    uint32_t frameCount;
+    float frameRate;
+    bool looping;
+};
+
+/// @brief A mesh below the skinned node, transform places it relative to that node. glTF skins
+/// sit on the parent of the node holding the skinned mesh.
+struct BakedMesh {
+    struct Mesh *mesh;
+    glm::mat4 transform;
+};
+
+/// @brief Bone palettes of every animation of a skin sampled at a fixed rate. The texture holds
+/// one row per frame and four RGBA32F texels per bone, see crowd.vert.
+struct AnimationBake {
+    struct Node *node;
+    uint32_t boneCount;
+    std::vector<BakedClip> clips;
+    std::vector<glm::mat4> palettes;
+    /// @brief Meshes of node and its descendants, collected in the rest pose.
+    std::vector<BakedMesh> meshes;
+    struct Texture *texture;
+
+    /// @brief Index of the clip baked from the animation called name, -1 if there is none.
+    int32_t findClip(const char *name) const;
+};
+
+/// @brief Samples the animations of the skin of node, the pose of node is restored afterwards.
+/// Nothing is uploaded, see uploadAnimationBake. Returns false and bakes nothing when the clips
+/// at frameRate take more than the 2048 rows a texture is guaranteed to hold.
+bool bakeAnimations(AnimationBake &bake, struct Node *node,
+                    float frameRate = BYTESIZED_ANIMATION_BAKE_RATE);
+void uploadAnimationBake(AnimationBake &bake);
+void freeAnimationBake(AnimationBake &bake);
+} // namespace gpu
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "bytesized_info.h"
+
+#ifdef BYTESIZED_USE_SKINNING
+
+#include "gpu_skinning.h"
+
+namespace gpu {
+
+/// @brief Largest error a removed key may leave behind, in world units for translation and
+/// scale and in radians for rotation.
+struct AnimationCompression {
+    float translationError{BYTESIZED_ANIMATION_TRANSLATION_ERROR};
+    float rotationError{BYTESIZED_ANIMATION_ROTATION_ERROR};
+    float scaleError{BYTESIZED_ANIMATION_SCALE_ERROR};
+};
+
+/// @brief Drops the keys that interpolating their neighbours reproduces within the allowed
+/// error, then quantizes what is left to 48 bits per key. Rotations keep their three smallest
+/// components, translation and scale are quantized to 16 bits within the range of their track.
+void compressAnimation(Animation &animation, const AnimationCompression &settings = {});
+
+void packRotation(const glm::quat &rotation, uint16_t *packed);
+/// @brief The quaternion as xyzw, like Animation::values.
+glm::vec4 unpackRotation(const uint16_t *packed);
+
+/// @brief Bytes held by the keys of the animation.
+size_t animationBytes(const Animation &animation);
+} // namespace gpu
+
+#endif
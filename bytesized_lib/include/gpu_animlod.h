@@ -0,0 +1,59 @@
+#pragma once
+
+#include "bytesized_info.h"
+
+#ifdef BYTESIZED_USE_SKINNING
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace gpu {
+
+/// @brief How often a skin is sampled, its bone palette is interpolated in between.
+enum AnimationRate : uint8_t {
+    RATE_EVERY_TICK,
+    RATE_EVERY_2ND,
+    RATE_EVERY_4TH,
+    RATE_PAUSED,
+    RATE_COUNT
+};
+
+/// @brief Ticks between samples of rate, 0 when paused.
+uint8_t AnimationRate_interval(AnimationRate rate);
+
+struct AnimationLodSettings {
+    /// @brief Screen height fraction a skin must cover to be sampled at each rate.
+    float everyTick{0.2f};
+    float every2nd{0.08f};
+    float every4th{0.02f};
+    /// @brief Samples per tick, a skin sampled every 4th tick costs a quarter. The least
+    /// significant skins drop a rate until the total fits.
+    float budget{BYTESIZED_ANIMATION_BUDGET};
+    /// @brief Rate of skins outside the view.
+    AnimationRate hiddenRate{RATE_PAUSED};
+};
+
+struct AnimationLodStats {
+    uint32_t skins[RATE_COUNT];
+    /// @brief Samples per tick of the assigned rates.
+    float cost;
+};
+
+/// @brief Screen height fraction of a sphere, 0 when it is outside the view.
+float animationSignificance(const glm::mat4 &projection, const glm::mat4 &view,
+                            const glm::vec3 &center, float radius);
+/// @brief Rates for significances, most significant first, demoted until they fit the budget.
+void assignAnimationRates(const float *significance, size_t count,
+                          const AnimationLodSettings &settings, AnimationRate *rates);
+
+/// @brief Assigns an update rate to the skins of all nodes below nodes from their significance.
+/// Call before animate, skins not passed keep their rate.
+void AnimationLod_update(const glm::mat4 &projection, const glm::mat4 &view,
+                         const std::vector<struct Node *> &nodes,
+                         const AnimationLodSettings &settings = {});
+const AnimationLodStats &AnimationLod_stats();
+
+} // namespace gpu
+
+#endif
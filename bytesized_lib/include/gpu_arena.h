@@ -0,0 +1,48 @@
+#pragma once
+
+#include "bytesized_info.h"
+#include "library_types.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gpu {
+
+struct VertexFormat {
+    uint8_t sizes[library::Primitive::COUNT];
+    uint32_t types[library::Primitive::COUNT];
+
+    bool operator==(const VertexFormat &other) const = default;
+    uint32_t attributeSize(size_t attribute) const;
+};
+
+VertexFormat VertexFormat_of(const library::Primitive &libraryPrimitive);
+
+/// @brief One VAO, VBO and EBO shared by all static primitives of the same vertex format.
+/// Attributes are stored in separate regions of the VBO so a base vertex addresses all of them.
+/// Space is handed out linearly and reclaimed when the last primitive in the arena is freed.
+struct GeometryArena {
+    /// @brief Slot of the arena, set when the arena is created.
+    uint32_t id;
+    VertexFormat format;
+    struct VertexArray *vao;
+    uint32_t *vbo;
+    uint32_t *ebo;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t primitiveCount;
+
+    bool fits(uint32_t vertices, uint32_t indices) const;
+};
+
+/// @brief Sub-allocates the primitive from an arena of matching format. Returns false when it
+/// does not fit in any arena, the caller then gives the primitive its own buffers.
+bool arenaAllocate(const library::Primitive &libraryPrimitive, struct Primitive &primitive);
+void arenaFree(struct Primitive &primitive);
+
+/// @brief Draws primitives that share one arena, merged into a single multi-draw when supported.
+void arenaDraw(GeometryArena *arena, struct Primitive *const *primitives, size_t count);
+
+void disposeGeometryArenas();
+void printGeometryArenas();
+} // namespace gpu
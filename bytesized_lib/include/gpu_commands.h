@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace gpu {
+
+/// @brief One primitive to draw, recorded without touching GL so any thread may record it.
+struct DrawCommand {
+    glm::mat4 model;
+    const struct Node *node;
+    struct Primitive *primitive;
+    struct Material *material;
+    bool wireframe;
+};
+
+struct CommandBuffer {
+    std::vector<DrawCommand> draws;
+
+    void clear() { draws.clear(); }
+};
+
+/// @brief Concatenates the buffers in order and sorts by material and arena id. Equal keys keep
+/// their recorded order so the result does not depend on which worker recorded what.
+/// Commands of materials with an alpha below 1 are not sorted, they follow in recorded order.
+void mergeCommands(const std::vector<CommandBuffer> &buffers, std::vector<DrawCommand> &commands);
+
+/// @brief Replays merged commands, on the thread that owns the GL context. Materials are bound
+/// and u_model uploaded only when they change, arena primitives of one node are drawn together.
+void submitCommands(struct ShaderProgram *shaderProgram, const std::vector<DrawCommand> &commands);
+} // namespace gpu
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "bytesized_info.h"
+
+#ifdef BYTESIZED_USE_SKINNING
+
+#include "gpu_animbake.h"
+#include "gpu_instancestream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace gpu {
+
+/// @brief Per-instance data of a baked skinned mesh. clip is the first frame, frame count,
+/// frame rate and looping flag of its BakedClip, timing the time offset and playback rate.
+struct CrowdInstance {
+    glm::mat4 model;
+    glm::vec4 clip;
+    glm::vec2 timing;
+};
+
+/// @brief One instanced draw of a primitive of a baked mesh, for the instances first to
+/// first + count of the sorted stream.
+struct CrowdDraw {
+    AnimationBake *bake;
+    struct Primitive *primitive;
+    struct Material *material;
+    const glm::mat4 *transform;
+    uint32_t first;
+    uint32_t count;
+};
+
+/// @brief Draws skinned meshes animated from an AnimationBake, the vertex shader picks the
+/// frames from the instance's clip and timing so instances need no animation on the CPU. Like
+/// SpriteBatch, the instances of a frame are streamed into one buffer and every bake is drawn
+/// with one instanced call per primitive.
+struct CrowdBatch {
+    void add(AnimationBake *bake, const glm::mat4 &model, uint32_t clip, float timeOffset = 0.0f,
+             float rate = 1.0f);
+    /// @brief Sorts the instances added this frame by bake and writes the draws for them, draw
+    /// does this before uploading the instances in sorted().
+    void collect(std::vector<CrowdDraw> &draws);
+    void draw(struct ShaderProgram *shaderProgram, float time);
+
+    const std::vector<CrowdInstance> &sorted() const { return _sorted; }
+
+    uint32_t drawCalls() const { return _drawCalls; }
+
+    InstanceStream instances;
+
+  private:
+    struct Key {
+        AnimationBake *bake;
+        uint32_t index;
+    };
+    std::vector<Key> _keys;
+    std::vector<CrowdInstance> _added;
+    std::vector<CrowdInstance> _sorted;
+    std::vector<CrowdDraw> _draws;
+    uint32_t _drawCalls{0};
+};
+} // namespace gpu
+
+#endif
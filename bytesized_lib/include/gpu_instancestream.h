@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gpu {
+
+/// @brief An instance attribute read components floats at offset into every instance.
+struct InstanceAttribute {
+    uint32_t location;
+    int32_t components;
+    size_t offset;
+};
+
+/// @brief A vertex buffer the instances of a frame are streamed into, shared by the instanced
+/// batches. Each upload orphans the storage and it grows by doubling.
+struct InstanceStream {
+    /// @brief Uploads count instances of stride bytes, leaving the buffer bound to
+    /// GL_ARRAY_BUFFER.
+    void upload(const void *data, size_t count, size_t stride);
+    /// @brief Points the attributes at the instances from first on. There is no base instance
+    /// in GLES 3.0, so every run of a draw is pointed at separately.
+    void point(const InstanceAttribute *attributes, size_t count, uint32_t first) const;
+
+    uint32_t *buffer{nullptr};
+
+  private:
+    size_t _stride{0};
+    size_t _capacity{0};
+};
+} // namespace gpu
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "bytesized_info.h"
+
+#ifdef BYTESIZED_USE_SKINNING
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+namespace gpu {
+
+/// @brief Local space transforms of a set of joints, stored as one stream per component so that
+/// four joints are blended at a time. Streams are padded to a multiple of four joints.
+struct Pose {
+    enum Stream { TX, TY, TZ, RX, RY, RZ, RW, SX, SY, SZ, STREAM_COUNT };
+
+    uint32_t count{0};
+    uint32_t stride{0};
+    std::vector<float> data;
+
+    void resize(uint32_t count_);
+    float *stream(Stream s) { return data.data() + s * stride; }
+    const float *stream(Stream s) const { return data.data() + s * stride; }
+
+    void setTranslation(uint32_t joint, const glm::vec3 &t);
+    void setRotation(uint32_t joint, const glm::quat &r);
+    void setScale(uint32_t joint, const glm::vec3 &s);
+    glm::vec3 translation(uint32_t joint) const;
+    glm::quat rotation(uint32_t joint) const;
+    glm::vec3 scale(uint32_t joint) const;
+};
+
+/// @brief Copies the current transform of every node into pose, joint i being nodes[i].
+void Pose_read(Pose &pose, const std::vector<struct Node *> &nodes);
+/// @brief Writes pose to the nodes, invalidating each node once instead of per component.
+void Pose_write(const Pose &pose, const std::vector<struct Node *> &nodes);
+/// @brief pose = mix(pose, other, weight). Vectors are lerped and rotations nlerped along the
+/// shortest arc. A mask holds one weight per joint, stride long, and scales weight for layering.
+void Pose_blend(Pose &pose, const Pose &other, float weight, const float *mask = nullptr);
+
+} // namespace gpu
+
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gpu {
+
+inline uint64_t fnv1a(const void *data, size_t length, uint64_t hash = 0xcbf29ce484222325ull) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i{0}; i < length; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/// @brief Keeps linked program binaries in dir, one file per program. Binaries from another
+/// driver or GPU are ignored. Does nothing where program binaries are unsupported.
+void openProgramCache(const char *dir);
+bool ProgramCache_enabled();
+
+/// @brief Links program from a cached binary, false when there is none or the driver rejects it.
+bool ProgramCache_load(uint64_t key, uint32_t program);
+void ProgramCache_store(uint64_t key, uint32_t program);
+} // namespace gpu
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "library_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace gpu {
+
+enum class CachedResource { PRIMITIVE, MATERIAL, TEXTURE, COUNT };
+
+struct ResourceCacheStats {
+    uint32_t entries;
+    uint32_t hits;
+    uint32_t misses;
+    uint64_t bytesSaved;
+};
+
+/// @brief Identifies the data a resource is created from, equal content gives an equal key no
+/// matter which file or collection it was loaded from. The check is a second hash of the same
+/// data with another seed, an entry is a hit only when hash, check and size all match.
+struct ContentKey {
+    uint64_t hash;
+    uint64_t check;
+    /// @brief Bytes hashed, the buffers and images a hit does not upload again.
+    size_t size;
+
+    bool operator==(const ContentKey &) const = default;
+};
+
+ContentKey contentKey(const library::Primitive &primitive);
+/// @brief Hashes each image once and keeps the key by image, images do not change after they are
+/// loaded. Textures sharing an image share the key.
+ContentKey contentKey(const library::Texture &texture);
+ContentKey contentKey(const library::Material &material);
+/// @brief Drops the keys kept for images, for when the images they were taken of are gone.
+void forgetImageKeys();
+
+/// @brief Maps content keys to live resources. Entries are not reference counted, the owner of
+/// the resource erases it when the resource is freed.
+template <typename T> struct ContentCache {
+    /// @brief A hash that matches an entry of other content is counted as a miss.
+    T *find(const ContentKey &key, size_t bytes) {
+        auto it = _entries.find(key.hash);
+        if (it == _entries.end() || it->second.key != key) {
+            ++_stats.misses;
+            return nullptr;
+        }
+        ++_stats.hits;
+        _stats.bytesSaved += bytes;
+        return it->second.resource;
+    }
+
+    void insert(const ContentKey &key, T *resource) {
+        auto [it, inserted] = _entries.try_emplace(key.hash, key, resource);
+        if (!inserted) {
+            // colliding content replaces the entry, the resource it pointed to stays uncached
+            _keys.erase(it->second.resource);
+            it->second = {key, resource};
+        }
+        _keys[resource] = key.hash;
+    }
+
+    void erase(const T *resource) {
+        auto it = _keys.find(resource);
+        if (it != _keys.end()) {
+            _entries.erase(it->second);
+            _keys.erase(it);
+        }
+    }
+
+    void clear() {
+        _entries.clear();
+        _keys.clear();
+    }
+
+    ResourceCacheStats stats() const {
+        ResourceCacheStats stats = _stats;
+        stats.entries = static_cast<uint32_t>(_entries.size());
+        return stats;
+    }
+
+  private:
+    struct Entry {
+        ContentKey key;
+        T *resource;
+    };
+
+    std::unordered_map<uint64_t, Entry> _entries;
+    std::unordered_map<const T *, uint64_t> _keys;
+    ResourceCacheStats _stats{};
+};
+
+/// @brief Implemented next to the caches, in gpu.cpp.
+ResourceCacheStats ResourceCache_stats(CachedResource resource);
+void ResourceCache_print();
+} // namespace gpu
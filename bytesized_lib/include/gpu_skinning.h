@@ -4,21 +4,25 @@
 
 #ifdef BYTESIZED_USE_SKINNING
 
+#include "gpu_pose.h"
 #include "library.h"
 
 namespace gpu {
 
-struct Frame {
-    float time;
-    union {
-        glm::vec3 v3;
-        glm::quat q;
-    };
-};
-
-struct Channel {
-    std::vector<Frame> frames;
-    std::vector<Frame>::iterator current;
+/// @brief The keys of one node property, a range of Animation::times and Animation::values.
+struct Track {
+    struct Node *node;
+    uint8_t type;
+    uint8_t interpolation;
+    /// @brief Joint of node in the pose of the skin the animation was added to.
+    uint16_t slot;
+    uint32_t first;
+    uint32_t count;
+    /// @brief Key sampled last, searching starts here since time mostly moves forward.
+    uint32_t cursor;
+    /// @brief Range of the quantized translation or scale keys.
+    glm::vec3 min;
+    glm::vec3 extent;
 };
 
 struct Animation {
@@ -26,18 +30,44 @@ struct Animation {
     float startTime;
     float endTime;
     enum ChannelType { CH_TRANSLATION, CH_ROTATION, CH_SCALE };
-    std::unordered_map<struct Node *, std::array<Channel, 3>> channels;
+    std::vector<Track> tracks;
+    std::vector<float> times;
+    /// @brief xyz for translation and scale, a quaternion as xyzw for rotation.
+    std::vector<glm::vec4> values;
+    /// @brief Three per key once compressed, values is then empty. See gpu_animcompress.h.
+    std::vector<uint16_t> packed;
     std::string_view name;
     bool looping;
 
+    /// @brief Interpolates every track at time and writes the result to its node.
+    void sample(float time);
+    /// @brief Interpolates every track at time into the joint of its slot, untouched joints keep
+    /// their value.
+    void sample(Pose &pose, float time);
     void start();
     void stop();
 };
 
+/// @brief Index of the last key at or before time, clamped to the first key. Checks hint and the
+/// key after it before falling back to a binary search.
+uint32_t findKey(const float *times, uint32_t count, float time, uint32_t hint);
+/// @brief Value of track at time, linear or step between the bracketing keys and slerp for
+/// rotations. Before the first and after the last key the nearest key is held.
+glm::vec4 sampleTrack(const Animation &animation, Track &track, float time);
+
 struct Playback {
     Animation *animation;
     bool paused;
     float time;
+    /// @brief Set for skinned playbacks, their clips are blended in a pose of the skin.
+    struct Skin *skin;
+    /// @brief Clip faded out while fade goes from 0 to 1 over fadeDuration seconds.
+    Animation *from;
+    float fromTime;
+    /// @brief Set when a fade began during another, the skin's heldPose fades out instead of from.
+    bool held;
+    float fade;
+    float fadeDuration;
     bool expired() { return time >= animation->endTime; }
 };
 
@@ -48,8 +78,39 @@ struct Skin {
     std::vector<gpu::Animation *> animations;
     gpu::Playback *playback;
 
+    uint32_t paletteOffset;
+    uint32_t paletteFrame;
+
+    /// @brief Nodes animated by any of the animations, joint i of pose is poseNodes[i].
+    std::vector<struct Node *> poseNodes;
+    Pose pose;
+    Pose fadePose;
+    /// @brief Blend of an interrupted crossfade, held still while the next one fades it out.
+    Pose heldPose;
+
+    /// @brief Ticks between samples, 0 when paused, and the tick within them the skin is sampled
+    /// on. See gpu_animlod.h.
+    uint8_t updateInterval;
+    uint8_t updatePhase;
+    uint8_t ticksSinceSample;
+    /// @brief Set by animate when the pose changed, the palette is then computed again.
+    bool sampled;
+    float boundingRadius;
+    /// @brief Palettes of the last two samples, interpolated between while updateInterval is not 1.
+    std::vector<glm::mat4> fromPalette;
+    std::vector<glm::mat4> toPalette;
+
+    /// @brief Adds animation and assigns the slots of its tracks.
+    void addAnimation(gpu::Animation *animation);
     gpu::Animation *findAnimation(const char *name);
-    gpu::Playback *playAnimation(const char *name);
+    /// @brief Crossfades from the current animation over fade seconds, 0 switches at once. During
+    /// a crossfade the new one fades from the blend as it is now.
+    gpu::Playback *playAnimation(const char *name, float fade = BYTESIZED_ANIMATION_CROSSFADE);
+    /// @brief Samples the playback ahead seconds from now into pose, blending in the clip faded
+    /// from. Only the skin's own nodes and animations are read, so skins sample concurrently.
+    void samplePose(float ahead = 0.0f);
+    /// @brief Writes pose to the nodes, each node is invalidated once.
+    void commitPose();
 };
 
 size_t skinningBufferSize();
@@ -61,7 +122,7 @@ void freeSkin(gpu::Skin *skin);
 Animation *createAnimation(const library::Animation &animation, struct Node *retargetNode);
 void freeAnimation(Animation *animation);
 
-Playback *createPlayback(Animation *animation);
+Playback *createPlayback(Animation *animation, Skin *skin = nullptr);
 void freePlayback(Playback *playback);
 
 void animate(float dt);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "gpu_instancestream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace gpu {
+
+/// @brief Per-instance data of a sprite quad. The 2D axes and translation are taken from the
+/// model matrix, region is the atlas bottom left and size with flips folded into its sign.
+struct SpriteInstance {
+    glm::vec4 axes;
+    glm::vec4 region;
+    glm::vec4 tint;
+    glm::vec3 translation;
+};
+
+/// @brief Draws sprites as instances of one unit quad. Sprites are sorted by layer and keep the
+/// order they were added in within it, every frame's instances are streamed into one buffer and
+/// each run of adjacent sprites sharing a texture is drawn with a single instanced call.
+struct SpriteBatch {
+    void add(struct Texture *texture, int32_t layer, const glm::mat4 &model,
+             const glm::vec4 &region, const glm::vec4 &tint);
+    void draw(struct ShaderProgram *shaderProgram);
+
+    uint32_t drawCalls() const { return _drawCalls; }
+
+    struct VertexArray *vao{nullptr};
+    uint32_t *quad{nullptr};
+    InstanceStream instances;
+
+  private:
+    struct Key {
+        int32_t layer;
+        struct Texture *texture;
+        uint32_t index;
+    };
+    std::vector<Key> _keys;
+    std::vector<SpriteInstance> _added;
+    std::vector<SpriteInstance> _sorted;
+    uint32_t _drawCalls{0};
+};
+} // namespace gpu
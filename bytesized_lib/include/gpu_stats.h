@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gpu {
+
+enum class StateChange { PROGRAM, TEXTURE, VERTEX_ARRAY, FRAMEBUFFER, COUNT };
+
+struct PoolUsage {
+    const char *name;
+    uint32_t used;
+    uint32_t highWater;
+    uint32_t capacity;
+};
+
+struct FrameStats {
+    uint64_t frame;
+    float cpuMs;
+    uint32_t drawCalls;
+    uint64_t triangles;
+    uint32_t stateChanges[static_cast<size_t>(StateChange::COUNT)];
+    uint32_t uniformUploads;
+    uint64_t bufferBytes;
+    uint64_t textureBytes;
+};
+
+/// @brief Limits checked at the end of every frame, zero leaves a limit unchecked.
+struct RenderBudget {
+    uint32_t drawCalls;
+    uint64_t triangles;
+    uint32_t stateChanges;
+    uint64_t bufferBytes;
+    uint64_t textureBytes;
+};
+
+/// @brief Counting starts anew, work issued outside of a frame is counted towards the next one.
+void Stats_beginFrame();
+/// @brief Samples pool occupancy, checks the budget and appends the frame to the capture.
+void Stats_endFrame();
+
+void Stats_draw(uint32_t mode, uint32_t count, uint32_t instances = 1);
+void Stats_stateChange(StateChange change);
+void Stats_uniformUpload();
+void Stats_bufferUpload(size_t bytes);
+void Stats_textureUpload(size_t bytes);
+
+/// @brief The last completed frame.
+const FrameStats &Stats_lastFrame();
+const std::vector<PoolUsage> &Stats_pools();
+
+void Stats_setBudget(const RenderBudget &budget);
+uint32_t Stats_framesOverBudget();
+
+/// @brief Writes every following frame to path, as JSON if it ends with .json otherwise as CSV.
+bool Stats_startCapture(const char *path);
+void Stats_stopCapture();
+
+void Stats_print();
+/// @brief One line summary of the last frame, as shown in the GUI.
+void Stats_summary(char *buf, size_t size);
+
+/// @brief Updates usage and high-water marks of the gpu pools, implemented next to them.
+void updatePoolUsage(std::vector<PoolUsage> &pools);
+} // namespace gpu
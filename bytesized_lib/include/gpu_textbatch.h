@@ -0,0 +1,53 @@
+#pragma once
+
+#include "bytesized_info.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace gpu {
+
+/// @brief Index buffer of quads as two triangles over four consecutive corners, bound to the
+/// vertex array that is bound when called.
+uint32_t *createQuadIndexBuffer(uint32_t quads);
+
+/// @brief Glyph corners are stored transformed. The text's up axis and the glyph's local x are
+/// kept so that shaders can still offset along it, see text.vert.
+struct TextVertex {
+    glm::vec3 position;
+    glm::vec4 wave;
+    glm::vec2 uv;
+};
+
+/// @brief Collects the glyph quads of texts into one vertex buffer that persists across frames.
+/// Only texts whose content, transform or place in the buffer changed since the last draw are
+/// written again, and all texts sharing a font atlas are drawn in a single call.
+struct TextBatch {
+    struct Entry {
+        struct Text *text;
+        uint32_t version;
+        glm::mat4 model;
+        uint32_t first;
+        uint32_t glyphs;
+    };
+
+    /// @brief Queues the text for the next draw, hidden texts should not be added.
+    void add(struct Text *text);
+    void draw(struct ShaderProgram *shaderProgram);
+
+    /// @brief Glyphs written to the buffer by the last draw.
+    uint32_t uploadedGlyphs() const { return _uploadedGlyphs; }
+
+    struct VertexArray *vao{nullptr};
+    uint32_t *vbo{nullptr};
+    uint32_t *ebo{nullptr};
+
+  private:
+    std::vector<Entry> _entries;
+    std::vector<Entry> _previous;
+    std::vector<TextVertex> _staging;
+    uint32_t _uploadedGlyphs{0};
+};
+} // namespace gpu
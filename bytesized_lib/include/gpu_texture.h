@@ -1,15 +1,24 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace gpu {
 
 struct Texture {
     uint32_t id;
+    /// @brief Binds to the active unit, skipped when the texture is already bound there.
     void bind();
     void unbind();
 };
 
+/// @brief The texture bound to each of the first BYTESIZED_TEXTURE_UNITS units is remembered so
+/// that redundant binds are skipped. Units must be activated through here for that to hold.
+void Texture_activeUnit(uint32_t unit);
+void Texture_bind(uint32_t unit, Texture *texture);
+/// @brief Forgets the remembered bindings, after textures were deleted.
+void Texture_resetBindings();
+
 enum class ChannelSetting {
     NONE,
     R,
@@ -21,4 +30,8 @@ enum class ChannelSetting {
 
 void Texture_create(const gpu::Texture &texture, const uint8_t *data, uint32_t width,
                     uint32_t height, ChannelSetting channels, uint32_t type);
+
+/// @brief Uploads a texpack image and its mip chain as is. Formats the GPU lacks support for
+/// are replaced by a white pixel and false is returned.
+bool Texture_createPacked(const gpu::Texture &texture, const uint8_t *data, size_t len);
 } // namespace gpu
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "bytesized_info.h"
+#include "gpu_texture.h"
+
+#include <cstddef>
+
+namespace gpu {
+
+/// @brief Returns a texture holding a white 1x1 placeholder right away. The image is decoded on
+/// the job workers and replaces the placeholder in TextureLoader_upload. addr must stay valid
+/// until then. Falls back to a blocking load when all load slots are taken.
+Texture *createTextureAsync(const uint8_t *addr, uint32_t len, bool flip);
+Texture *createTextureFromFileAsync(const char *path, bool flip);
+
+/// @brief Uploads decoded images on the GL thread, at most budget of them. Returns the number of
+/// loads still in flight.
+size_t TextureLoader_upload(size_t budget = BYTESIZED_TEXTURELOAD_UPLOADS);
+size_t TextureLoader_pending();
+
+/// @brief Drops the upload of a texture that is freed before its image arrived.
+void TextureLoader_cancel(Texture *texture);
+void disposeTextureLoader();
+} // namespace gpu
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "bytesized_info.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace gpu {
+
+struct UIVertex {
+    glm::vec2 position;
+    glm::vec4 color;
+    glm::vec2 uv;
+};
+
+/// @brief Streams the quads of 2D panels and texts into one vertex buffer, uploaded only when it
+/// differs from what the last draw used. Consecutive quads sharing texture and kind are drawn in
+/// one call, so adding all panels before all texts draws with two.
+struct UIBatch {
+    void quad(struct Texture *texture, const glm::vec2 &position, const glm::vec2 &size,
+              const glm::vec2 &uv, const glm::vec2 &uvSize, const glm::vec4 &color);
+    void text(struct Text *text, const glm::vec4 &color);
+
+    /// @brief Draws without depth testing in the order added. u_text is 1 for runs of text.
+    void draw(struct ShaderProgram *shaderProgram);
+
+    uint32_t drawCalls() const { return _drawCalls; }
+    /// @brief The quad corners added since the last draw.
+    const std::vector<UIVertex> &vertices() const { return _vertices; }
+    /// @brief Draw calls the next draw will make.
+    uint32_t pendingRuns() const { return static_cast<uint32_t>(_runs.size()); }
+
+    struct VertexArray *vao{nullptr};
+    uint32_t *vbo{nullptr};
+    uint32_t *ebo{nullptr};
+
+  private:
+    struct Run {
+        struct Texture *texture;
+        bool text;
+        uint32_t first;
+        uint32_t quads;
+    };
+    bool _reserve(struct Texture *texture, bool text, uint32_t quads);
+
+    std::vector<UIVertex> _vertices;
+    std::vector<UIVertex> _uploaded;
+    std::vector<Run> _runs;
+    uint32_t _drawCalls{0};
+};
+} // namespace gpu
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+namespace gpu {
+
+/// @brief Placement of blocks in the stream, aligned within the current region.
+struct UniformRing {
+    uint32_t alignment{256};
+    uint32_t regionSize{0};
+    uint32_t region{0};
+    uint32_t offset{0};
+
+    uint32_t alignUp(uint32_t value) const;
+    /// @brief True if a block of length bytes fits the rest of the current region.
+    bool fits(uint32_t length) const;
+    /// @brief Reserves length bytes in the current region and returns their offset in the buffer.
+    uint32_t take(uint32_t length);
+    /// @brief The region following the current one, wrapping after the last frame.
+    uint32_t next() const;
+    void enter(uint32_t region);
+};
+
+/// @brief One uniform buffer split into BYTESIZED_UNIFORMSTREAM_FRAMES regions. Blocks are copied
+/// into the current region and bound with glBindBufferRange, a fence per region guards against
+/// overwriting data the GPU has not consumed yet.
+void createUniformStream();
+void disposeUniformStream();
+
+/// @brief Moves on to the next region, waiting on its fence if it is still in flight.
+void UniformStream_beginFrame();
+/// @brief Fences the current region, blocks pushed before the next frame begins open the next.
+void UniformStream_endFrame();
+
+/// @brief Copies the block to the stream and binds it at bindingPoint. Sticky blocks are copied
+/// again whenever the stream moves to a new region, data must then outlive the stream.
+void UniformStream_push(uint32_t bindingPoint, const void *data, uint32_t length,
+                        bool sticky = false);
+
+uint32_t UniformStream_bytesWritten();
+} // namespace gpu
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "bytesized_info.h"
+
+#include <cstddef>
+#include <functional>
+
+namespace jobs {
+using Task = std::function<void(size_t begin, size_t end)>;
+using Job = std::function<void()>;
+
+void start(size_t workerCount = BYTESIZED_WORKER_COUNT);
+void stop();
+size_t workerCount();
+
+/// @brief Runs task over [0, count) in chunks of grain on the workers and the calling thread.
+/// Blocks until all chunks are done. Runs inline when there are no workers.
+void parallelFor(size_t count, size_t grain, const Task &task);
+
+/// @brief Queues job to run in the background on a worker, batches from parallelFor go first.
+/// Runs inline when there are no workers. Jobs still queued at stop() are dropped.
+void submit(Job job);
+} // namespace jobs
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace occlusion {
+constexpr int DEPTH_WIDTH{256};
+constexpr int DEPTH_HEIGHT{128};
+
+struct Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+struct Stats {
+    size_t occluders;
+    size_t triangles;
+    size_t rasterized;
+    size_t tested;
+    size_t culled;
+};
+
+/// @brief Clears the depth buffer and sets the view projection used by occluders and occludees.
+void begin(const glm::mat4 &viewProjection);
+
+void addOccluder(const glm::mat4 &model, const glm::vec3 *positions, size_t positionCount,
+                 const uint16_t *indices, size_t indexCount);
+void addOccluder(const glm::mat4 &model, const glm::vec3 *positions, size_t positionCount,
+                 const uint32_t *indices, size_t indexCount);
+void addOccluderBox(const glm::mat4 &model, const glm::vec3 &min, const glm::vec3 &max);
+
+/// @brief Rasterizes all added occluders into the depth buffer and builds the hierarchical-z.
+void rasterize();
+
+/// @brief Tests a world space box against the hierarchical-z, false when it is fully hidden or
+/// outside the view.
+bool isVisible(const glm::vec3 &min, const glm::vec3 &max);
+bool isVisible(const glm::mat4 &model, const glm::vec3 &min, const glm::vec3 &max);
+void testVisibility(const Bounds *bounds, size_t count, uint8_t *visible);
+
+float depth(int x, int y);
+float hierarchicalDepth(int level, int x, int y);
+int levels();
+
+const Stats &stats();
+} // namespace occlusion
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// CPU ray picking: a bounding volume hierarchy over object instances, each referring to a triangle
+// hierarchy of its mesh in local space. Meshes are built once, instances are rebuilt per pick.
+namespace picking {
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+};
+
+struct Hit {
+    size_t object;
+    float distance;
+};
+
+/// @brief The ray through a window position, y pointing down.
+Ray screenRay(const glm::mat4 &inverseViewProjection, float x, float y, float width,
+              float height);
+
+uint32_t createMesh(const glm::vec3 *positions, size_t positionCount, const uint16_t *indices,
+                    size_t indexCount);
+uint32_t createMesh(const glm::vec3 *positions, size_t positionCount, const uint32_t *indices,
+                    size_t indexCount);
+
+/// @brief Clears all instances, meshes are kept.
+void begin();
+void addInstance(size_t object, uint32_t mesh, const glm::mat4 &model);
+/// @brief Builds the hierarchy over the instances added since begin.
+void build();
+
+/// @brief Finds the closest triangle along the ray, false if nothing is hit.
+bool raycast(const Ray &ray, Hit &hit);
+
+size_t meshCount();
+size_t instanceCount();
+void dispose();
+} // namespace picking
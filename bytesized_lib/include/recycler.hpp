@@ -29,6 +29,7 @@ template <typename T, std::size_t N> struct recycler {
     T &operator[](size_t index) { return _data[index]; }
     size_t size() const { return N; }
     size_t count() const { return _data_count; };
+    size_t used() const { return _data_count - _waste_count; }
     T *data() { return _data; }
 
     T &at(size_t idx) {
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "gpu.h"
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+// Passes are declared anew every frame in execution order. Passes whose output is never used are
+// culled and transient textures share memory with others of the same format that are not alive
+// at the same time.
+namespace rendergraph {
+using Resource = uint32_t;
+
+/// @brief The default framebuffer, passes writing to it are never culled.
+constexpr Resource BACKBUFFER{0};
+
+struct TextureDesc {
+    uint32_t width;
+    uint32_t height;
+    gpu::ChannelSetting channels;
+    uint32_t type;
+
+    bool operator==(const TextureDesc &other) const = default;
+};
+
+struct PassStats {
+    const char *name;
+    bool culled;
+    float cpuMs;
+};
+
+/// @brief Starts declaring the passes of a frame drawn to a backbuffer of the given size.
+void begin(uint32_t backbufferWidth, uint32_t backbufferHeight);
+
+Resource createTexture(const char *name, const TextureDesc &desc);
+/// @brief Makes a texture owned elsewhere available to passes, writes to it are kept.
+Resource importTexture(const char *name, gpu::Texture *texture, const TextureDesc &desc);
+
+/// @brief Adds a pass rendering to a framebuffer with writes attached, the viewport covers the
+/// first of them. A pass reading and writing the same resource renders on top of it. Passes with
+/// side effects, such as read backs, are never culled.
+void addPass(const char *name, std::initializer_list<Resource> reads,
+             std::initializer_list<Resource> writes, std::function<void()> execute,
+             bool sideEffect = false);
+
+/// @brief Culls, allocates and runs the passes of this frame.
+void execute();
+
+/// @brief The texture behind a resource, valid while the passes execute.
+gpu::Texture *texture(Resource resource);
+
+const std::vector<PassStats> &stats();
+size_t textureCount();
+void dispose();
+} // namespace rendergraph
@@ -4,7 +4,6 @@
 #include "trs.h"
 #include <cstdint>
 #include <glm/glm.hpp>
-#include <list>
 #include <vector>
 
 struct AtlasRegion {
@@ -45,7 +44,8 @@ using Animations = std::vector<Animation>;
 
 struct Sprite : public TRS {
 
-    Sprite(glm::vec2 t, glm::vec2 s) : TRS{}, frame_ms{0}, flip{0, 0} {
+    Sprite() : Sprite{glm::vec2{0.0f}, glm::vec2{1.0f}} {}
+    Sprite(glm::vec2 t, glm::vec2 s) : TRS{}, frame_ms{0}, flip{0, 0}, tint{1.0f}, layer{0} {
         translation = glm::vec3{t, 0.0f};
         scale = glm::vec3{s, 1.0f};
         hidden = false;
@@ -73,13 +73,25 @@ struct Sprite : public TRS {
     AnimationFrames::iterator frame_it;
     uint16_t frame_ms;
     glm::ivec2 flip;
+    glm::vec4 tint;
+    /// @brief Sprites of a lower layer are drawn first.
+    int32_t layer;
     bool hidden;
 };
 
+struct TileLayer;
+
 struct SpriteRenderer {
     SpriteRenderer(float width, float height);
+    /// @brief Takes a sprite from a pool of BYTESIZED_SPRITE_COUNT, it keeps its address until it
+    /// is freed. Sprites are drawn in the order they were created within a layer.
+    Sprite *createSprite(const glm::vec2 &t, const glm::vec2 &s);
+    void freeSprite(Sprite *sprite);
     void update(uint16_t dt);
     void render();
-    std::list<Sprite> sprites;
+    std::vector<Sprite *> sprites;
+    /// @brief Drawn in order before the sprites, culled against projection.
+    std::vector<TileLayer *> tileLayers;
     glm::mat4 projection;
+    gpu::SpriteBatch batch;
 };
\ No newline at end of file
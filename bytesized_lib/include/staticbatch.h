@@ -0,0 +1,79 @@
+#pragma once
+
+#include "bytesized_info.h"
+#include "gpu.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+struct BakedVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+struct BakedGeometry {
+    gpu::Material *material;
+    std::vector<BakedVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+/// @brief Nodes that never move, pre-transformed and merged into one vertex and index buffer per
+/// material and cell. Nodes are assigned to a cell of BYTESIZED_STATIC_CELL world units by the
+/// position of their root, a cell is culled as a whole and rebaked only when its nodes change.
+struct StaticBatch {
+    struct Batch {
+        /// @brief Retained while the batch exists, freed when its cell is rebaked or disposed.
+        gpu::Material *material;
+        uint32_t *vbo;
+        uint32_t *ebo;
+        uint32_t count;
+    };
+
+    struct Cell {
+        glm::ivec3 key;
+        glm::vec3 min;
+        glm::vec3 max;
+        std::vector<gpu::Node *> nodes;
+        std::vector<Batch> batches;
+        bool dirty;
+    };
+
+    explicit StaticBatch(float cellSize_ = BYTESIZED_STATIC_CELL) : cellSize{cellSize_} {}
+
+    void add(gpu::Node *node);
+    /// @brief Takes the node out of its cell, it is then drawn like any other node.
+    void remove(gpu::Node *node);
+    bool contains(const gpu::Node *node) const { return _nodeCells.contains(node); }
+    /// @brief Rebakes the cell of a node after it was hidden or its meshes changed.
+    void invalidate(const gpu::Node *node);
+    /// @brief Keeps node out of the batch while it is edited. Returns the node excluded before,
+    /// which is no longer part of the batch and has to be added again if it is still static.
+    gpu::Node *exclude(gpu::Node *node);
+
+    glm::ivec3 cellKey(const glm::vec3 &position) const;
+    /// @brief Merges the visible meshes of the cell's nodes per material, in world space.
+    void buildCell(const Cell &cell, std::vector<BakedGeometry> &geometry) const;
+    /// @brief Uploads the dirty cells, returns how many were rebaked.
+    uint32_t bake();
+    /// @brief Draws every cell, with cull only those that pass occlusion::isVisible.
+    void render(gpu::ShaderProgram *shaderProgram, bool cull);
+    void dispose();
+
+    uint32_t drawCalls() const { return _drawCalls; }
+
+    float cellSize;
+    std::vector<Cell> cells;
+    gpu::VertexArray *vao{nullptr};
+
+  private:
+    void _freeBatches(Cell &cell);
+
+    std::unordered_map<uint64_t, uint32_t> _cellIndices;
+    std::unordered_map<const gpu::Node *, uint32_t> _nodeCells;
+    gpu::Node *_excluded{nullptr};
+    std::vector<BakedGeometry> _geometry;
+    std::vector<const Batch *> _visible;
+    uint32_t _drawCalls{0};
+};
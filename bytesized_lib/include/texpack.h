@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Offline packed textures: a full mip chain, optionally block compressed, that uploads without
+// any runtime decoding.
+namespace texpack {
+
+enum Format : uint32_t {
+    RGBA8,
+    BC1,
+    BC3,
+    BC5,
+    ETC2_RGB8,
+    ETC2_RGBA8,
+};
+
+static constexpr uint8_t MAGIC[4] = {'B', 'S', 'T', 'X'};
+static constexpr uint32_t MAX_LEVELS{16};
+
+struct Header {
+    uint8_t magic[4];
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levels;
+    uint32_t offsets[MAX_LEVELS]; // relative to the start of the header
+    uint32_t sizes[MAX_LEVELS];
+};
+
+/// @brief Bytes per 4x4 block, or per pixel for RGBA8.
+uint32_t blockSize(Format format);
+bool isCompressed(Format format);
+uint32_t levelSize(Format format, uint32_t width, uint32_t height);
+uint32_t levelCount(uint32_t width, uint32_t height);
+
+/// @brief Copies the header out of data, false unless data starts with a valid packed texture.
+bool header(const uint8_t *data, size_t len, Header &header);
+
+/// @brief Downsamples an RGBA8 image by two with a box filter, odd edges are clamped.
+void downsample(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst);
+
+void encodeBC1(const uint8_t rgba[64], uint8_t out[8]);
+void encodeBC3(const uint8_t rgba[64], uint8_t out[16]);
+void encodeBC5(const uint8_t rgba[64], uint8_t out[16]);
+void encodeETC2RGB(const uint8_t rgba[64], uint8_t out[8]);
+void encodeETC2RGBA(const uint8_t rgba[64], uint8_t out[16]);
+
+/// @brief Packs an RGBA8 image with its full mip chain in the given format.
+std::vector<uint8_t> pack(const uint8_t *rgba, uint32_t width, uint32_t height, Format format);
+
+} // namespace texpack
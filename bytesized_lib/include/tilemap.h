@@ -0,0 +1,76 @@
+#pragma once
+
+#include "bytesized_info.h"
+#include "sprite.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+struct TileVertex {
+    glm::vec2 position;
+    glm::vec2 uv;
+};
+
+/// @brief A grid of tiles indexing the regions of one atlas, split into square chunks of
+/// BYTESIZED_TILEMAP_CHUNK tiles. Every chunk has its own static vertex buffer, built the first
+/// time the chunk is visible and rebuilt only after one of its tiles changed.
+struct TileLayer {
+    static constexpr uint16_t EMPTY{UINT16_MAX};
+    static constexpr uint32_t CHUNK_SIZE{BYTESIZED_TILEMAP_CHUNK};
+
+    struct Chunk {
+        uint32_t *vbo{nullptr};
+        uint32_t quads{0};
+        bool dirty{true};
+    };
+
+    TileLayer(uint32_t width, uint32_t height, const glm::vec2 &tileSize, gpu::Texture *texture,
+              const AtlasRegion *regions, size_t regionCount);
+
+    template <std::size_t N, std::size_t M>
+    TileLayer(uint32_t width_, uint32_t height_, const glm::vec2 &tileSize_,
+              const Atlas<N, M> &atlas)
+        : TileLayer{width_, height_, tileSize_, atlas.texture, &atlas.regions[0][0], N * M} {}
+
+    template <std::size_t K>
+    TileLayer(uint32_t width_, uint32_t height_, const glm::vec2 &tileSize_,
+              gpu::Texture *texture_, const std::array<AtlasRegion, K> &spritesheet)
+        : TileLayer{width_, height_, tileSize_, texture_, spritesheet.data(), K} {}
+
+    uint16_t get(uint32_t x, uint32_t y) const { return tiles[y * width + x]; }
+    /// @brief Marks the chunk of the tile dirty only if the tile actually changes.
+    void set(uint32_t x, uint32_t y, uint16_t tile);
+    void fill(uint16_t tile);
+
+    /// @brief Appends the chunks overlapping the view of viewProjection, only the chunks inside
+    /// the view's bounds are visited.
+    void visibleChunks(const glm::mat4 &viewProjection, std::vector<uint32_t> &chunkIndices) const;
+    /// @brief Writes the quads of the non-empty tiles in the chunk and returns their count.
+    uint32_t buildChunk(uint32_t chunk, std::vector<TileVertex> &vertices) const;
+
+    void render(const glm::mat4 &projection, const glm::mat4 &view = glm::mat4{1.0f});
+    void dispose();
+
+    uint32_t drawCalls() const { return _drawCalls; }
+    uint32_t rebuiltChunks() const { return _rebuiltChunks; }
+
+    glm::vec2 origin{0.0f};
+    uint32_t width;
+    uint32_t height;
+    glm::vec2 tileSize;
+    gpu::Texture *texture;
+    const AtlasRegion *regions;
+    size_t regionCount;
+    uint32_t chunksX;
+    uint32_t chunksY;
+    std::vector<uint16_t> tiles;
+    std::vector<Chunk> chunks;
+    gpu::VertexArray *vao{nullptr};
+    uint32_t *ebo{nullptr};
+
+  private:
+    std::vector<uint32_t> _visible;
+    std::vector<TileVertex> _vertices;
+    uint32_t _drawCalls{0};
+    uint32_t _rebuiltChunks{0};
+};
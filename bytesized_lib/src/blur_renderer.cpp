@@ -55,45 +55,26 @@ static gpu::ShaderProgram *sharedShader() {
     return shader;
 }
 
-void BlurRenderer::create(const glm::ivec2 &resolution, gpu::ShaderProgram *shaderProgram_) {
-    shaderProgram = shaderProgram_ ? shaderProgram_ : sharedShader();
-    for (int i{0}; i < 2; ++i) {
-        blurFBO[i] = gpu::createFramebuffer();
-        blurFBO[i]->bind();
-        blurFBO[i]->createTexture(GL_COLOR_ATTACHMENT0, resolution.x, resolution.y,
-                                  gpu::ChannelSetting::RGB, GL_UNSIGNED_BYTE);
-        blurFBO[i]->unbind();
+rendergraph::Resource BlurRenderer::addPasses(rendergraph::Resource input,
+                                              const rendergraph::TextureDesc &desc,
+                                              size_t amount) {
+    if (shaderProgram == nullptr) {
+        shaderProgram = sharedShader();
     }
-}
-
-gpu::Texture *BlurRenderer::blur(gpu::Texture *inputTexture) {
-    shaderProgram->use();
-    size_t amount = 10;
-
-    blurFBO[0]->bind();
-    glClear(GL_COLOR_BUFFER_BIT);
-    blurFBO[1]->bind();
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glActiveTexture(GL_TEXTURE0);
-
-    bool horizontal = true, first_iteration = true;
+    rendergraph::Resource source = input;
     for (size_t i = 0; i < amount; i++) {
-        blurFBO[horizontal]->bind();
-        shaderProgram->uniforms.at("u_horizontal") << horizontal;
-        if (first_iteration) {
-            inputTexture->bind();
-            first_iteration = false;
-        } else {
-            blurFBO[!horizontal]->textures.at(GL_COLOR_ATTACHMENT0)->bind();
-        }
-        gpu::renderScreen();
-        horizontal = !horizontal;
+        const bool horizontal = i % 2 == 0;
+        // each target lives from its pass to the next, so every other one shares a texture
+        const rendergraph::Resource target = rendergraph::createTexture("blur", desc);
+        rendergraph::addPass(horizontal ? "blur.h" : "blur.v", {source}, {target},
+                             [this, source, horizontal] {
+                                 shaderProgram->use();
+                                 shaderProgram->uniforms.at("u_horizontal") << horizontal;
+                                 gpu::Texture_activeUnit(0);
+                                 rendergraph::texture(source)->bind();
+                                 gpu::renderScreen();
+                             });
+        source = target;
     }
-    blurFBO[0]->unbind();
-    return outputTexture();
+    return source;
 }
-
-gpu::Texture *BlurRenderer::outputTexture() {
-    return blurFBO[0]->textures.at(GL_COLOR_ATTACHMENT0);
-}
\ No newline at end of file
@@ -2,10 +2,13 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 
+#include "jobs.h"
 #include "logging.h"
 #include "opengl.h"
 #include "primer.h"
 #include "stb_image.h"
+#include "texpack.h"
+#include <cstring>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <unordered_set>
@@ -44,16 +47,95 @@ void gpu::printAllocations() {
     PRINT_USAGE(SHADERPROGRAMS);
     PRINT_USAGE(TEXTS);
     PRINT_USAGE(FRAMEBUFFERS);
+    gpu::printGeometryArenas();
 #ifdef BYTESIZED_USE_SKINNING
     gpu::printSkinningUsages();
 #endif
+    gpu::ResourceCache_print();
     printf("-------------------------\n\n");
 }
 
+#define UPDATE_USAGE(var)                                                                          \
+    do {                                                                                           \
+        if (i == pools.size()) {                                                                   \
+            pools.push_back({#var, 0, 0, static_cast<uint32_t>(var.size())});                      \
+        }                                                                                          \
+        pools[i].used = static_cast<uint32_t>(var.used());                                         \
+        pools[i].highWater = std::max(pools[i].highWater, pools[i].used);                          \
+        ++i;                                                                                       \
+    } while (0);
+
+void gpu::updatePoolUsage(std::vector<PoolUsage> &pools) {
+    size_t i{0};
+    UPDATE_USAGE(VERTEXARRAYS);
+    UPDATE_USAGE(VERTEXBUFFERS);
+    UPDATE_USAGE(TEXTURES);
+    UPDATE_USAGE(MATERIALS);
+    UPDATE_USAGE(UBOS);
+    UPDATE_USAGE(MESHES);
+    UPDATE_USAGE(PRIMITIVES);
+    UPDATE_USAGE(NODES);
+    UPDATE_USAGE(SCENES);
+    UPDATE_USAGE(SHADERS);
+    UPDATE_USAGE(SHADERPROGRAMS);
+    UPDATE_USAGE(TEXTS);
+    UPDATE_USAGE(FRAMEBUFFERS);
+}
+
+// textures stay a plain array of ids for glGenTextures, their counts live next to them
+static uint32_t _textureRefs[BYTESIZED_TEXTURE_COUNT];
+
+template <typename T, std::size_t N> static T *_acquire(recycler<T, N> &pool) {
+    T *t = pool.acquire();
+    t->refs = 1;
+    return t;
+}
+
+static gpu::Texture *_acquireTexture() {
+    gpu::Texture *texture = TEXTURES.acquire();
+    _textureRefs[texture - TEXTURES.data()] = 1;
+    return texture;
+}
+
+static gpu::Material *_acquireMaterial() {
+    gpu::Material *material = _acquire(MATERIALS);
+    material->id = static_cast<uint32_t>(material - MATERIALS.data());
+    return material;
+}
+
+static gpu::ContentCache<gpu::Primitive> _primitiveCache;
+static gpu::ContentCache<gpu::Material> _materialCache;
+static gpu::ContentCache<gpu::Texture> _textureCache;
+
 static gpu::Material *_builtinMaterials[gpu::MATERIAL_COUNT];
+static gpu::MaterialParams _materialBlock[gpu::MATERIAL_BLOCK_ROWS];
+static gpu::UniformBuffer *_materialUBO{nullptr};
+
 static gpu::Material *_overrideMaterial{nullptr};
 static gpu::Texture *_blankDiffuse{nullptr};
 
+gpu::ResourceCacheStats gpu::ResourceCache_stats(CachedResource resource) {
+    switch (resource) {
+    case CachedResource::PRIMITIVE:
+        return _primitiveCache.stats();
+    case CachedResource::MATERIAL:
+        return _materialCache.stats();
+    case CachedResource::TEXTURE:
+        return _textureCache.stats();
+    default:
+        return {};
+    }
+}
+
+void gpu::ResourceCache_print() {
+    static const char *names[] = {"primitives", "materials", "textures"};
+    for (size_t i{0}; i < static_cast<size_t>(CachedResource::COUNT); ++i) {
+        const ResourceCacheStats stats = ResourceCache_stats(static_cast<CachedResource>(i));
+        printf("cached %s: %u, hits: %u, misses: %u, saved: %.1f KB\n", names[i], stats.entries,
+               stats.hits, stats.misses, stats.bytesSaved * 1e-3f);
+    }
+}
+
 template <std::size_t W, std::size_t H, std::size_t C> struct StaticTexture {
     constexpr StaticTexture(glm::vec4 (*func)(uint32_t x, uint32_t y)) : buf{} {
         size_t i{0};
@@ -89,18 +171,17 @@ void gpu::allocate() {
     uint8_t onePixel[]{0xFF, 0xFF, 0xFF};
     _blankDiffuse = createTexture(onePixel, 1, 1, ChannelSetting::RGB, GL_UNSIGNED_BYTE);
 
-    _builtinMaterials[BuiltinMaterial::CHECKERS] = MATERIALS.acquire();
+    _builtinMaterials[BuiltinMaterial::CHECKERS] = _acquireMaterial();
     _builtinMaterials[BuiltinMaterial::CHECKERS]->color = 0xFF00FF;
     constexpr StaticTexture<8, 8, 3> checkers_tex{[](uint32_t x, uint32_t y) {
         return glm::vec4(glm::vec3(0.75f + ((y % 2 + x) % 2) * 0.25f), 1.0f);
     }};
-    _builtinMaterials[BuiltinMaterial::CHECKERS]->textures.emplace(
-        GL_TEXTURE0,
+    _builtinMaterials[BuiltinMaterial::CHECKERS]->textures[0] =
         createTexture(checkers_tex.buf, checkers_tex.width, checkers_tex.height,
-                      static_cast<ChannelSetting>(checkers_tex.channels), GL_UNSIGNED_BYTE));
+                      static_cast<ChannelSetting>(checkers_tex.channels), GL_UNSIGNED_BYTE);
 
     // auto gridColor = rgb(1, 0, 0); // 0x44AAFF
-    _builtinMaterials[BuiltinMaterial::GRID_TILE] = MATERIALS.acquire();
+    _builtinMaterials[BuiltinMaterial::GRID_TILE] = _acquireMaterial();
     _builtinMaterials[BuiltinMaterial::GRID_TILE]->color = rgb(60, 178, 237);
     constexpr size_t quad_width = 64;
     constexpr size_t quad_height = 64;
@@ -110,16 +191,15 @@ void gpu::allocate() {
         bool paint = (x <= 1 || x == (quad_width / 2 + 1) || y <= 1 || y == (quad_width / 2 + 1));
         return glm::vec4(paint ? 1.0f : 0.24f);
     }};
-    _builtinMaterials[BuiltinMaterial::GRID_TILE]->textures.emplace(
-        GL_TEXTURE0,
+    _builtinMaterials[BuiltinMaterial::GRID_TILE]->textures[0] =
         createTexture(quadratic_tex.buf, quadratic_tex.width, quadratic_tex.height,
-                      static_cast<ChannelSetting>(quadratic_tex.channels), GL_UNSIGNED_BYTE));
+                      static_cast<ChannelSetting>(quadratic_tex.channels), GL_UNSIGNED_BYTE);
 
-    _builtinMaterials[BuiltinMaterial::WHITE] = MATERIALS.acquire();
+    _builtinMaterials[BuiltinMaterial::WHITE] = _acquireMaterial();
     _builtinMaterials[BuiltinMaterial::WHITE]->color = 0xFFFFFF;
-    _builtinMaterials[BuiltinMaterial::WHITE]->textures.emplace(GL_TEXTURE0, _blankDiffuse);
+    _builtinMaterials[BuiltinMaterial::WHITE]->textures[0] = retainTexture(_blankDiffuse);
 
-    _builtinMaterials[BuiltinMaterial::COLOR_MAP] = MATERIALS.acquire();
+    _builtinMaterials[BuiltinMaterial::COLOR_MAP] = _acquireMaterial();
     _builtinMaterials[BuiltinMaterial::COLOR_MAP]->color = rgb(255, 255, 255);
     constexpr StaticTexture<8, 8, 4> colormap_tex{[](uint32_t x, uint32_t y) {
         glm::vec3 c;
@@ -151,16 +231,25 @@ void gpu::allocate() {
         }
         return glm::vec4(c * (float)(y + 1.0f) / 8.0f, 1.0f);
     }};
-    _builtinMaterials[BuiltinMaterial::COLOR_MAP]->textures.emplace(
-        GL_TEXTURE0,
+    _builtinMaterials[BuiltinMaterial::COLOR_MAP]->textures[0] =
         createTexture(colormap_tex.buf, colormap_tex.width, colormap_tex.height,
-                      static_cast<ChannelSetting>(colormap_tex.channels), GL_UNSIGNED_BYTE));
+                      static_cast<ChannelSetting>(colormap_tex.channels), GL_UNSIGNED_BYTE);
 }
 
 void gpu::dispose() {
+    disposeGeometryArenas();
+    disposeUniformStream();
+    disposeTextureLoader();
+    _primitiveCache.clear();
+    _materialCache.clear();
+    _textureCache.clear();
+    forgetImageKeys();
+    _materialUBO = nullptr;
+    std::fill(std::begin(_materialBlock), std::end(_materialBlock), gpu::MaterialParams{});
     glDeleteVertexArrays(BYTESIZED_VERTEXARRAY_COUNT, (uint32_t *)VERTEXARRAYS.data());
     glDeleteBuffers(BYTESIZED_VERTEXBUFFER_COUNT, VERTEXBUFFERS.data());
     glDeleteTextures(BYTESIZED_TEXTURE_COUNT, (GLuint *)TEXTURES.data());
+    Texture_resetBindings();
     for (size_t i{0}; i < SHADERS.count(); ++i) {
         glDeleteShader(SHADERS[i].id);
     }
@@ -173,7 +262,10 @@ void gpu::dispose() {
 
 void gpu::setOverrideMaterial(gpu::Material *material) { _overrideMaterial = material; }
 
-void gpu::Framebuffer::bind() { glBindFramebuffer(GL_FRAMEBUFFER, id); }
+void gpu::Framebuffer::bind() {
+    Stats_stateChange(StateChange::FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, id);
+}
 void gpu::Framebuffer::attach(uint32_t attachment, Texture *texture) {
     glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture->id, 0);
     textures.emplace(attachment, texture);
@@ -203,46 +295,57 @@ void gpu::Framebuffer::unbind() { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
 
 gpu::VertexArray *gpu::createVertexArray() { return VERTEXARRAYS.acquire(); }
 uint32_t *gpu::createVertexBuffer() { return VERTEXBUFFERS.acquire(); }
+void gpu::freeVertexBuffer(uint32_t *vbo) { VERTEXBUFFERS.free(vbo); }
 
 gpu::Mesh *gpu::createMesh() {
-    gpu::Mesh *mesh = MESHES.acquire();
+    gpu::Mesh *mesh = _acquire(MESHES);
     return mesh;
 }
 
 gpu::Mesh *gpu::createMesh(gpu::Primitive *primitive, gpu::Material *material) {
     auto mesh = createMesh();
-    mesh->primitives.emplace_back(primitive, material ? material : builtinMaterial(CHECKERS));
+    mesh->primitives.emplace_back(retainPrimitive(primitive),
+                                  retainMaterial(material ? material : builtinMaterial(CHECKERS)));
+    return mesh;
+}
+
+gpu::Mesh *gpu::retainMesh(gpu::Mesh *mesh) {
+    ++mesh->refs;
     return mesh;
 }
 
 gpu::Primitive *gpu::createPrimitive(const glm::vec3 *positions, const glm::vec3 *normals,
                                      const glm::vec2 *uvs, size_t vertex_count,
                                      const uint16_t *indices, size_t index_count) {
-    gpu::Primitive *prim = PRIMITIVES.acquire();
+    gpu::Primitive *prim = _acquire(PRIMITIVES);
     prim->vao = VERTEXARRAYS.acquire();
     prim->vao->bind();
 
     uint32_t *vbo = prim->vbos.emplace_back(VERTEXBUFFERS.acquire());
     glBindBuffer(GL_ARRAY_BUFFER, *vbo);
     glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(glm::vec3), positions, GL_STATIC_DRAW);
+    Stats_bufferUpload(vertex_count * sizeof(glm::vec3));
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
     glEnableVertexAttribArray(0);
 
     vbo = prim->vbos.emplace_back(VERTEXBUFFERS.acquire());
     glBindBuffer(GL_ARRAY_BUFFER, *vbo);
     glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(glm::vec3), normals, GL_STATIC_DRAW);
+    Stats_bufferUpload(vertex_count * sizeof(glm::vec3));
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
     glEnableVertexAttribArray(1);
 
     vbo = prim->vbos.emplace_back(VERTEXBUFFERS.acquire());
     glBindBuffer(GL_ARRAY_BUFFER, *vbo);
     glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(glm::vec2), uvs, GL_STATIC_DRAW);
+    Stats_bufferUpload(vertex_count * sizeof(glm::vec2));
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
     glEnableVertexAttribArray(2);
 
     prim->ebo = VERTEXBUFFERS.acquire();
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *prim->ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(uint16_t), indices, GL_STATIC_DRAW);
+    Stats_bufferUpload(index_count * sizeof(uint16_t));
     prim->count = index_count;
     return prim;
 }
@@ -252,6 +355,34 @@ gpu::Primitive *gpu::createPrimitive(const VertexObject &vertexObject) {
                            vertexObject.indices.data(), vertexObject.indices.size());
 }
 
+gpu::Primitive *gpu::retainPrimitive(gpu::Primitive *primitive) {
+    ++primitive->refs;
+    return primitive;
+}
+
+void gpu::freePrimitive(gpu::Primitive *primitive) {
+    assert(primitive->refs > 0);
+    if (--primitive->refs > 0) {
+        return;
+    }
+    if (primitive->arena) {
+        arenaFree(*primitive);
+    } else {
+        if (primitive->vao) {
+            VERTEXARRAYS.free(primitive->vao);
+        }
+        for (uint32_t *vbo : primitive->vbos) {
+            VERTEXBUFFERS.free(vbo);
+        }
+        if (primitive->ebo) {
+            VERTEXBUFFERS.free(primitive->ebo);
+        }
+    }
+    _primitiveCache.erase(primitive);
+    *primitive = {};
+    PRIMITIVES.free(primitive);
+}
+
 gpu::Material *gpu::builtinMaterial(BuiltinMaterial builtinMaterial) {
     return _builtinMaterials[builtinMaterial];
 }
@@ -271,7 +402,10 @@ void gpu::freeFramebuffer(gpu::Framebuffer *fbo) {
 static const int _charbuf_len = 1024;
 static GLchar _charbuf[_charbuf_len] = {};
 
-void gpu::ShaderProgram::use() { glUseProgram(id); }
+void gpu::ShaderProgram::use() {
+    Stats_stateChange(StateChange::PROGRAM);
+    glUseProgram(id);
+}
 
 gpu::Uniform *gpu::ShaderProgram::uniform(const char *key) {
     auto it = uniforms.find(key);
@@ -297,17 +431,39 @@ bool gpu::Shader_compile(const gpu::Shader &shader, const char *src) {
     return true;
 }
 
+static bool _compileDeferred(gpu::Shader &shader) {
+    if (shader.source.empty()) {
+        return true;
+    }
+    const bool compiled = gpu::Shader_compile(shader, shader.source.c_str());
+    shader.source.clear();
+    return compiled;
+}
+
 void gpu::Shader_createProgram(ShaderProgram &prog) {
     prog.id = glCreateProgram();
-    glAttachShader(prog.id, prog.vertex->id);
-    glAttachShader(prog.id, prog.fragment->id);
-    glLinkProgram(prog.id);
-    GLint res = GL_FALSE;
-    glGetProgramiv(prog.id, GL_LINK_STATUS, &res);
-    if (!res) {
-        glGetProgramInfoLog(prog.id, _charbuf_len, NULL, _charbuf);
-        printf("%s\n", _charbuf);
-        return;
+    const uint64_t key = fnv1a(&prog.fragment->hash, sizeof(uint64_t),
+                               fnv1a(&prog.vertex->hash, sizeof(uint64_t)));
+    if (!ProgramCache_load(key, prog.id)) {
+        if (!_compileDeferred(*prog.vertex) || !_compileDeferred(*prog.fragment)) {
+            return;
+        }
+        glAttachShader(prog.id, prog.vertex->id);
+        glAttachShader(prog.id, prog.fragment->id);
+#ifndef __EMSCRIPTEN__
+        if (ProgramCache_enabled()) {
+            glProgramParameteri(prog.id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+#endif
+        glLinkProgram(prog.id);
+        GLint res = GL_FALSE;
+        glGetProgramiv(prog.id, GL_LINK_STATUS, &res);
+        if (!res) {
+            glGetProgramInfoLog(prog.id, _charbuf_len, NULL, _charbuf);
+            printf("%s\n", _charbuf);
+            return;
+        }
+        ProgramCache_store(key, prog.id);
     }
     prog.use();
     for (auto it = prog.uniforms.begin(); it != prog.uniforms.end(); ++it) {
@@ -318,14 +474,14 @@ void gpu::Shader_createProgram(ShaderProgram &prog) {
 
 gpu::Texture *gpu::createTexture(const uint8_t *data, uint32_t width, uint32_t height,
                                  ChannelSetting channels, uint32_t type) {
-    gpu::Texture *texture = TEXTURES.acquire();
+    gpu::Texture *texture = _acquireTexture();
     Texture_create(*texture, data, width, height, channels, type);
     return texture;
 }
 
 gpu::Texture *gpu::createTextureFromFile(const char *path, bool flip) {
     int iw, ih, ic;
-    stbi_set_flip_vertically_on_load(flip);
+    stbi_set_flip_vertically_on_load_thread(flip);
     const uint8_t *idata = stbi_load(path, &iw, &ih, &ic, 0);
     auto *tex = createTexture(idata, iw, ih, static_cast<ChannelSetting>(ic), GL_UNSIGNED_BYTE);
     stbi_image_free((void *)idata);
@@ -333,16 +489,29 @@ gpu::Texture *gpu::createTextureFromFile(const char *path, bool flip) {
 }
 
 gpu::Texture *gpu::createTextureFromMem(const uint8_t *addr, uint32_t len, bool flip) {
+    texpack::Header header;
+    if (texpack::header(addr, len, header)) {
+        // baked offline with its mips, orientation is decided at bake time
+        gpu::Texture *texture = _acquireTexture();
+        Texture_createPacked(*texture, addr, len);
+        return texture;
+    }
     int iw, ih, ic;
-    stbi_set_flip_vertically_on_load(flip);
+    stbi_set_flip_vertically_on_load_thread(flip);
     const uint8_t *idata = stbi_load_from_memory((uint8_t *)addr, len, &iw, &ih, &ic, 0);
     auto *tex = createTexture(idata, iw, ih, static_cast<ChannelSetting>(ic), GL_UNSIGNED_BYTE);
     stbi_image_free((void *)idata);
     return tex;
 }
 gpu::Texture *gpu::createTexture(const library::Texture &texture) {
-    return createTextureFromMem((uint8_t *)texture.image->view->data(), texture.image->view->length,
-                                false);
+    const ContentKey key = contentKey(texture);
+    if (gpu::Texture *cached = _textureCache.find(key, key.size)) {
+        return retainTexture(cached);
+    }
+    gpu::Texture *created = createTextureAsync((uint8_t *)texture.image->view->data(),
+                                               texture.image->view->length, false);
+    _textureCache.insert(key, created);
+    return created;
 }
 
 gpu::Texture *gpu::createTexture(const bdf::Font &font) {
@@ -368,7 +537,25 @@ gpu::Texture *gpu::createTexture(const bdf::Font &font) {
                               GL_UNSIGNED_BYTE);
 }
 
-void gpu::freeTexture(gpu::Texture *texture) { TEXTURES.free(texture); }
+gpu::Texture *gpu::retainTexture(gpu::Texture *texture) {
+    ++_textureRefs[texture - TEXTURES.data()];
+    return texture;
+}
+
+void gpu::freeTexture(gpu::Texture *texture) {
+    uint32_t &refs = _textureRefs[texture - TEXTURES.data()];
+    assert(refs > 0);
+    if (--refs > 0) {
+        return;
+    }
+    _textureCache.erase(texture);
+    TextureLoader_cancel(texture);
+    TEXTURES.free(texture);
+}
+
+uint32_t gpu::textureRefs(const gpu::Texture *texture) {
+    return _textureRefs[texture - TEXTURES.data()];
+}
 
 gpu::Text *gpu::createText(const bdf::Font &font, const char *txt, bool center) {
     gpu::Text *text = TEXTS.acquire();
@@ -376,18 +563,8 @@ gpu::Text *gpu::createText(const bdf::Font &font, const char *txt, bool center)
     if (font.gpuInstance == nullptr) {
         const_cast<bdf::Font &>(font).gpuInstance = createTexture(font);
     }
-    gpu::Material *mat = MATERIALS.acquire();
-    mat->textures.emplace(GL_TEXTURE0, (gpu::Texture *)font.gpuInstance);
-    mat->color = Color::white;
-    text->node->mesh = MESHES.acquire();
     text->node->hidden = false;
-    gpu::Primitive *primitive = PRIMITIVES.acquire();
-    text->node->mesh->primitives.emplace_back(primitive, mat);
-    primitive->vao = VERTEXARRAYS.acquire();
-    primitive->vbos.emplace_back(VERTEXBUFFERS.acquire());
-    primitive->ebo = VERTEXBUFFERS.acquire();
     text->bdfFont = &font;
-    text->init();
     text->setText(txt, center);
     return text;
 }
@@ -395,114 +572,133 @@ gpu::Text *gpu::createText(const bdf::Font &font, const char *txt, bool center)
 void gpu::freeText(gpu::Text *text) {
     text->setText("", false);
     text->bdfFont = nullptr;
+    text->version = 0;
     freeNode(text->node);
     text->node = nullptr;
+    TEXTS.free(text);
 }
 
-gpu::Material *gpu::createMaterial() { return MATERIALS.acquire(); }
+gpu::Material *gpu::createMaterial() { return _acquireMaterial(); }
 
 gpu::Material *gpu::createMaterial(const Color &color) {
-    gpu::Material *mat = MATERIALS.acquire();
+    gpu::Material *mat = _acquireMaterial();
     mat->color = color;
-    mat->textures.emplace(GL_TEXTURE0, _blankDiffuse);
+    mat->textures[0] = retainTexture(_blankDiffuse);
     return mat;
 }
 
 gpu::Material *gpu::createMaterial(gpu::Texture *texture) {
-    gpu::Material *mat = MATERIALS.acquire();
+    gpu::Material *mat = _acquireMaterial();
     mat->color = Color::white;
-    mat->textures.emplace(GL_TEXTURE0, texture);
+    mat->textures[0] = retainTexture(texture);
     return mat;
 }
 
 gpu::Material *gpu::createMaterial(const library::Material &material) {
-    gpu::Material *mat = MATERIALS.acquire();
-    bool noTex = true;
+    // shared by every primitive with the same parameters and images, edit a copy to change one
+    const ContentKey key = contentKey(material);
+    if (gpu::Material *cached = _materialCache.find(key, 0)) {
+        return retainMaterial(cached);
+    }
+    gpu::Material *mat = _acquireMaterial();
+    _materialCache.insert(key, mat);
     for (size_t i{0}; i < library::Material::TEX_COUNT; ++i) {
         if (material.textures[i]) {
-            mat->textures.emplace(GL_TEXTURE0 + i, createTexture(*material.textures[i]));
-            noTex = false;
-        }
-        // Add white texture to empty ones for convenience. (to reduce n.o shaders)
-        // Not minimalistic
-        if (noTex) {
-            mat->textures.emplace(GL_TEXTURE0,
-                                  builtinMaterial(gpu::WHITE)->textures.at(GL_TEXTURE0));
+            mat->textures[i] = createTexture(*material.textures[i]);
         }
-        mat->color = material.baseColor;
-        mat->metallic = material.metallic;
-        mat->roughness = material.roughness;
     }
+    // Add white texture to empty ones for convenience. (to reduce n.o shaders)
+    // Not minimalistic
+    if (mat->textures[0] == nullptr) {
+        mat->textures[0] = retainTexture(builtinMaterial(gpu::WHITE)->textures[0]);
+    }
+    mat->color = material.baseColor;
+    mat->metallic = material.metallic;
+    mat->roughness = material.roughness;
     return mat;
 }
 
+gpu::Material *gpu::retainMaterial(gpu::Material *material) {
+    ++material->refs;
+    return material;
+}
+
 void gpu::freeMaterial(gpu::Material *material) {
-    for (const auto &it : material->textures) {
-        bool onlyUserTexture{true};
-        for (size_t i{0}; i < MATERIALS.count(); ++i) {
-            if (material == &MATERIALS[i]) {
-                continue;
-            }
-            for (const auto &it2 : MATERIALS[i].textures) {
-                if (it.second == it2.second) {
-                    onlyUserTexture = false;
-                    break;
-                }
-            }
-            if (!onlyUserTexture) {
-                break;
-            }
-        }
-        if (onlyUserTexture) {
-            freeTexture(it.second);
+    assert(material->refs > 0);
+    if (--material->refs > 0) {
+        return;
+    }
+    for (Texture *texture : material->textures) {
+        if (texture) {
+            freeTexture(texture);
         }
     }
-    material->textures.clear();
+    _materialCache.erase(material);
+    material->textures = {};
     MATERIALS.free(material);
 }
 
+static gpu::Primitive *_createPrimitive(const library::Primitive &libraryPrimitive) {
+    gpu::Primitive *primitive = _acquire(PRIMITIVES);
+    if (gpu::arenaAllocate(libraryPrimitive, *primitive)) {
+        return primitive;
+    }
+    primitive->vao = VERTEXARRAYS.acquire();
+    primitive->vao->bind();
+    for (size_t j{0}; j < library::Primitive::Attribute::COUNT; ++j) {
+        const library::Accessor *libraryAttr = libraryPrimitive.attributes[j];
+        if (libraryAttr == nullptr) {
+            continue;
+        }
+        uint32_t vbo = *primitive->vbos.emplace_back(VERTEXBUFFERS.acquire());
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, libraryAttr->bufferView->length,
+                     libraryAttr->bufferView->data(), GL_STATIC_DRAW);
+        gpu::Stats_bufferUpload(libraryAttr->bufferView->length);
+        int size = libraryAttr->type + 1;
+        assert(libraryAttr->type != library::Accessor::MAT4);
+        int stride;
+        if (libraryAttr->componentType == GL_FLOAT) {
+            stride = size * sizeof(float);
+        } else {
+            stride = size;
+        }
+        glVertexAttribPointer(j, size, libraryAttr->componentType, GL_FALSE, stride, (void *)0);
+        glEnableVertexAttribArray(j);
+    }
+    if (libraryPrimitive.indices) {
+        primitive->ebo = VERTEXBUFFERS.acquire();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *primitive->ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, libraryPrimitive.indices->bufferView->length,
+                     libraryPrimitive.indices->bufferView->buffer->data +
+                         libraryPrimitive.indices->bufferView->offset,
+                     GL_STATIC_DRAW);
+        gpu::Stats_bufferUpload(libraryPrimitive.indices->bufferView->length);
+        primitive->count = libraryPrimitive.indices->count;
+    } else {
+        primitive->count = libraryPrimitive.attributes[0]->count;
+    }
+    return primitive;
+}
+
 static gpu::Mesh *_createMesh(const library::Mesh &libraryMesh) {
-    gpu::Mesh *mesh = MESHES.acquire();
+    gpu::Mesh *mesh = _acquire(MESHES);
     for (size_t i{0}; i < libraryMesh.primitives.size(); ++i) {
         const auto &libraryPrimitive = libraryMesh.primitives[i];
-        auto &[primitive, material] = mesh->primitives.emplace_back(
-            PRIMITIVES.acquire(), libraryPrimitive.material
-                                      ? gpu::createMaterial(*libraryPrimitive.material)
-                                      : &MATERIALS[0]);
-        const_cast<library::Primitive &>(libraryPrimitive).gpuInstance = primitive;
-        primitive->vao = VERTEXARRAYS.acquire();
-        primitive->vao->bind();
-        for (size_t j{0}; j < library::Primitive::Attribute::COUNT; ++j) {
-            const library::Accessor *libraryAttr = libraryPrimitive.attributes[j];
-            if (libraryAttr == nullptr) {
-                continue;
-            }
-            uint32_t vbo = *primitive->vbos.emplace_back(VERTEXBUFFERS.acquire());
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            glBufferData(GL_ARRAY_BUFFER, libraryAttr->bufferView->length,
-                         libraryAttr->bufferView->data(), GL_STATIC_DRAW);
-            int size = libraryAttr->type + 1;
-            assert(libraryAttr->type != library::Accessor::MAT4);
-            int stride;
-            if (libraryAttr->componentType == GL_FLOAT) {
-                stride = size * sizeof(float);
-            } else {
-                stride = size;
-            }
-            glVertexAttribPointer(j, size, libraryAttr->componentType, GL_FALSE, stride, (void *)0);
-            glEnableVertexAttribArray(j);
-        }
-        if (libraryPrimitive.indices) {
-            primitive->ebo = VERTEXBUFFERS.acquire();
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *primitive->ebo);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, libraryPrimitive.indices->bufferView->length,
-                         libraryPrimitive.indices->bufferView->buffer->data +
-                             libraryPrimitive.indices->bufferView->offset,
-                         GL_STATIC_DRAW);
-            primitive->count = libraryPrimitive.indices->count;
+        // identical buffers from other files or collections are uploaded once
+        const gpu::ContentKey key = gpu::contentKey(libraryPrimitive);
+        gpu::Primitive *primitive = _primitiveCache.find(key, key.size);
+        if (primitive) {
+            gpu::retainPrimitive(primitive);
         } else {
-            primitive->count = libraryPrimitive.attributes[0]->count;
+            primitive = _createPrimitive(libraryPrimitive);
+            _primitiveCache.insert(key, primitive);
         }
+        mesh->primitives.emplace_back(primitive,
+                                      libraryPrimitive.material
+                                          ? gpu::createMaterial(*libraryPrimitive.material)
+                                          : gpu::retainMaterial(&MATERIALS[0]));
+        const_cast<library::Primitive &>(libraryPrimitive).gpuInstance = primitive;
     }
     mesh->libraryMesh = &libraryMesh;
     const_cast<library::Mesh *>(mesh->libraryMesh)->gpuInstance = mesh;
@@ -513,13 +709,13 @@ gpu::Node *gpu::createNode() { return NODES.acquire(); }
 
 gpu::Node *gpu::createNode(gpu::Mesh *mesh) {
     auto node = createNode();
-    node->mesh = mesh;
+    node->mesh = retainMesh(mesh);
     return node;
 }
 
 gpu::Node *gpu::createNode(const gpu::Node &other) {
     gpu::Node *node = createNode();
-    node->mesh = other.mesh;
+    node->mesh = other.mesh ? retainMesh(other.mesh) : nullptr;
     for (gpu::Node *child : other.children) {
         node->children.emplace_back(createNode(*child));
     }
@@ -543,7 +739,7 @@ gpu::Node *gpu::createNode(const library::Node &libraryNode) {
     if (libraryNode.mesh) {
         gpu::Mesh *loadedMesh = (gpu::Mesh *)libraryNode.mesh->gpuInstance;
         if (loadedMesh) {
-            node->mesh = loadedMesh;
+            node->mesh = retainMesh(loadedMesh);
             LOG_TRACE("Reusing mesh: %s", libraryNode.mesh->name.c_str());
         } else {
             node->mesh = _createMesh(*libraryNode.mesh);
@@ -573,52 +769,28 @@ gpu::Node *gpu::createNode(const library::Node &libraryNode) {
     return node;
 };
 
-static void freeMesh(gpu::Mesh *mesh) {
+void gpu::freeMesh(gpu::Mesh *mesh) {
+    assert(mesh->refs > 0);
+    if (--mesh->refs > 0) {
+        return;
+    }
     for (auto &[primitive, material] : mesh->primitives) {
-
-        VERTEXARRAYS.free(primitive->vao);
-        for (uint32_t *vbo : primitive->vbos) {
-            VERTEXBUFFERS.free(vbo);
+        if (primitive) {
+            freePrimitive(primitive);
         }
-        VERTEXBUFFERS.free(primitive->ebo);
-        primitive->vbos.clear();
-        /*if (material) {
-            bool onlyUserMaterial{true};
-            for (size_t i{0}; i < PRIMITIVES.count(); ++i) {
-                if (&PRIMITIVES[i] == primitive) {
-                    continue;
-                }
-                if (PRIMITIVES[i].material == material) {
-                    onlyUserMaterial = false;
-                    break;
-                }
-            }
-            if (onlyUserMaterial) {
-                MATERIALS.free(material);
-            }
-            material = nullptr;
-        }*/
+        freeMaterial(material);
     }
-    const_cast<library::Mesh *>(mesh->libraryMesh)->gpuInstance = nullptr;
+    if (mesh->libraryMesh) {
+        const_cast<library::Mesh *>(mesh->libraryMesh)->gpuInstance = nullptr;
+    }
+    mesh->libraryMesh = nullptr;
     mesh->primitives.clear();
     MESHES.free(mesh);
 }
 
 void gpu::freeNode(gpu::Node *node) {
     if (node->mesh) {
-        bool onlyMeshUser = true;
-        for (size_t i{0}; i < NODES.count(); ++i) {
-            if (&NODES[i] == node) {
-                continue;
-            }
-            if (NODES[i].mesh == node->mesh) {
-                onlyMeshUser = false;
-                break;
-            }
-        }
-        if (onlyMeshUser) {
-            freeMesh(node->mesh);
-        }
+        freeMesh(node->mesh);
     }
     node->entity = nullptr;
     node->hidden = false;
@@ -629,7 +801,7 @@ void gpu::freeNode(gpu::Node *node) {
     node->wireframe = false;
     node->mesh = nullptr;
     node->setParent(nullptr);
-    if (node->libraryNode->gpuInstance == node) {
+    if (node->libraryNode && node->libraryNode->gpuInstance == node) {
         const_cast<library::Node *>(node->libraryNode)->gpuInstance = nullptr;
     }
     node->libraryNode = nullptr;
@@ -688,24 +860,34 @@ static void invalidateRecursive(gpu::Node *node) {
 }
 
 void gpu::bindMaterial(gpu::ShaderProgram *shaderProgram, gpu::Material *material) {
-    if (auto color = shaderProgram->uniform("u_color")) {
-        *color << material->color.vec4();
-    }
-    if (auto metallic = shaderProgram->uniform("u_metallic")) {
-        *metallic << material->metallic;
+    const MaterialParams params{material->color.vec4(),
+                                glm::vec4{material->metallic, material->roughness, 0.0f, 0.0f}};
+    MaterialParams &row = _materialBlock[material->id];
+    if (_materialUBO && memcmp(&row, &params, sizeof(params)) != 0) {
+        row = params;
+        _materialUBO->bind();
+        _materialUBO->bufferSubData(material->id * sizeof(MaterialParams), sizeof(params), &row);
+        _materialUBO->unbind();
     }
-    if (auto metallic = shaderProgram->uniform("u_roughness")) {
-        *metallic << material->metallic;
+    if (auto index = shaderProgram->uniform("u_material")) {
+        *index << static_cast<int>(material->id);
     }
-    for (const auto &it : material->textures) {
-        // printf("%s: %u\n", this->libraryNode->name.c_str(), *it.second);
-        glActiveTexture(it.first);
-        glBindTexture(GL_TEXTURE_2D, it.second->id);
+    for (uint32_t i{0}; i < MATERIAL_TEXTURE_SLOTS; ++i) {
+        if (material->textures[i]) {
+            Texture_bind(i, material->textures[i]);
+        }
     }
+    Texture_activeUnit(0);
 }
 
 void gpu::Primitive::render() {
+    if (arena) {
+        Primitive *self = this;
+        arenaDraw(arena, &self, 1);
+        return;
+    }
     vao->bind();
+    Stats_draw(GL_TRIANGLES, count);
     if (ebo) {
         glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, NULL);
     } else {
@@ -714,6 +896,29 @@ void gpu::Primitive::render() {
     vao->unbind();
 }
 
+void gpu::Primitive::renderInstanced(uint32_t instances) {
+    Stats_draw(GL_TRIANGLES, count, instances);
+    if (arena) {
+        arena->vao->bind();
+        const void *offset = (const void *)(firstIndex * sizeof(uint32_t));
+#ifdef BYTESIZED_USE_BASEVERTEX
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, offset, instances,
+                                          baseVertex);
+#else
+        glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, offset, instances);
+#endif
+        arena->vao->unbind();
+        return;
+    }
+    vao->bind();
+    if (ebo) {
+        glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, NULL, instances);
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, count, instances);
+    }
+    vao->unbind();
+}
+
 void gpu::UniformBuffer::bindShader(gpu::ShaderProgram *shader) {
     bind();
     bindBlock(shader, label);
@@ -734,48 +939,190 @@ static gpu::CameraBlock cameraBlock;
 
 void gpu::CameraBlock_setProjection(const glm::mat4 &projection) {
     cameraBlock.projection = projection;
-    auto *ubo = builtinUBO(gpu::UBO_CAMERA);
-    ubo->bind();
-    ubo->bufferSubData(0, sizeof(gpu::CameraBlock::projection), &cameraBlock);
+    UniformStream_push(builtinUBO(gpu::UBO_CAMERA)->bindingPoint, &cameraBlock,
+                       sizeof(cameraBlock), true);
 }
 void gpu::CameraBlock_setViewPos(const glm::mat4 &view, const glm::vec3 &pos) {
     cameraBlock.view = view;
     cameraBlock.cameraPos = pos;
-    auto *ubo = builtinUBO(gpu::UBO_CAMERA);
-    ubo->bind();
-    ubo->bufferSubData(sizeof(glm::mat4), sizeof(glm::mat4) + sizeof(glm::vec3), &cameraBlock.view);
+    UniformStream_push(builtinUBO(gpu::UBO_CAMERA)->bindingPoint, &cameraBlock,
+                       sizeof(cameraBlock), true);
 }
 
-static gpu::SkinBlock skinBlock;
-gpu::SkinBlock &gpu::getSkinBlock() { return skinBlock; }
-
 static gpu::LightBlock lightBlock;
 void gpu::LightBlock_setLightColor(const Color &high, const Color &low, const Color &ambient) {
     lightBlock.lightHigh = high.vec4();
     lightBlock.lightLow = low.vec4();
     lightBlock.ambient = ambient.vec4();
-    auto *ubo = builtinUBO(gpu::UBO_LIGHT);
-    ubo->bind();
-    ubo->bufferData(sizeof(LightBlock), &lightBlock);
+    UniformStream_push(builtinUBO(gpu::UBO_LIGHT)->bindingPoint, &lightBlock, sizeof(lightBlock),
+                       true);
 }
 
 gpu::UniformBuffer *gpu::builtinUBO(BuiltinUBO bultinUBO) { return &UBOS.at(bultinUBO); }
 void gpu::createBuiltinUBOs() {
     static const char *cameraBlockLabel = "CameraBlock";
-    createUniformBuffer(UBO_CAMERA, cameraBlockLabel, sizeof(gpu::CameraBlock), &cameraBlock);
-    createUniformBuffer(UBO_LIGHT, "LightBlock", sizeof(gpu::LightBlock), &lightBlock);
-#ifdef BYTESIZED_USE_SKINNING
-    static const char *skinBlockLabel = "SkinBlock";
-    createUniformBuffer(UBO_SKINNING, skinBlockLabel, sizeof(gpu::SkinBlock), skinBlock.bones);
-#endif
+    // streamed blocks, only their binding points are kept
+    createUniformBuffer(UBO_CAMERA, cameraBlockLabel, 0);
+    createUniformBuffer(UBO_LIGHT, "LightBlock", 0);
+    _materialUBO =
+        createUniformBuffer(UBO_MATERIAL, "MaterialBlock", sizeof(_materialBlock), _materialBlock);
+    createUniformStream();
+    // the shaders include the block so that its size follows MATERIAL_BLOCK_ROWS, shared sources
+    // outlive gpu::dispose so it is only created once
+    static std::string materialBlock;
+    if (materialBlock.empty()) {
+        materialBlock = "layout (std140) uniform MaterialBlock\n{\n    vec4 u_materials[" +
+                        std::to_string(2 * MATERIAL_BLOCK_ROWS) + "];\n};\n";
+        createSharedSource("material_block.glsl", materialBlock.c_str());
+    }
 }
 
 #ifdef BYTESIZED_USE_SKINNING
-static void _updateBonesArray(gpu::Node *node) {
+// four RGBA32F texels per matrix, a matrix never straddles two rows
+constexpr uint32_t SKIN_PALETTE_WIDTH{1024};
+constexpr uint32_t SKIN_PALETTE_ROW_BONES{SKIN_PALETTE_WIDTH / 4};
+constexpr uint32_t SKIN_PALETTE_HEIGHT{
+    (BYTESIZED_SKINPALETTE_BONES + SKIN_PALETTE_ROW_BONES - 1) / SKIN_PALETTE_ROW_BONES};
+// the last MAX_BONES are kept for skins drawn outside the frame's batch, each uploads them in turn
+constexpr uint32_t SKIN_PALETTE_BATCH_BONES{SKIN_PALETTE_ROW_BONES * SKIN_PALETTE_HEIGHT -
+                                            gpu::MAX_BONES};
+static_assert(BYTESIZED_SKINPALETTE_BONES >= 2 * gpu::MAX_BONES,
+              "the skin palette holds a batched skin and the fallback slot");
+static std::vector<glm::mat4> _skinPalette;
+static gpu::Texture *_skinPaletteTexture{nullptr};
+static uint32_t _skinPaletteCursor{0};
+static uint32_t _skinPaletteFrame{1};
+
+static uint32_t _boneCount(gpu::Skin *skin) {
+    return std::min<uint32_t>(skin->joints.size(), gpu::MAX_BONES);
+}
+
+static void _updateBonesArray(gpu::Node *node, glm::mat4 *bones) {
+    gpu::Skin *skin = node->skin;
     const glm::mat4 globalWorldInverse = glm::inverse(node->model());
-    for (size_t j{0}; j < node->skin->joints.size() && j < gpu::MAX_BONES; ++j) {
-        skinBlock.bones[j] = globalWorldInverse * node->skin->joints.at(j)->model() *
-                             node->skin->librarySkin->inverseBindMatrices.at(j);
+    for (size_t j{0}; j < _boneCount(skin); ++j) {
+        bones[j] = globalWorldInverse * skin->joints[j]->model() *
+                   skin->librarySkin->inverseBindMatrices.at(j);
+    }
+}
+
+// skins sampled every tick have no palettes to interpolate between
+static bool _interpolated(const gpu::Skin *skin) { return skin->updateInterval != 1; }
+
+static bool _jointsChanged(const gpu::Skin *skin) {
+    return !_interpolated(skin) || skin->sampled || skin->toPalette.empty();
+}
+
+static void _updateBones(gpu::Node *node) {
+    gpu::Skin *skin = node->skin;
+    glm::mat4 *bones = _skinPalette.data() + skin->paletteOffset;
+    const uint32_t count = _boneCount(skin);
+    if (!_interpolated(skin)) {
+        _updateBonesArray(node, bones);
+        skin->toPalette.clear();
+        skin->sampled = false;
+        return;
+    }
+    if (_jointsChanged(skin)) {
+        const bool first = skin->toPalette.empty();
+        skin->fromPalette.swap(skin->toPalette);
+        skin->toPalette.resize(count);
+        _updateBonesArray(node, skin->toPalette.data());
+        if (first) {
+            skin->fromPalette = skin->toPalette;
+        }
+        skin->sampled = false;
+    }
+    const uint32_t interval = skin->updateInterval;
+    const float t = interval ? std::min<uint32_t>(skin->ticksSinceSample + 1u, interval) /
+                                   static_cast<float>(interval)
+                             : 1.0f;
+    for (uint32_t j{0}; j < count; ++j) {
+        bones[j] = skin->fromPalette[j] + (skin->toPalette[j] - skin->fromPalette[j]) * t;
+    }
+}
+
+static void _createPalette() {
+    if (_skinPalette.empty()) {
+        _skinPalette.resize(SKIN_PALETTE_ROW_BONES * SKIN_PALETTE_HEIGHT);
+        _skinPaletteTexture =
+            gpu::createTexture(nullptr, SKIN_PALETTE_WIDTH, SKIN_PALETTE_HEIGHT,
+                               gpu::ChannelSetting::RGBA, GL_FLOAT);
+    }
+}
+
+static bool _allocatePalette(gpu::Skin *skin) {
+    if (_skinPaletteCursor + _boneCount(skin) > SKIN_PALETTE_BATCH_BONES) {
+        return false;
+    }
+    skin->paletteOffset = _skinPaletteCursor;
+    _skinPaletteCursor += _boneCount(skin);
+    return true;
+}
+
+static void _uploadPalette(uint32_t first, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    const uint32_t row = first / SKIN_PALETTE_ROW_BONES;
+    const uint32_t end = (first + count + SKIN_PALETTE_ROW_BONES - 1) / SKIN_PALETTE_ROW_BONES;
+    const uint32_t rows = end - row;
+    gpu::Texture_activeUnit(gpu::SKIN_PALETTE_UNIT);
+    _skinPaletteTexture->bind();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, SKIN_PALETTE_WIDTH, rows, GL_RGBA, GL_FLOAT,
+                    _skinPalette.data() + row * SKIN_PALETTE_ROW_BONES);
+    gpu::Stats_textureUpload(SKIN_PALETTE_WIDTH * rows * sizeof(glm::vec4));
+    gpu::Texture_activeUnit(0);
+}
+
+void gpu::updateSkinPalettes(const std::vector<Node *> &nodes) {
+    static std::vector<Node *> skinned;
+    skinned.clear();
+    for (Node *node : nodes) {
+        node->recursive([](Node *n) {
+            if (n->skin) {
+                skinned.push_back(n);
+            }
+        });
+    }
+    _createPalette();
+    ++_skinPaletteFrame;
+    _skinPaletteCursor = 0;
+    size_t batched{0};
+    // transforms cache lazily and are not safe to resolve from several threads
+    for (Node *node : skinned) {
+        TRS *root = node;
+        while (root->parent()) {
+            root = root->parent();
+        }
+        if (!root->valid()) {
+            invalidateRecursive(static_cast<Node *>(root));
+        }
+        node->model();
+        // joints of skins in between samples have not moved
+        if (_jointsChanged(node->skin)) {
+            for (Node *joint : node->skin->joints) {
+                joint->model();
+            }
+        }
+        // skins that do not fit are left out of the batch and upload their own palette when drawn
+        if (_allocatePalette(node->skin)) {
+            node->skin->paletteFrame = _skinPaletteFrame;
+            skinned[batched++] = node;
+        }
+    }
+    if (batched < skinned.size()) {
+        LOG_WARN("Skin palette full, %zu skins drawn with their own upload",
+                 skinned.size() - batched);
+        skinned.resize(batched);
+    }
+    jobs::parallelFor(skinned.size(), 4, [](size_t begin, size_t end) {
+        for (size_t i{begin}; i < end; ++i) {
+            _updateBones(skinned[i]);
+        }
+    });
+    if (!skinned.empty()) {
+        _uploadPalette(0, _skinPaletteCursor);
     }
 }
 #endif
@@ -786,10 +1133,16 @@ void gpu::Node::render(ShaderProgram *shaderProgram) {
     }
 #ifdef BYTESIZED_USE_SKINNING
     if (skin) {
-        gpu::UniformBuffer *ubo = gpu::builtinUBO(gpu::UBO_SKINNING);
-        _updateBonesArray(this);
-        ubo->bind();
-        ubo->bufferData(sizeof(skinBlock), &skinBlock);
+        if (skin->paletteFrame != _skinPaletteFrame) {
+            // not part of this frame's batch, compute and upload on its own
+            _createPalette();
+            skin->paletteOffset = SKIN_PALETTE_BATCH_BONES;
+            _updateBones(this);
+            _uploadPalette(skin->paletteOffset, _boneCount(skin));
+        }
+        if (auto paletteOffset = shaderProgram->uniform("u_paletteOffset")) {
+            *paletteOffset << static_cast<int>(skin->paletteOffset);
+        }
     }
 #endif
     for (gpu::Node *child : children) {
@@ -802,9 +1155,27 @@ void gpu::Node::render(ShaderProgram *shaderProgram) {
 #endif
     if (!hidden && mesh && !mesh->primitives.empty()) {
         shaderProgram->uniforms.at("u_model") << model();
-        for (auto &[primitive, material] : mesh->primitives) {
+        static std::vector<Primitive *> batch;
+        const size_t count = mesh->primitives.size();
+        for (size_t i{0}; i < count;) {
+            auto [primitive, material] = mesh->primitives[i];
             bindMaterial(shaderProgram, _overrideMaterial ? _overrideMaterial : material);
-            primitive->render();
+            if (primitive->arena == nullptr) {
+                primitive->render();
+                ++i;
+                continue;
+            }
+            // consecutive primitives in the same arena and material merge into one draw
+            batch.clear();
+            for (; i < count; ++i) {
+                auto [next, nextMaterial] = mesh->primitives[i];
+                if (next->arena != primitive->arena ||
+                    (nextMaterial != material && _overrideMaterial == nullptr)) {
+                    break;
+                }
+                batch.push_back(next);
+            }
+            arenaDraw(primitive->arena, batch.data(), batch.size());
         }
     }
 #ifndef __EMSCRIPTEN__
@@ -814,6 +1185,22 @@ void gpu::Node::render(ShaderProgram *shaderProgram) {
 #endif
 }
 
+void gpu::Node::record(CommandBuffer &buffer) {
+    if (parent() == nullptr && !valid()) {
+        invalidateRecursive(this);
+    }
+    for (gpu::Node *child : children) {
+        child->record(buffer);
+    }
+    if (!hidden && mesh) {
+        const glm::mat4 &m = model();
+        for (auto [primitive, material] : mesh->primitives) {
+            buffer.draws.push_back(
+                {m, this, primitive, _overrideMaterial ? _overrideMaterial : material, wireframe});
+        }
+    }
+}
+
 gpu::Node *gpu::Node::childByName(const char *name) {
     if (strcmp(this->libraryNode->name.c_str(), name) == 0) {
         return this;
@@ -876,25 +1263,29 @@ gpu::Node *gpu::Scene::nodeByName(const char *name) {
 gpu::UniformBuffer *gpu::createUniformBuffer(uint32_t bindingPoint, const char *label,
                                              uint32_t length, void *data) {
     gpu::UniformBuffer *ubo = UBOS.acquire();
-    ubo->id = VERTEXBUFFERS.acquire();
+    ubo->id = length ? VERTEXBUFFERS.acquire() : nullptr;
     ubo->bindingPoint = bindingPoint;
     ubo->label = label;
-    ubo->bind();
-    ubo->bufferData(length, data);
-    ubo->unbind();
+    if (ubo->id) {
+        ubo->bind();
+        ubo->bufferData(length, data);
+        ubo->unbind();
+    }
     return ubo;
 }
 
 void gpu::freeUniformBuffer(gpu::UniformBuffer *ubo) {
-    ubo->bind();
-    glBufferData(GL_UNIFORM_BUFFER, 0, NULL, GL_STATIC_DRAW);
-    ubo->unbind();
-    VERTEXBUFFERS.free(ubo->id);
+    if (ubo->id) {
+        ubo->bind();
+        glBufferData(GL_UNIFORM_BUFFER, 0, NULL, GL_STATIC_DRAW);
+        ubo->unbind();
+        VERTEXBUFFERS.free(ubo->id);
+    }
     ubo->bindingPoint = 0;
     UBOS.free(ubo);
 }
 
-void gpu::UniformBuffer::bind() { glBindBuffer(GL_UNIFORM_BUFFER, *id); }
+void gpu::UniformBuffer::bind() { glBindBuffer(GL_UNIFORM_BUFFER, id ? *id : 0); }
 
 void gpu::UniformBuffer::unbind() { glBindBuffer(GL_UNIFORM_BUFFER, 0); }
 
@@ -904,15 +1295,22 @@ void gpu::UniformBuffer::bindBlock(gpu::ShaderProgram *shader, const char *block
 }
 
 void gpu::UniformBuffer::bindBufferBase() {
-    glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, *id);
+    // bufferless blocks are bound by the uniform stream
+    if (id) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, *id);
+    }
 }
 
 void gpu::UniformBuffer::bufferData(uint32_t length_, void *data_) {
     glBufferData(GL_UNIFORM_BUFFER, length_, data_, GL_DYNAMIC_DRAW);
+    if (data_) {
+        Stats_bufferUpload(length_);
+    }
 }
 
 void gpu::UniformBuffer::bufferSubData(uint32_t offset, uint32_t length, void *data) {
     glBufferSubData(GL_UNIFORM_BUFFER, offset, length, data);
+    Stats_bufferUpload(length);
 }
 
 struct SharedSource {
@@ -946,9 +1344,6 @@ const char *getSharedSource(const char *name) {
 
 gpu::Shader *gpu::createShader(uint32_t type, const char *src,
                                const std::unordered_set<std::string> &defines) {
-    gpu::Shader *shader = SHADERS.acquire();
-    shader->id = glCreateShader(type);
-
     bool useShaderExtension{!defines.empty()};
     for (size_t i{0}; i < 100'000 && !useShaderExtension; ++i) {
         if (src[i] == '#') {
@@ -990,15 +1385,33 @@ gpu::Shader *gpu::createShader(uint32_t type, const char *src,
         // printf("\n%s\n", src);
     }
 
+    const uint64_t hash = fnv1a(src, strlen(src), fnv1a(&type, sizeof(type)));
+    for (size_t i{0}; i < SHADERS.count(); ++i) {
+        if (SHADERS[i].hash == hash) {
+            return &SHADERS[i];
+        }
+    }
+    gpu::Shader *shader = SHADERS.acquire();
+    shader->id = glCreateShader(type);
+    shader->hash = hash;
+    if (ProgramCache_enabled()) {
+        shader->source = src;
+        return shader;
+    }
     if (!Shader_compile(*shader, src)) {
         glDeleteShader(shader->id);
+        shader->hash = 0;
         SHADERS.free(shader);
         return nullptr;
     }
     return shader;
 }
 
-void gpu::freeShader(gpu::Shader *shader) { SHADERS.free(shader); }
+void gpu::freeShader(gpu::Shader *shader) {
+    shader->hash = 0;
+    shader->source.clear();
+    SHADERS.free(shader);
+}
 
 gpu::ShaderProgram *gpu::createShaderProgram(gpu::Shader *vertex, gpu::Shader *fragment,
                                              std::unordered_map<std::string, Uniform> &&uniforms) {
@@ -1115,5 +1528,6 @@ void gpu::renderScreen() {
         glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
     }
     vao->bind();
+    Stats_draw(GL_TRIANGLES, 6);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, NULL);
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#ifdef BYTESIZED_USE_SKINNING
+
+#include "gpu_animbake.h"
+
+#include "gpu.h"
+#include "logging.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// a texture of at least this size is guaranteed by GLES 3.0 and WebGL 2
+constexpr uint32_t MAX_BAKE_SIZE{2048};
+
+int32_t gpu::AnimationBake::findClip(const char *name) const {
+    for (size_t i{0}; i < clips.size(); ++i) {
+        if (clips[i].name.compare(name) == 0) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
+static void _bakeFrame(gpu::Node *node, glm::mat4 *bones, uint32_t boneCount) {
+    node->recursive([](gpu::Node *n) { n->invalidate(); });
+    const glm::mat4 globalWorldInverse = glm::inverse(node->model());
+    for (uint32_t j{0}; j < boneCount; ++j) {
+        bones[j] = globalWorldInverse * node->skin->joints[j]->model() *
+                   node->skin->librarySkin->inverseBindMatrices.at(j);
+    }
+}
+
+static uint32_t _intervals(const gpu::Animation *animation, float frameRate) {
+    // whole frames over the clip, so that the last frame lands on endTime
+    const float duration = animation->endTime - animation->startTime;
+    return std::max(1u, static_cast<uint32_t>(std::ceil(duration * frameRate)));
+}
+
+bool gpu::bakeAnimations(AnimationBake &bake, Node *node, float frameRate) {
+    Skin *skin = node->skin;
+    assert(skin);
+    bake.clips.clear();
+    bake.palettes.clear();
+    bake.meshes.clear();
+    uint32_t frames{0};
+    for (const Animation *animation : skin->animations) {
+        frames += _intervals(animation, frameRate) + 1;
+    }
+    if (frames > MAX_BAKE_SIZE) {
+        LOG_ERROR("Animation bake has %u frames, textures only hold %u", frames, MAX_BAKE_SIZE);
+        return false;
+    }
+    bake.node = node;
+    bake.boneCount = std::min<uint32_t>(skin->joints.size(), MAX_BONES);
+    bake.palettes.resize(static_cast<size_t>(frames) * bake.boneCount);
+
+    Pose restPose;
+    Pose_read(restPose, skin->poseNodes);
+    uint32_t frame{0};
+    for (Animation *animation : skin->animations) {
+        const float duration = animation->endTime - animation->startTime;
+        const uint32_t intervals = _intervals(animation, frameRate);
+        bake.clips.push_back({animation->name, frame, intervals + 1,
+                              duration > 0.0f ? intervals / duration : frameRate,
+                              animation->looping});
+        for (uint32_t i{0}; i <= intervals; ++i) {
+            animation->sample(animation->startTime + duration * i / intervals);
+            _bakeFrame(node, &bake.palettes[static_cast<size_t>(frame + i) * bake.boneCount],
+                       bake.boneCount);
+        }
+        frame += intervals + 1;
+    }
+    Pose_write(restPose, skin->poseNodes);
+    node->recursive([](Node *n) { n->invalidate(); });
+    const glm::mat4 rootInverse = glm::inverse(node->model());
+    node->recursive([&bake, &rootInverse](Node *n) {
+        if (n->mesh && !n->mesh->primitives.empty()) {
+            bake.meshes.push_back({n->mesh, rootInverse * n->model()});
+        }
+    });
+    return true;
+}
+
+void gpu::uploadAnimationBake(AnimationBake &bake) {
+    if (bake.texture) {
+        freeTexture(bake.texture);
+    }
+    const uint32_t frames = static_cast<uint32_t>(bake.palettes.size() / bake.boneCount);
+    bake.texture = createTexture(reinterpret_cast<const uint8_t *>(bake.palettes.data()),
+                                 bake.boneCount * 4, frames, ChannelSetting::RGBA, GL_FLOAT);
+}
+
+void gpu::freeAnimationBake(AnimationBake &bake) {
+    if (bake.texture) {
+        freeTexture(bake.texture);
+    }
+    bake = {};
+}
+
+#endif
@@ -0,0 +1,174 @@
+#include "gpu_animcompress.h"
+
+#ifdef BYTESIZED_USE_SKINNING
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static constexpr float QUANTIZED_MAX{65535.0f};
+// 15 bits per component, the remaining two of the 48 tell which component was dropped
+static constexpr float SMALLEST_MAX{32767.0f};
+static constexpr float SMALLEST_RANGE{0.70710678f};
+
+static glm::quat _quat(const glm::vec4 &v) { return {v.w, v.x, v.y, v.z}; }
+
+static glm::vec4 _interpolate(const gpu::Track &track, const glm::vec4 &a, const glm::vec4 &b,
+                              float t) {
+    if (track.interpolation == library::Sampler::STEP) {
+        return a;
+    }
+    if (track.type == gpu::Animation::CH_ROTATION) {
+        const glm::quat q = glm::slerp(_quat(a), _quat(b), t);
+        return {q.x, q.y, q.z, q.w};
+    }
+    return glm::mix(a, b, t);
+}
+
+static float _error(const gpu::Track &track, const glm::vec4 &a, const glm::vec4 &b) {
+    if (track.type == gpu::Animation::CH_ROTATION) {
+        // angle of the rotation from one to the other
+        const float d = std::min(std::abs(glm::dot(_quat(a), _quat(b))), 1.0f);
+        return 2.0f * std::acos(d);
+    }
+    return glm::length(glm::vec3{a} - glm::vec3{b});
+}
+
+static float _tolerance(const gpu::Track &track, const gpu::AnimationCompression &settings) {
+    switch (track.type) {
+    case gpu::Animation::CH_ROTATION:
+        return settings.rotationError;
+    case gpu::Animation::CH_SCALE:
+        return settings.scaleError;
+    default:
+        return settings.translationError;
+    }
+}
+
+// a key is dropped when interpolating from the last kept key to the key after it reproduces
+// every key in between
+static void _reduceKeys(const gpu::Animation &animation, const gpu::Track &track, float tolerance,
+                        std::vector<uint32_t> &kept) {
+    const float *times = animation.times.data() + track.first;
+    const glm::vec4 *values = animation.values.data() + track.first;
+    kept.assign(1, 0);
+    bool constant{true};
+    for (uint32_t i{1}; i < track.count && constant; ++i) {
+        constant = _error(track, values[0], values[i]) <= tolerance;
+    }
+    if (constant) {
+        return;
+    }
+    for (uint32_t i{1}; i + 1 < track.count; ++i) {
+        const uint32_t from = kept.back();
+        const float span = times[i + 1] - times[from];
+        bool needed{false};
+        for (uint32_t j{from + 1}; j <= i && !needed; ++j) {
+            const glm::vec4 value =
+                _interpolate(track, values[from], values[i + 1], (times[j] - times[from]) / span);
+            needed = _error(track, value, values[j]) > tolerance;
+        }
+        if (needed) {
+            kept.push_back(i);
+        }
+    }
+    kept.push_back(track.count - 1);
+}
+
+void gpu::compressAnimation(Animation &animation, const AnimationCompression &settings) {
+    if (!animation.packed.empty()) {
+        return;
+    }
+    std::vector<float> times;
+    std::vector<uint16_t> packed;
+    std::vector<uint32_t> kept;
+    times.reserve(animation.times.size());
+    packed.reserve(animation.values.size() * 3);
+    for (Track &track : animation.tracks) {
+        _reduceKeys(animation, track, _tolerance(track, settings), kept);
+        const float *trackTimes = animation.times.data() + track.first;
+        const glm::vec4 *values = animation.values.data() + track.first;
+        if (track.type != Animation::CH_ROTATION) {
+            glm::vec3 lo{FLT_MAX};
+            glm::vec3 hi{-FLT_MAX};
+            for (uint32_t k : kept) {
+                lo = glm::min(lo, glm::vec3{values[k]});
+                hi = glm::max(hi, glm::vec3{values[k]});
+            }
+            track.min = lo;
+            track.extent = hi - lo;
+        }
+        track.first = static_cast<uint32_t>(times.size());
+        track.count = static_cast<uint32_t>(kept.size());
+        track.cursor = 0;
+        for (uint32_t k : kept) {
+            times.push_back(trackTimes[k]);
+            packed.resize(packed.size() + 3);
+            uint16_t *key = packed.data() + packed.size() - 3;
+            if (track.type == Animation::CH_ROTATION) {
+                packRotation(_quat(values[k]), key);
+                continue;
+            }
+            for (int c{0}; c < 3; ++c) {
+                const float t = track.extent[c] > 0.0f
+                                    ? (values[k][c] - track.min[c]) / track.extent[c]
+                                    : 0.0f;
+                key[c] = static_cast<uint16_t>(std::lround(t * QUANTIZED_MAX));
+            }
+        }
+    }
+    animation.times = std::move(times);
+    animation.packed = std::move(packed);
+    animation.values.clear();
+    animation.values.shrink_to_fit();
+}
+
+void gpu::packRotation(const glm::quat &rotation, uint16_t *packed) {
+    const glm::quat q = glm::normalize(rotation);
+    const float components[4] = {q.x, q.y, q.z, q.w};
+    uint32_t largest{0};
+    for (uint32_t i{1}; i < 4; ++i) {
+        if (std::abs(components[i]) > std::abs(components[largest])) {
+            largest = i;
+        }
+    }
+    // q and -q are the same rotation, flip so that the dropped component is positive
+    const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+    uint64_t bits{largest};
+    for (uint32_t i{0}; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        const float t =
+            std::clamp((components[i] * sign / SMALLEST_RANGE + 1.0f) * 0.5f, 0.0f, 1.0f);
+        bits = (bits << 15) | static_cast<uint64_t>(std::lround(t * SMALLEST_MAX));
+    }
+    packed[0] = static_cast<uint16_t>(bits >> 32);
+    packed[1] = static_cast<uint16_t>(bits >> 16);
+    packed[2] = static_cast<uint16_t>(bits);
+}
+
+glm::vec4 gpu::unpackRotation(const uint16_t *packed) {
+    uint64_t bits = (static_cast<uint64_t>(packed[0]) << 32) |
+                    (static_cast<uint64_t>(packed[1]) << 16) | packed[2];
+    const uint32_t largest = static_cast<uint32_t>(bits >> 45) & 3;
+    float components[4];
+    float sum{0.0f};
+    for (int i{3}; i >= 0; --i) {
+        if (static_cast<uint32_t>(i) == largest) {
+            continue;
+        }
+        components[i] = ((bits & 0x7FFF) / SMALLEST_MAX * 2.0f - 1.0f) * SMALLEST_RANGE;
+        sum += components[i] * components[i];
+        bits >>= 15;
+    }
+    components[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+    return {components[0], components[1], components[2], components[3]};
+}
+
+size_t gpu::animationBytes(const Animation &animation) {
+    return animation.tracks.size() * sizeof(Track) + animation.times.size() * sizeof(float) +
+           animation.values.size() * sizeof(glm::vec4) + animation.packed.size() * sizeof(uint16_t);
+}
+
+#endif
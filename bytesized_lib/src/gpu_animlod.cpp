@@ -0,0 +1,123 @@
+#ifdef BYTESIZED_USE_SKINNING
+
+#include "gpu_animlod.h"
+
+#include "gpu.h"
+#include <algorithm>
+#include <numeric>
+
+static gpu::AnimationLodStats _stats{};
+
+uint8_t gpu::AnimationRate_interval(AnimationRate rate) {
+    static constexpr uint8_t intervals[RATE_COUNT] = {1, 2, 4, 0};
+    return intervals[rate];
+}
+
+static float _cost(gpu::AnimationRate rate) {
+    const uint8_t interval = gpu::AnimationRate_interval(rate);
+    return interval ? 1.0f / interval : 0.0f;
+}
+
+float gpu::animationSignificance(const glm::mat4 &projection, const glm::mat4 &view,
+                                 const glm::vec3 &center, float radius) {
+    const glm::mat4 viewProjection = projection * view;
+    const glm::vec4 c{center, 1.0f};
+    // the planes of the view frustum, rows of the view projection added to and taken from w
+    for (int axis{0}; axis < 3; ++axis) {
+        for (float sign : {1.0f, -1.0f}) {
+            glm::vec4 plane;
+            for (int i{0}; i < 4; ++i) {
+                plane[i] = viewProjection[i][3] + sign * viewProjection[i][axis];
+            }
+            const float length = glm::length(glm::vec3{plane});
+            if (glm::dot(plane, c) < -radius * length) {
+                return 0.0f;
+            }
+        }
+    }
+    const float depth = -(view * c).z;
+    // projection[1][1] is the cotangent of half the vertical field of view
+    return std::min(radius * projection[1][1] / std::max(depth, radius), 1.0f);
+}
+
+void gpu::assignAnimationRates(const float *significance, size_t count,
+                               const AnimationLodSettings &settings, AnimationRate *rates) {
+    static std::vector<uint32_t> order;
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [significance](uint32_t a, uint32_t b) {
+        return significance[a] > significance[b];
+    });
+    float cost{0.0f};
+    for (size_t i{0}; i < count; ++i) {
+        const float s = significance[i];
+        if (s <= 0.0f) {
+            rates[i] = settings.hiddenRate;
+        } else if (s >= settings.everyTick) {
+            rates[i] = RATE_EVERY_TICK;
+        } else if (s >= settings.every2nd) {
+            rates[i] = RATE_EVERY_2ND;
+        } else if (s >= settings.every4th) {
+            rates[i] = RATE_EVERY_4TH;
+        } else {
+            rates[i] = RATE_PAUSED;
+        }
+        cost += _cost(rates[i]);
+    }
+    // the least significant skins give up a rate first, one step per pass
+    for (int pass{0}; pass < RATE_PAUSED && cost > settings.budget; ++pass) {
+        for (size_t i{count}; i-- > 0 && cost > settings.budget;) {
+            AnimationRate &rate = rates[order[i]];
+            if (rate != RATE_PAUSED) {
+                cost -= _cost(rate);
+                rate = static_cast<AnimationRate>(rate + 1);
+                cost += _cost(rate);
+            }
+        }
+    }
+}
+
+static float _boundingRadius(gpu::Node *node) {
+    // joints in their current pose, padded for the mesh around them
+    const glm::vec3 center{node->model()[3]};
+    float radius{0.0f};
+    for (gpu::Node *joint : node->skin->joints) {
+        radius = std::max(radius, glm::length(glm::vec3{joint->model()[3]} - center));
+    }
+    return std::max(radius * 1.25f, 0.5f);
+}
+
+void gpu::AnimationLod_update(const glm::mat4 &projection, const glm::mat4 &view,
+                              const std::vector<Node *> &nodes,
+                              const AnimationLodSettings &settings) {
+    static std::vector<Skin *> skins;
+    static std::vector<float> significance;
+    static std::vector<AnimationRate> rates;
+    skins.clear();
+    significance.clear();
+    for (Node *node : nodes) {
+        node->recursive([&projection, &view](Node *n) {
+            if (n->skin == nullptr) {
+                return;
+            }
+            if (n->skin->boundingRadius <= 0.0f) {
+                n->skin->boundingRadius = _boundingRadius(n);
+            }
+            skins.push_back(n->skin);
+            significance.push_back(animationSignificance(
+                projection, view, glm::vec3{n->model()[3]}, n->skin->boundingRadius));
+        });
+    }
+    rates.resize(skins.size());
+    assignAnimationRates(significance.data(), skins.size(), settings, rates.data());
+    _stats = {};
+    for (size_t i{0}; i < skins.size(); ++i) {
+        skins[i]->updateInterval = AnimationRate_interval(rates[i]);
+        ++_stats.skins[rates[i]];
+        _stats.cost += _cost(rates[i]);
+    }
+}
+
+const gpu::AnimationLodStats &gpu::AnimationLod_stats() { return _stats; }
+
+#endif
@@ -0,0 +1,232 @@
+#include "gpu.h"
+
+#include "logging.h"
+#include <vector>
+
+static recycler<gpu::GeometryArena, BYTESIZED_GEOMETRYARENA_COUNT> ARENAS = {};
+
+static uint32_t _componentSize(uint32_t type) {
+    switch (type) {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+uint32_t gpu::VertexFormat::attributeSize(size_t attribute) const {
+    return sizes[attribute] * _componentSize(types[attribute]);
+}
+
+gpu::VertexFormat gpu::VertexFormat_of(const library::Primitive &libraryPrimitive) {
+    VertexFormat format{};
+    for (size_t i{0}; i < library::Primitive::COUNT; ++i) {
+        if (const library::Accessor *accessor = libraryPrimitive.attributes[i]) {
+            assert(accessor->type != library::Accessor::MAT4);
+            format.sizes[i] = accessor->type + 1;
+            format.types[i] = accessor->componentType;
+        }
+    }
+    return format;
+}
+
+static size_t _regionOffset(const gpu::VertexFormat &format, size_t attribute) {
+    size_t offset{0};
+    for (size_t i{0}; i < attribute; ++i) {
+        offset += format.attributeSize(i) * BYTESIZED_GEOMETRYARENA_VERTICES;
+    }
+    return offset;
+}
+
+bool gpu::GeometryArena::fits(uint32_t vertices, uint32_t indices) const {
+    return vertexCount + vertices <= BYTESIZED_GEOMETRYARENA_VERTICES &&
+           indexCount + indices <= BYTESIZED_GEOMETRYARENA_INDICES;
+}
+
+static gpu::GeometryArena *_createArena(const gpu::VertexFormat &format) {
+    if (ARENAS.count() >= ARENAS.size()) {
+        return nullptr;
+    }
+    gpu::GeometryArena *arena = ARENAS.acquire();
+    arena->id = static_cast<uint32_t>(arena - ARENAS.data());
+    arena->format = format;
+    arena->vertexCount = 0;
+    arena->indexCount = 0;
+    arena->primitiveCount = 0;
+    arena->vao = gpu::createVertexArray();
+    arena->vbo = gpu::createVertexBuffer();
+    arena->ebo = gpu::createVertexBuffer();
+    arena->vao->bind();
+    glBindBuffer(GL_ARRAY_BUFFER, *arena->vbo);
+    glBufferData(GL_ARRAY_BUFFER, _regionOffset(format, library::Primitive::COUNT), nullptr,
+                 GL_STATIC_DRAW);
+    for (size_t i{0}; i < library::Primitive::COUNT; ++i) {
+        if (format.sizes[i] == 0) {
+            continue;
+        }
+        glVertexAttribPointer(i, format.sizes[i], format.types[i], GL_FALSE,
+                              format.attributeSize(i), (void *)_regionOffset(format, i));
+        glEnableVertexAttribArray(i);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *arena->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, BYTESIZED_GEOMETRYARENA_INDICES * sizeof(uint32_t),
+                 nullptr, GL_STATIC_DRAW);
+    arena->vao->unbind();
+    LOG_INFO("Geometry arena %zu created", ARENAS.count());
+    return arena;
+}
+
+static void _readIndices(const library::Accessor &accessor, uint32_t offset,
+                         std::vector<uint32_t> &indices) {
+    indices.resize(accessor.count);
+    const void *data = accessor.bufferView->buffer->data + accessor.bufferView->offset;
+    for (size_t i{0}; i < accessor.count; ++i) {
+        switch (accessor.componentType) {
+        case GL_UNSIGNED_BYTE:
+            indices[i] = ((const uint8_t *)data)[i] + offset;
+            break;
+        case GL_UNSIGNED_SHORT:
+            indices[i] = ((const uint16_t *)data)[i] + offset;
+            break;
+        default:
+            indices[i] = ((const uint32_t *)data)[i] + offset;
+            break;
+        }
+    }
+}
+
+bool gpu::arenaAllocate(const library::Primitive &libraryPrimitive, gpu::Primitive &primitive) {
+    const library::Accessor *positions = libraryPrimitive.attributes[library::Primitive::POSITION];
+    if (positions == nullptr || libraryPrimitive.indices == nullptr) {
+        return false;
+    }
+    const uint32_t vertices = positions->count;
+    const uint32_t indices = libraryPrimitive.indices->count;
+    if (vertices > BYTESIZED_GEOMETRYARENA_VERTICES || indices > BYTESIZED_GEOMETRYARENA_INDICES) {
+        // would not fit an empty arena either, keep the slots for primitives that do
+        return false;
+    }
+    const VertexFormat format = VertexFormat_of(libraryPrimitive);
+
+    GeometryArena *arena{nullptr};
+    for (size_t i{0}; i < ARENAS.count(); ++i) {
+        if (ARENAS[i].vao && ARENAS[i].format == format && ARENAS[i].fits(vertices, indices)) {
+            arena = &ARENAS[i];
+            break;
+        }
+    }
+    if (arena == nullptr) {
+        arena = _createArena(format);
+        if (arena == nullptr) {
+            return false;
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, *arena->vbo);
+    for (size_t i{0}; i < library::Primitive::COUNT; ++i) {
+        const library::Accessor *accessor = libraryPrimitive.attributes[i];
+        if (accessor == nullptr) {
+            continue;
+        }
+        const uint32_t size = format.attributeSize(i);
+        glBufferSubData(GL_ARRAY_BUFFER, _regionOffset(format, i) + arena->vertexCount * size,
+                        vertices * size, accessor->bufferView->data());
+        Stats_bufferUpload(vertices * size);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    static std::vector<uint32_t> indexData;
+#ifdef BYTESIZED_USE_BASEVERTEX
+    _readIndices(*libraryPrimitive.indices, 0, indexData);
+#else
+    // no base vertex draws, rebase the indices instead
+    _readIndices(*libraryPrimitive.indices, arena->vertexCount, indexData);
+#endif
+    arena->vao->bind();
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, arena->indexCount * sizeof(uint32_t),
+                    indices * sizeof(uint32_t), indexData.data());
+    Stats_bufferUpload(indices * sizeof(uint32_t));
+    arena->vao->unbind();
+
+    primitive.arena = arena;
+    primitive.vao = nullptr;
+    primitive.ebo = nullptr;
+    primitive.firstIndex = arena->indexCount;
+    primitive.baseVertex = arena->vertexCount;
+    primitive.count = indices;
+    arena->vertexCount += vertices;
+    arena->indexCount += indices;
+    ++arena->primitiveCount;
+    return true;
+}
+
+void gpu::arenaFree(gpu::Primitive &primitive) {
+    GeometryArena *arena = primitive.arena;
+    assert(arena && arena->primitiveCount > 0);
+    primitive.arena = nullptr;
+    if (--arena->primitiveCount == 0) {
+        arena->vertexCount = 0;
+        arena->indexCount = 0;
+    }
+}
+
+void gpu::arenaDraw(GeometryArena *arena, Primitive *const *primitives, size_t count) {
+    arena->vao->bind();
+#ifdef BYTESIZED_USE_MULTIDRAW
+    if (count > 1) {
+        static std::vector<GLsizei> counts;
+        static std::vector<const void *> offsets;
+        static std::vector<GLint> baseVertices;
+        counts.resize(count);
+        offsets.resize(count);
+        baseVertices.resize(count);
+        uint32_t total{0};
+        for (size_t i{0}; i < count; ++i) {
+            counts[i] = primitives[i]->count;
+            offsets[i] = (const void *)(primitives[i]->firstIndex * sizeof(uint32_t));
+            baseVertices[i] = primitives[i]->baseVertex;
+            total += primitives[i]->count;
+        }
+        // one call, but the triangles of every primitive
+        Stats_draw(GL_TRIANGLES, total);
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT,
+                                      (const void *const *)offsets.data(), count,
+                                      baseVertices.data());
+        arena->vao->unbind();
+        return;
+    }
+#endif
+    for (size_t i{0}; i < count; ++i) {
+        const Primitive *primitive = primitives[i];
+        const void *offset = (const void *)(primitive->firstIndex * sizeof(uint32_t));
+        Stats_draw(GL_TRIANGLES, primitive->count);
+#ifdef BYTESIZED_USE_BASEVERTEX
+        glDrawElementsBaseVertex(GL_TRIANGLES, primitive->count, GL_UNSIGNED_INT, offset,
+                                 primitive->baseVertex);
+#else
+        glDrawElements(GL_TRIANGLES, primitive->count, GL_UNSIGNED_INT, offset);
+#endif
+    }
+    arena->vao->unbind();
+}
+
+void gpu::disposeGeometryArenas() {
+    for (size_t i{0}; i < ARENAS.count(); ++i) {
+        ARENAS[i] = {};
+    }
+    ARENAS.clear();
+}
+
+void gpu::printGeometryArenas() {
+    printf("ARENAS: %zu / %zu\n", ARENAS.count(), ARENAS.size());
+    for (size_t i{0}; i < ARENAS.count(); ++i) {
+        const auto &arena = ARENAS[i];
+        printf("  arena %zu: %u primitives, vertices %u / %u, indices %u / %u\n", i,
+               arena.primitiveCount, arena.vertexCount, BYTESIZED_GEOMETRYARENA_VERTICES,
+               arena.indexCount, BYTESIZED_GEOMETRYARENA_INDICES);
+    }
+}
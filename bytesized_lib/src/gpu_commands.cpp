@@ -0,0 +1,76 @@
+#include "gpu_commands.h"
+
+#include "gpu.h"
+#include <algorithm>
+
+static bool _blended(const gpu::DrawCommand &command) {
+    return command.material->color.vec4().a < 1.0f;
+}
+
+// ids rather than addresses, so that the order does not depend on where things were allocated
+static uint32_t _arenaKey(const gpu::DrawCommand &command) {
+    return command.primitive->arena ? command.primitive->arena->id + 1 : 0;
+}
+
+void gpu::mergeCommands(const std::vector<CommandBuffer> &buffers,
+                        std::vector<DrawCommand> &commands) {
+    commands.clear();
+    for (const auto &buffer : buffers) {
+        commands.insert(commands.end(), buffer.draws.begin(), buffer.draws.end());
+    }
+    // blended commands go last in the order they were recorded, sorting them would reorder what
+    // shows through what
+    auto blended = std::stable_partition(commands.begin(), commands.end(),
+                                         [](const DrawCommand &c) { return !_blended(c); });
+    // a node records its primitives together, so equal keys keeping their order also keeps the
+    // arena primitives of a node next to each other
+    std::stable_sort(commands.begin(), blended, [](const DrawCommand &a, const DrawCommand &b) {
+        if (a.material->id != b.material->id) {
+            return a.material->id < b.material->id;
+        }
+        return _arenaKey(a) < _arenaKey(b);
+    });
+}
+
+void gpu::submitCommands(ShaderProgram *shaderProgram, const std::vector<DrawCommand> &commands) {
+    static std::vector<Primitive *> batch;
+    Uniform &modelUniform = shaderProgram->uniforms.at("u_model");
+    const Node *node{nullptr};
+    Material *material{nullptr};
+    bool wireframe{false};
+    for (size_t i{0}; i < commands.size();) {
+        const DrawCommand &command = commands[i];
+        if (command.node != node) {
+            modelUniform << command.model;
+            node = command.node;
+        }
+        if (command.material != material) {
+            bindMaterial(shaderProgram, command.material);
+            material = command.material;
+        }
+#ifndef __EMSCRIPTEN__
+        if (command.wireframe != wireframe) {
+            glPolygonMode(GL_FRONT_AND_BACK, command.wireframe ? GL_LINE : GL_FILL);
+            wireframe = command.wireframe;
+        }
+#endif
+        GeometryArena *arena = command.primitive->arena;
+        if (arena == nullptr) {
+            command.primitive->render();
+            ++i;
+            continue;
+        }
+        batch.clear();
+        for (; i < commands.size() && commands[i].node == node &&
+               commands[i].material == material && commands[i].primitive->arena == arena;
+             ++i) {
+            batch.push_back(commands[i].primitive);
+        }
+        arenaDraw(arena, batch.data(), batch.size());
+    }
+#ifndef __EMSCRIPTEN__
+    if (wireframe) {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    }
+#endif
+}
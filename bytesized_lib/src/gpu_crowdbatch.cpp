@@ -0,0 +1,115 @@
+#ifdef BYTESIZED_USE_SKINNING
+
+#include "gpu.h"
+
+#include <algorithm>
+
+// the instance attributes follow the vertex attributes, see crowd.vert
+constexpr GLuint INSTANCE_LOCATION{7};
+constexpr GLuint INSTANCE_LOCATIONS{6};
+static_assert(library::Primitive::COUNT <= INSTANCE_LOCATION);
+
+static gpu::VertexArray *_vertexArray(const gpu::Primitive *primitive) {
+    return primitive->arena ? primitive->arena->vao : primitive->vao;
+}
+
+// clang-format off
+static const gpu::InstanceAttribute _attributes[] = {
+    {INSTANCE_LOCATION + 0, 4, offsetof(gpu::CrowdInstance, model) + 0 * sizeof(glm::vec4)},
+    {INSTANCE_LOCATION + 1, 4, offsetof(gpu::CrowdInstance, model) + 1 * sizeof(glm::vec4)},
+    {INSTANCE_LOCATION + 2, 4, offsetof(gpu::CrowdInstance, model) + 2 * sizeof(glm::vec4)},
+    {INSTANCE_LOCATION + 3, 4, offsetof(gpu::CrowdInstance, model) + 3 * sizeof(glm::vec4)},
+    {INSTANCE_LOCATION + 4, 4, offsetof(gpu::CrowdInstance, clip)},
+    {INSTANCE_LOCATION + 5, 2, offsetof(gpu::CrowdInstance, timing)},
+};
+// clang-format on
+static_assert(std::size(_attributes) == INSTANCE_LOCATIONS);
+
+// the vertex arrays are shared with regular draws, so the instance attributes are only enabled
+// while drawing
+static void _enableInstances() {
+    for (GLuint location{INSTANCE_LOCATION}; location < INSTANCE_LOCATION + INSTANCE_LOCATIONS;
+         ++location) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+static void _disableInstances() {
+    for (GLuint location{INSTANCE_LOCATION}; location < INSTANCE_LOCATION + INSTANCE_LOCATIONS;
+         ++location) {
+        glVertexAttribDivisor(location, 0);
+        glDisableVertexAttribArray(location);
+    }
+}
+
+void gpu::CrowdBatch::add(AnimationBake *bake, const glm::mat4 &model, uint32_t clip,
+                          float timeOffset, float rate) {
+    const BakedClip &baked = bake->clips.at(clip);
+    _keys.push_back({bake, static_cast<uint32_t>(_added.size())});
+    _added.push_back({model,
+                      glm::vec4{static_cast<float>(baked.firstFrame),
+                                static_cast<float>(baked.frameCount), baked.frameRate,
+                                baked.looping ? 1.0f : 0.0f},
+                      glm::vec2{timeOffset, rate}});
+}
+
+void gpu::CrowdBatch::collect(std::vector<CrowdDraw> &draws) {
+    draws.clear();
+    std::stable_sort(_keys.begin(), _keys.end(),
+                     [](const Key &a, const Key &b) { return a.bake < b.bake; });
+    _sorted.resize(_keys.size());
+    for (size_t i{0}; i < _keys.size(); ++i) {
+        _sorted[i] = _added[_keys[i].index];
+    }
+    for (size_t i{0}; i < _keys.size();) {
+        const size_t first = i;
+        AnimationBake *bake = _keys[i].bake;
+        for (; i < _keys.size() && _keys[i].bake == bake; ++i) {
+        }
+        for (const BakedMesh &mesh : bake->meshes) {
+            for (auto [primitive, material] : mesh.mesh->primitives) {
+                draws.push_back({bake, primitive, material, &mesh.transform,
+                                 static_cast<uint32_t>(first), static_cast<uint32_t>(i - first)});
+            }
+        }
+    }
+}
+
+void gpu::CrowdBatch::draw(ShaderProgram *shaderProgram, float time) {
+    _drawCalls = 0;
+    if (_keys.empty()) {
+        return;
+    }
+    collect(_draws);
+
+    instances.upload(_sorted.data(), _sorted.size(), sizeof(CrowdInstance));
+
+    shaderProgram->use();
+    shaderProgram->uniforms.at("u_time") << time;
+    Uniform &meshUniform = shaderProgram->uniforms.at("u_mesh");
+    const AnimationBake *bake{nullptr};
+    for (const CrowdDraw &crowdDraw : _draws) {
+        if (crowdDraw.bake != bake) {
+            bake = crowdDraw.bake;
+            Texture_bind(ANIMATION_BAKE_UNIT, bake->texture);
+        }
+        meshUniform << *crowdDraw.transform;
+        bindMaterial(shaderProgram, crowdDraw.material);
+        VertexArray *vao = _vertexArray(crowdDraw.primitive);
+        vao->bind();
+        instances.point(_attributes, std::size(_attributes), crowdDraw.first);
+        _enableInstances();
+        crowdDraw.primitive->renderInstanced(crowdDraw.count);
+        vao->bind();
+        _disableInstances();
+        vao->unbind();
+        ++_drawCalls;
+    }
+    Texture_activeUnit(0);
+
+    _keys.clear();
+    _added.clear();
+}
+
+#endif
@@ -0,0 +1,30 @@
+#include "gpu.h"
+
+#include <algorithm>
+
+void gpu::InstanceStream::upload(const void *data, size_t count, size_t stride) {
+    if (buffer == nullptr) {
+        buffer = createVertexBuffer();
+    }
+    // orphan the storage so that the driver need not wait for last frame's draws
+    glBindBuffer(GL_ARRAY_BUFFER, *buffer);
+    _stride = stride;
+    if (count > _capacity) {
+        _capacity = std::max(count, _capacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, _capacity * _stride, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * stride, data);
+    Stats_bufferUpload(count * stride);
+}
+
+void gpu::InstanceStream::point(const InstanceAttribute *attributes, size_t count,
+                                uint32_t first) const {
+    // attribute pointers read the buffer bound to GL_ARRAY_BUFFER
+    glBindBuffer(GL_ARRAY_BUFFER, *buffer);
+    const size_t offset = first * _stride;
+    for (size_t i{0}; i < count; ++i) {
+        glVertexAttribPointer(attributes[i].location, attributes[i].components, GL_FLOAT,
+                              GL_FALSE, static_cast<GLsizei>(_stride),
+                              (void *)(offset + attributes[i].offset));
+    }
+}
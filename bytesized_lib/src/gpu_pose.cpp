@@ -0,0 +1,159 @@
+#ifdef BYTESIZED_USE_SKINNING
+
+#include "gpu_pose.h"
+
+#include "gpu.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+void gpu::Pose::resize(uint32_t count_) {
+    if (count_ == count && !data.empty()) {
+        return;
+    }
+    count = count_;
+    stride = (count + 3) & ~3u;
+    data.assign(static_cast<size_t>(stride) * STREAM_COUNT, 0.0f);
+}
+
+void gpu::Pose::setTranslation(uint32_t joint, const glm::vec3 &t) {
+    stream(TX)[joint] = t.x;
+    stream(TY)[joint] = t.y;
+    stream(TZ)[joint] = t.z;
+}
+
+void gpu::Pose::setRotation(uint32_t joint, const glm::quat &r) {
+    stream(RX)[joint] = r.x;
+    stream(RY)[joint] = r.y;
+    stream(RZ)[joint] = r.z;
+    stream(RW)[joint] = r.w;
+}
+
+void gpu::Pose::setScale(uint32_t joint, const glm::vec3 &s) {
+    stream(SX)[joint] = s.x;
+    stream(SY)[joint] = s.y;
+    stream(SZ)[joint] = s.z;
+}
+
+glm::vec3 gpu::Pose::translation(uint32_t joint) const {
+    return {stream(TX)[joint], stream(TY)[joint], stream(TZ)[joint]};
+}
+
+glm::quat gpu::Pose::rotation(uint32_t joint) const {
+    return {stream(RW)[joint], stream(RX)[joint], stream(RY)[joint], stream(RZ)[joint]};
+}
+
+glm::vec3 gpu::Pose::scale(uint32_t joint) const {
+    return {stream(SX)[joint], stream(SY)[joint], stream(SZ)[joint]};
+}
+
+void gpu::Pose_read(Pose &pose, const std::vector<Node *> &nodes) {
+    pose.resize(static_cast<uint32_t>(nodes.size()));
+    for (uint32_t i{0}; i < pose.count; ++i) {
+        pose.setTranslation(i, nodes[i]->translation.data());
+        pose.setRotation(i, nodes[i]->rotation.data());
+        pose.setScale(i, nodes[i]->scale.data());
+    }
+}
+
+void gpu::Pose_write(const Pose &pose, const std::vector<Node *> &nodes) {
+    assert(nodes.size() <= pose.count);
+    for (uint32_t i{0}; i < nodes.size(); ++i) {
+        nodes[i]->translation.data() = pose.translation(i);
+        nodes[i]->rotation.data() = pose.rotation(i);
+        nodes[i]->scale.data() = pose.scale(i);
+        nodes[i]->invalidate();
+    }
+}
+
+static constexpr gpu::Pose::Stream VECTOR_STREAMS[] = {gpu::Pose::TX, gpu::Pose::TY,
+                                                       gpu::Pose::TZ, gpu::Pose::SX,
+                                                       gpu::Pose::SY, gpu::Pose::SZ};
+
+#if defined(__SSE2__)
+
+void gpu::Pose_blend(Pose &pose, const Pose &other, float weight, const float *mask) {
+    assert(pose.stride == other.stride);
+    float *rx = pose.stream(Pose::RX);
+    float *ry = pose.stream(Pose::RY);
+    float *rz = pose.stream(Pose::RZ);
+    float *rw = pose.stream(Pose::RW);
+    const float *ox = other.stream(Pose::RX);
+    const float *oy = other.stream(Pose::RY);
+    const float *oz = other.stream(Pose::RZ);
+    const float *ow = other.stream(Pose::RW);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    // padding lanes are zero, keep their length away from zero
+    const __m128 minLength = _mm_set1_ps(1e-12f);
+    for (uint32_t j{0}; j < pose.stride; j += 4) {
+        __m128 w = _mm_set1_ps(weight);
+        if (mask) {
+            w = _mm_mul_ps(w, _mm_loadu_ps(mask + j));
+        }
+        for (Pose::Stream s : VECTOR_STREAMS) {
+            float *a = pose.stream(s) + j;
+            const __m128 va = _mm_loadu_ps(a);
+            const __m128 vb = _mm_loadu_ps(other.stream(s) + j);
+            _mm_storeu_ps(a, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), w)));
+        }
+
+        const __m128 ax = _mm_loadu_ps(rx + j);
+        const __m128 ay = _mm_loadu_ps(ry + j);
+        const __m128 az = _mm_loadu_ps(rz + j);
+        const __m128 aw = _mm_loadu_ps(rw + j);
+        __m128 bx = _mm_loadu_ps(ox + j);
+        __m128 by = _mm_loadu_ps(oy + j);
+        __m128 bz = _mm_loadu_ps(oz + j);
+        __m128 bw = _mm_loadu_ps(ow + j);
+        const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                                      _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+        // q and -q are the same rotation, flip other onto the hemisphere of pose
+        const __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), signBit);
+        bx = _mm_xor_ps(bx, flip);
+        by = _mm_xor_ps(by, flip);
+        bz = _mm_xor_ps(bz, flip);
+        bw = _mm_xor_ps(bw, flip);
+        const __m128 x = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), w));
+        const __m128 y = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), w));
+        const __m128 z = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(bz, az), w));
+        const __m128 qw = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(bw, aw), w));
+        const __m128 length = _mm_max_ps(
+            _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                   _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(qw, qw)))),
+            minLength);
+        _mm_storeu_ps(rx + j, _mm_div_ps(x, length));
+        _mm_storeu_ps(ry + j, _mm_div_ps(y, length));
+        _mm_storeu_ps(rz + j, _mm_div_ps(z, length));
+        _mm_storeu_ps(rw + j, _mm_div_ps(qw, length));
+    }
+}
+
+#else
+
+void gpu::Pose_blend(Pose &pose, const Pose &other, float weight, const float *mask) {
+    assert(pose.stride == other.stride);
+    for (uint32_t j{0}; j < pose.count; ++j) {
+        const float w = mask ? weight * mask[j] : weight;
+        for (Pose::Stream s : VECTOR_STREAMS) {
+            float &a = pose.stream(s)[j];
+            a += (other.stream(s)[j] - a) * w;
+        }
+        const glm::quat a = pose.rotation(j);
+        glm::quat b = other.rotation(j);
+        if (glm::dot(a, b) < 0.0f) {
+            b = -b;
+        }
+        const glm::quat q{a.w + (b.w - a.w) * w, a.x + (b.x - a.x) * w, a.y + (b.y - a.y) * w,
+                          a.z + (b.z - a.z) * w};
+        pose.setRotation(j, q * (1.0f / std::max(std::sqrt(glm::dot(q, q)), 1e-6f)));
+    }
+}
+
+#endif
+
+#endif
@@ -110,8 +110,7 @@ void gpu::renderVector(gpu::ShaderProgram *shaderProgram, Vector &vector) {
         glm::scale(glm::translate(glm::mat4(1.0f), vector.O) *
                        glm::mat4(glm::mat3_cast(primer::quaternionFromDirection(vector.Ray))),
                    glm::vec3{1.0f, glm::length(vector.Ray), 1.0f});
-    glActiveTexture(GL_TEXTURE0);
-    builtinMaterial(gpu::WHITE)->textures.at(GL_TEXTURE0)->bind();
+    bindMaterial(shaderProgram, builtinMaterial(gpu::WHITE));
     shaderProgram->uniforms.at("u_model") << model;
     shaderProgram->uniforms.at("u_color") << vector.color.vec4();
     if (vao == nullptr) {
@@ -128,5 +127,8 @@ void gpu::renderVector(gpu::ShaderProgram *shaderProgram, Vector &vector) {
         _setupAttribPosNorUV_Interleaved();
     }
     vao->unbind();
+    Stats_draw(GL_TRIANGLES, 12);
     glDrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_SHORT, NULL);
+    // u_color tints the material, leave it neutral for the draws that follow
+    shaderProgram->uniforms.at("u_color") << Color::white.vec4();
 }
\ No newline at end of file
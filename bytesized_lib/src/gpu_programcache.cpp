@@ -0,0 +1,117 @@
+#include "gpu_programcache.h"
+
+#include "logging.h"
+#include "opengl.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct ProgramBinaryHeader {
+    char magic[4];
+    uint32_t format;
+    uint64_t driver;
+    uint32_t length;
+};
+
+static constexpr char MAGIC[4] = {'B', 'S', 'P', 'B'};
+
+static std::string _dir;
+static uint64_t _driver{0};
+
+#ifndef __EMSCRIPTEN__
+static std::string _path(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", static_cast<unsigned long long>(key));
+    return _dir + name;
+}
+#endif
+
+void gpu::openProgramCache(const char *dir) {
+#ifdef __EMSCRIPTEN__
+    (void)dir;
+#else
+    GLint formats{0};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0) {
+        LOG_INFO("Program binaries not supported, no program cache");
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    if (error) {
+        LOG_WARN("Failed to create program cache: %s", dir);
+        return;
+    }
+    _dir = dir;
+    _driver = fnv1a(nullptr, 0);
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION}) {
+        const char *str = (const char *)glGetString(name);
+        _driver = fnv1a(str, str ? strlen(str) : 0, _driver);
+    }
+    LOG_INFO("Program cache: %s (driver %016llx)", dir, static_cast<unsigned long long>(_driver));
+#endif
+}
+
+bool gpu::ProgramCache_enabled() { return !_dir.empty(); }
+
+bool gpu::ProgramCache_load(uint64_t key, uint32_t program) {
+#ifdef __EMSCRIPTEN__
+    (void)key;
+    (void)program;
+    return false;
+#else
+    if (_dir.empty()) {
+        return false;
+    }
+    FILE *file = fopen(_path(key).c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    ProgramBinaryHeader header;
+    std::vector<uint8_t> binary;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                 memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.driver == _driver;
+    if (valid) {
+        binary.resize(header.length);
+        valid = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+    if (!valid) {
+        return false;
+    }
+    glProgramBinary(program, header.format, binary.data(), header.length);
+    GLint status{GL_FALSE};
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    return status == GL_TRUE;
+#endif
+}
+
+void gpu::ProgramCache_store(uint64_t key, uint32_t program) {
+#ifdef __EMSCRIPTEN__
+    (void)key;
+    (void)program;
+#else
+    if (_dir.empty()) {
+        return;
+    }
+    GLint length{0};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    ProgramBinaryHeader header{{}, 0, _driver, static_cast<uint32_t>(length)};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    std::vector<uint8_t> binary(length);
+    glGetProgramBinary(program, length, nullptr, &header.format, binary.data());
+    FILE *file = fopen(_path(key).c_str(), "wb");
+    if (file == nullptr) {
+        LOG_WARN("Failed to write program cache: %s", _path(key).c_str());
+        return;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(binary.data(), 1, binary.size(), file);
+    fclose(file);
+#endif
+}
@@ -0,0 +1,64 @@
+#include "gpu_resourcecache.h"
+
+#include "gpu_programcache.h"
+
+// the basis of the check, any other than fnv1a's own keeps its collisions apart
+static constexpr uint64_t CHECK_BASIS{0x9e3779b97f4a7c15ull};
+
+static std::unordered_map<const library::Image *, gpu::ContentKey> _imageKeys;
+
+static void _hash(const void *data, size_t length, gpu::ContentKey &key) {
+    key.hash = gpu::fnv1a(data, length, key.hash);
+    key.check = gpu::fnv1a(data, length, key.check);
+}
+
+static gpu::ContentKey _emptyKey() { return {gpu::fnv1a(nullptr, 0), CHECK_BASIS, 0}; }
+
+static void _hashAccessor(const library::Accessor *accessor, gpu::ContentKey &key) {
+    if (accessor == nullptr) {
+        const uint8_t missing{0};
+        _hash(&missing, sizeof(missing), key);
+        return;
+    }
+    _hash(&accessor->componentType, sizeof(accessor->componentType), key);
+    _hash(&accessor->type, sizeof(accessor->type), key);
+    _hash(&accessor->count, sizeof(accessor->count), key);
+    _hash(accessor->bufferView->data(), accessor->bufferView->length, key);
+    key.size += accessor->bufferView->length;
+}
+
+gpu::ContentKey gpu::contentKey(const library::Primitive &primitive) {
+    ContentKey key = _emptyKey();
+    for (const library::Accessor *attribute : primitive.attributes) {
+        _hashAccessor(attribute, key);
+    }
+    _hashAccessor(primitive.indices, key);
+    return key;
+}
+
+gpu::ContentKey gpu::contentKey(const library::Texture &texture) {
+    auto [it, inserted] = _imageKeys.try_emplace(texture.image);
+    if (inserted) {
+        library::Bufferview *view = texture.image->view;
+        it->second = _emptyKey();
+        _hash(view->data(), view->length, it->second);
+        it->second.size = view->length;
+    }
+    return it->second;
+}
+
+gpu::ContentKey gpu::contentKey(const library::Material &material) {
+    ContentKey key = _emptyKey();
+    _hash(&material.baseColor, sizeof(material.baseColor), key);
+    _hash(&material.metallic, sizeof(material.metallic), key);
+    _hash(&material.roughness, sizeof(material.roughness), key);
+    for (const library::Texture *texture : material.textures) {
+        const ContentKey textureKey = texture ? contentKey(*texture) : ContentKey{};
+        _hash(&textureKey.hash, sizeof(textureKey.hash), key);
+        _hash(&textureKey.check, sizeof(textureKey.check), key);
+        key.size += textureKey.size;
+    }
+    return key;
+}
+
+void gpu::forgetImageKeys() { _imageKeys.clear(); }
@@ -1,7 +1,10 @@
 #ifdef BYTESIZED_USE_SKINNING
 
 #include "gpu.h"
+#include "gpu_animcompress.h"
+#include "jobs.h"
 #include "logging.h"
+#include <algorithm>
 
 static recycler<gpu::Skin, BYTESIZED_SKIN_COUNT> SKINS = {};
 static recycler<gpu::Animation, BYTESIZED_ANIMATION_COUNT> ANIMATIONS = {};
@@ -15,78 +18,48 @@ gpu::Animation *gpu::createAnimation(const library::Animation &anim, gpu::Node *
     rval->looping = true;
     for (size_t j{0}; j < 96; ++j) {
         const auto &channel = anim.channels[j];
-        if (channel.type) {
-            float *fp = (float *)channel.sampler->input->data();
-            glm::vec3 *v3p = (glm::vec3 *)channel.sampler->output->data();
-            glm::vec4 *v4p = (glm::vec4 *)channel.sampler->output->data();
-            gpu::Node *targetNode = (gpu::Node *)channel.targetNode->gpuInstance;
-            if (retargetNode) {
-                targetNode = retargetNode->childByName(channel.targetNode->name.c_str());
-                assert(targetNode);
-            }
-            rval->name = anim.name;
-            switch (channel.type) {
-            case library::Channel::TRANSLATION:
-                rval->channels[targetNode][gpu::Animation::CH_TRANSLATION].frames.resize(
-                    channel.sampler->input->count);
-                rval->channels[targetNode][gpu::Animation::CH_TRANSLATION].current =
-                    rval->channels[targetNode][gpu::Animation::CH_TRANSLATION].frames.begin();
-                for (size_t k{0}; k < channel.sampler->input->count; ++k) {
-                    rval->startTime = std::min(rval->startTime, fp[k]);
-                    rval->endTime = std::max(rval->endTime, fp[k]);
-                    rval->channels[targetNode][gpu::Animation::CH_TRANSLATION].frames.at(k).time =
-                        fp[k];
-                    rval->channels[targetNode][gpu::Animation::CH_TRANSLATION].frames.at(k).v3.x =
-                        v3p[k].x;
-                    rval->channels[targetNode][gpu::Animation::CH_TRANSLATION].frames.at(k).v3.y =
-                        v3p[k].y;
-                    rval->channels[targetNode][gpu::Animation::CH_TRANSLATION].frames.at(k).v3.z =
-                        v3p[k].z;
-                }
-                break;
-            case library::Channel::ROTATION:
-                rval->channels[targetNode][gpu::Animation::CH_ROTATION].frames.resize(
-                    channel.sampler->input->count);
-                rval->channels[targetNode][gpu::Animation::CH_ROTATION].current =
-                    rval->channels[targetNode][gpu::Animation::CH_ROTATION].frames.begin();
-                for (size_t k{0}; k < channel.sampler->input->count; ++k) {
-                    rval->startTime = std::min(rval->startTime, fp[k]);
-                    rval->endTime = std::max(rval->endTime, fp[k]);
-                    rval->channels[targetNode][gpu::Animation::CH_ROTATION].frames.at(k).time =
-                        fp[k];
-                    rval->channels[targetNode][gpu::Animation::CH_ROTATION].frames.at(k).q.x =
-                        v4p[k].x;
-                    rval->channels[targetNode][gpu::Animation::CH_ROTATION].frames.at(k).q.y =
-                        v4p[k].y;
-                    rval->channels[targetNode][gpu::Animation::CH_ROTATION].frames.at(k).q.z =
-                        v4p[k].z;
-                    rval->channels[targetNode][gpu::Animation::CH_ROTATION].frames.at(k).q.w =
-                        v4p[k].w;
-                }
-                break;
-            case library::Channel::SCALE:
-                rval->channels[targetNode][gpu::Animation::CH_SCALE].frames.resize(
-                    channel.sampler->input->count);
-                rval->channels[targetNode][gpu::Animation::CH_SCALE].current =
-                    rval->channels[targetNode][gpu::Animation::CH_SCALE].frames.begin();
-                for (size_t k{0}; k < channel.sampler->input->count; ++k) {
-                    rval->startTime = std::min(rval->startTime, fp[k]);
-                    rval->endTime = std::max(rval->endTime, fp[k]);
-                    rval->channels[targetNode][gpu::Animation::CH_SCALE].frames.at(k).time = fp[k];
-                    rval->channels[targetNode][gpu::Animation::CH_SCALE].frames.at(k).v3.x =
-                        v3p[k].x;
-                    rval->channels[targetNode][gpu::Animation::CH_SCALE].frames.at(k).v3.y =
-                        v3p[k].y;
-                    rval->channels[targetNode][gpu::Animation::CH_SCALE].frames.at(k).v3.z =
-                        v3p[k].z;
-                }
-                break;
-            case library::Channel::NONE:
-                LOG_ERROR("Unknown animation channel");
-                break;
+        if (channel.type == library::Channel::NONE) {
+            continue;
+        }
+        gpu::Node *targetNode = (gpu::Node *)channel.targetNode->gpuInstance;
+        if (retargetNode) {
+            targetNode = retargetNode->childByName(channel.targetNode->name.c_str());
+            assert(targetNode);
+        }
+        rval->name = anim.name;
+        uint8_t type;
+        switch (channel.type) {
+        case library::Channel::TRANSLATION:
+            type = gpu::Animation::CH_TRANSLATION;
+            break;
+        case library::Channel::ROTATION:
+            type = gpu::Animation::CH_ROTATION;
+            break;
+        case library::Channel::SCALE:
+            type = gpu::Animation::CH_SCALE;
+            break;
+        default:
+            LOG_ERROR("Unknown animation channel");
+            continue;
+        }
+        const uint32_t count = channel.sampler->input->count;
+        const float *fp = (const float *)channel.sampler->input->data();
+        const glm::vec3 *v3p = (const glm::vec3 *)channel.sampler->output->data();
+        const glm::vec4 *v4p = (const glm::vec4 *)channel.sampler->output->data();
+        rval->tracks.push_back({targetNode, type, static_cast<uint8_t>(channel.sampler->type), 0,
+                                static_cast<uint32_t>(rval->times.size()), count, 0, {}, {}});
+        for (uint32_t k{0}; k < count; ++k) {
+            rval->startTime = std::min(rval->startTime, fp[k]);
+            rval->endTime = std::max(rval->endTime, fp[k]);
+            rval->times.push_back(fp[k]);
+            if (type == gpu::Animation::CH_ROTATION) {
+                rval->values.push_back(v4p[k]);
+            } else {
+                rval->values.emplace_back(v3p[k], 0.0f);
             }
         }
     }
+    compressAnimation(*rval);
     return rval;
 }
 
@@ -101,11 +74,25 @@ void gpu::printSkinningUsages() {
     PRINT_USAGE(SKINS);
     PRINT_USAGE(ANIMATIONS);
     PRINT_USAGE(PLAYBACKS);
+    size_t bytes{0};
+    for (size_t i{0}; i < ANIMATIONS.count(); ++i) {
+        bytes += animationBytes(ANIMATIONS[i]);
+    }
+    printf("animation keys: %.1f KB\n", bytes * 1e-3f);
+    const AnimationLodStats &lod = AnimationLod_stats();
+    printf("animation rates: %u every tick, %u every 2nd, %u every 4th, %u paused, %.2f / %.2f "
+           "samples per tick\n",
+           lod.skins[RATE_EVERY_TICK], lod.skins[RATE_EVERY_2ND], lod.skins[RATE_EVERY_4TH],
+           lod.skins[RATE_PAUSED], lod.cost, BYTESIZED_ANIMATION_BUDGET);
 }
 
 gpu::Skin *gpu::createSkin(const library::Skin &librarySkin) {
+    static uint8_t nextPhase{0};
     gpu::Skin *skin = SKINS.acquire();
     skin->librarySkin = &librarySkin;
+    skin->updateInterval = 1;
+    // spread skins updated every few ticks over those ticks
+    skin->updatePhase = nextPhase++ % 4;
     return skin;
 }
 
@@ -114,6 +101,19 @@ void gpu::freeSkin(gpu::Skin *skin) {
     skin->playback = nullptr;
     skin->joints.clear();
     skin->librarySkin = nullptr;
+    skin->paletteOffset = 0;
+    skin->paletteFrame = 0;
+    skin->poseNodes.clear();
+    skin->pose = {};
+    skin->fadePose = {};
+    skin->heldPose = {};
+    skin->updateInterval = 1;
+    skin->updatePhase = 0;
+    skin->ticksSinceSample = 0;
+    skin->sampled = false;
+    skin->boundingRadius = 0.0f;
+    skin->fromPalette.clear();
+    skin->toPalette.clear();
     SKINS.free(skin);
 }
 
@@ -121,12 +121,26 @@ void gpu::freeAnimation(Animation *animation) {
     animation->startTime = 0;
     animation->endTime = 0;
     animation->name = {};
-    animation->channels.clear();
+    animation->tracks.clear();
+    animation->times.clear();
+    animation->values.clear();
+    animation->packed.clear();
     animation->libraryAnimation = nullptr;
     animation->looping = true;
     ANIMATIONS.free(animation);
 }
 
+void gpu::Skin::addAnimation(gpu::Animation *animation) {
+    for (gpu::Track &track : animation->tracks) {
+        auto it = std::find(poseNodes.begin(), poseNodes.end(), track.node);
+        track.slot = static_cast<uint16_t>(it - poseNodes.begin());
+        if (it == poseNodes.end()) {
+            poseNodes.push_back(track.node);
+        }
+    }
+    animations.push_back(animation);
+}
+
 gpu::Animation *gpu::Skin::findAnimation(const char *name) {
     for (auto anim : animations) {
         if (anim->name.compare(name) == 0) {
@@ -136,18 +150,31 @@ gpu::Animation *gpu::Skin::findAnimation(const char *name) {
     return nullptr;
 }
 
-gpu::Playback *gpu::Skin::playAnimation(const char *name) {
+gpu::Playback *gpu::Skin::playAnimation(const char *name, float fade) {
     gpu::Animation *anim = findAnimation(name);
     if (anim != playback->animation) {
+        if (fade > 0.0f && playback->animation) {
+            if (playback->from || playback->held) {
+                // the blend is held where it is rather than snapping to either of its clips
+                samplePose();
+                heldPose = pose;
+                playback->from = nullptr;
+                playback->held = true;
+            } else {
+                // the current clip keeps playing while it fades out
+                playback->from = playback->animation;
+                playback->fromTime = playback->time;
+            }
+            playback->fade = 0.0f;
+            playback->fadeDuration = fade;
+        } else {
+            playback->from = nullptr;
+            playback->held = false;
+        }
         playback->animation = anim;
         playback->time = playback->animation->startTime;
-        for (auto &channel : anim->channels) {
-            gpu::Channel *ch = &channel.second.at(gpu::Animation::CH_TRANSLATION);
-            ch->current = ch->frames.begin();
-            ch = &channel.second.at(gpu::Animation::CH_ROTATION);
-            ch->current = ch->frames.begin();
-            ch = &channel.second.at(gpu::Animation::CH_SCALE);
-            ch->current = ch->frames.begin();
+        for (gpu::Track &track : anim->tracks) {
+            track.cursor = 0;
         }
     }
     return playback;
@@ -163,6 +190,9 @@ void gpu::Animation::start() {
     playback->animation = this;
     playback->paused = false;
     playback->time = 0.0f;
+    playback->skin = nullptr;
+    playback->from = nullptr;
+    playback->held = false;
 }
 
 void gpu::Animation::stop() {
@@ -179,9 +209,12 @@ void gpu::Animation::stop() {
     }
 }
 
-gpu::Playback *gpu::createPlayback(gpu::Animation *animation) {
+gpu::Playback *gpu::createPlayback(gpu::Animation *animation, gpu::Skin *skin) {
     gpu::Playback *handle = PLAYBACKS.acquire();
     handle->animation = animation;
+    handle->skin = skin;
+    handle->from = nullptr;
+    handle->held = false;
     return handle;
 };
 
@@ -189,85 +222,187 @@ void gpu::freePlayback(gpu::Playback *playback) {
     playback->animation = nullptr;
     playback->paused = false;
     playback->time = 0.0f;
+    playback->skin = nullptr;
+    playback->from = nullptr;
+    playback->fromTime = 0.0f;
+    playback->held = false;
+    playback->fade = 0.0f;
+    playback->fadeDuration = 0.0f;
     PLAYBACKS.free(playback);
 };
 
-static inline gpu::Frame *getFrame(gpu::Channel &channel, float time);
+uint32_t gpu::findKey(const float *times, uint32_t count, float time, uint32_t hint) {
+    if (hint < count && times[hint] <= time) {
+        if (hint + 1 == count || time < times[hint + 1]) {
+            return hint;
+        }
+        if (hint + 2 == count || time < times[hint + 2]) {
+            return hint + 1;
+        }
+    }
+    const float *it = std::upper_bound(times, times + count, time);
+    return it == times ? 0 : static_cast<uint32_t>(it - times - 1);
+}
+
+static glm::vec4 _keyValue(const gpu::Animation &animation, const gpu::Track &track,
+                           uint32_t key) {
+    const uint32_t index = track.first + key;
+    if (animation.packed.empty()) {
+        return animation.values[index];
+    }
+    const uint16_t *packed = animation.packed.data() + index * 3;
+    if (track.type == gpu::Animation::CH_ROTATION) {
+        return gpu::unpackRotation(packed);
+    }
+    const glm::vec3 t{static_cast<float>(packed[0]), static_cast<float>(packed[1]),
+                      static_cast<float>(packed[2])};
+    return {track.min + track.extent * (t / 65535.0f), 0.0f};
+}
+
+glm::vec4 gpu::sampleTrack(const Animation &animation, Track &track, float time) {
+    const float *times = animation.times.data() + track.first;
+    const uint32_t key = findKey(times, track.count, time, track.cursor);
+    track.cursor = key;
+    const glm::vec4 a = _keyValue(animation, track, key);
+    if (key + 1 >= track.count || time <= times[key] ||
+        track.interpolation == library::Sampler::STEP) {
+        return a;
+    }
+    const glm::vec4 b = _keyValue(animation, track, key + 1);
+    const float t = (time - times[key]) / (times[key + 1] - times[key]);
+    if (track.type == Animation::CH_ROTATION) {
+        const glm::quat q =
+            glm::slerp(glm::quat{a.w, a.x, a.y, a.z}, glm::quat{b.w, b.x, b.y, b.z}, t);
+        return {q.x, q.y, q.z, q.w};
+    }
+    return glm::mix(a, b, t);
+}
+
+void gpu::Animation::sample(float time) {
+    for (Track &track : tracks) {
+        const glm::vec4 value = sampleTrack(*this, track, time);
+        switch (track.type) {
+        case CH_TRANSLATION:
+            track.node->translation = glm::vec3{value};
+            break;
+        case CH_ROTATION:
+            track.node->rotation = glm::quat{value.w, value.x, value.y, value.z};
+            break;
+        case CH_SCALE:
+            track.node->scale = glm::vec3{value};
+            break;
+        }
+    }
+}
+
+void gpu::Animation::sample(Pose &pose, float time) {
+    for (Track &track : tracks) {
+        const glm::vec4 value = sampleTrack(*this, track, time);
+        switch (track.type) {
+        case CH_TRANSLATION:
+            pose.setTranslation(track.slot, glm::vec3{value});
+            break;
+        case CH_ROTATION:
+            pose.setRotation(track.slot, glm::quat{value.w, value.x, value.y, value.z});
+            break;
+        case CH_SCALE:
+            pose.setScale(track.slot, glm::vec3{value});
+            break;
+        }
+    }
+}
+
+static void _advance(const gpu::Animation *animation, float &time, float dt) {
+    time += dt;
+    if (time > animation->endTime) {
+        if (animation->looping) {
+            time = animation->startTime + (time - animation->endTime);
+        } else {
+            time = std::min(time, animation->endTime);
+        }
+    }
+}
+
+void gpu::Skin::samplePose(float ahead) {
+    Pose_read(pose, poseNodes);
+    float time = playback->time;
+    _advance(playback->animation, time, ahead);
+    if (playback->from || playback->held) {
+        fadePose = pose;
+        if (playback->from) {
+            float fromTime = playback->fromTime;
+            _advance(playback->from, fromTime, ahead);
+            playback->from->sample(pose, fromTime);
+        } else {
+            pose = heldPose;
+        }
+        playback->animation->sample(fadePose, time);
+        const float t = std::min(playback->fade + ahead / playback->fadeDuration, 1.0f);
+        Pose_blend(pose, fadePose, t * t * (3.0f - 2.0f * t));
+    } else {
+        playback->animation->sample(pose, time);
+    }
+}
+
+void gpu::Skin::commitPose() { Pose_write(pose, poseNodes); }
 
-static constexpr bool _lerpBetweenKeyFrames = true;
 void gpu::animate(float dt) {
+    static uint32_t tick{0};
+    static std::vector<std::pair<Skin *, float>> sampling;
+    ++tick;
+    sampling.clear();
     for (size_t i{0}; i < PLAYBACKS.count(); ++i) {
         auto &playback = PLAYBACKS[i];
         if (auto anim = playback.animation) {
             if (playback.paused) {
                 continue;
             }
-            for (auto &channel : anim->channels) {
-                gpu::Node *node = channel.first;
-                if (auto tframe = getFrame(channel.second.at(gpu::Animation::CH_TRANSLATION),
-                                           playback.time)) {
-                    if (_lerpBetweenKeyFrames) {
-                        node->translation =
-                            glm::mix(node->translation.data(), tframe->v3, 16.0f * dt);
-                    } else {
-                        node->translation = tframe->v3;
-                    }
-                }
-                if (auto rframe =
-                        getFrame(channel.second.at(gpu::Animation::CH_ROTATION), playback.time)) {
-                    if (_lerpBetweenKeyFrames) {
-                        node->rotation = glm::slerp(node->rotation.data(), rframe->q, 16.0f * dt);
-                    } else {
-                        node->rotation = rframe->q;
-                    }
-                }
-                if (auto sframe =
-                        getFrame(channel.second.at(gpu::Animation::CH_SCALE), playback.time)) {
-                    if (_lerpBetweenKeyFrames) {
-                        node->scale = glm::mix(node->scale.data(), sframe->v3, 16.0f * dt);
-                    } else {
-                        node->scale = sframe->v3;
-                    }
-                }
-            }
-            playback.time += dt;
-            if (playback.time > playback.animation->endTime) {
-                if (playback.animation->looping) {
-                    playback.time = playback.animation->startTime +
-                                    (playback.time - playback.animation->endTime);
-                } else {
-                    playback.time = std::min(playback.time, playback.animation->endTime);
+            if (Skin *skin = playback.skin) {
+                const uint8_t interval = skin->updateInterval;
+                if (interval > 0 && (tick + skin->updatePhase) % interval == 0) {
+                    // sampled for the last tick before the next sample, the palette is
+                    // interpolated towards it in between
+                    sampling.emplace_back(skin, (interval - 1) * dt);
+                } else if (skin->ticksSinceSample < UINT8_MAX) {
+                    ++skin->ticksSinceSample;
                 }
+            } else {
+                anim->sample(playback.time);
             }
         }
     }
-}
-
-static inline gpu::Frame *getFrame(gpu::Channel &channel, float time) {
-    if (channel.current == channel.frames.end()) {
-        if (channel.frames.empty()) {
-            return nullptr;
+    // a skin only reads its own nodes and animations, so skins are sampled at once and their
+    // poses written to the nodes afterwards
+    jobs::parallelFor(sampling.size(), 2, [](size_t begin, size_t end) {
+        for (size_t i{begin}; i < end; ++i) {
+            sampling[i].first->samplePose(sampling[i].second);
         }
-        channel.current = channel.frames.begin();
+    });
+    for (auto &entry : sampling) {
+        Skin *skin = entry.first;
+        skin->commitPose();
+        skin->sampled = true;
+        skin->ticksSinceSample = 0;
     }
-    while (channel.current->time < time) {
-        if (channel.current == (channel.frames.end() - 1)) {
-            break;
-        }
-        ++channel.current;
-    }
-    if (channel.current == (channel.frames.end() - 1)) {
-        float d1 = time - channel.frames.begin()->time;
-        float d2 = time - channel.current->time;
-        // check if we wrapped
-        if (glm::abs(d1) < glm::abs(d2)) {
-            channel.current = channel.frames.begin();
+    for (size_t i{0}; i < PLAYBACKS.count(); ++i) {
+        auto &playback = PLAYBACKS[i];
+        if (auto anim = playback.animation) {
+            if (playback.paused) {
+                continue;
+            }
+            _advance(anim, playback.time, dt);
+            if (playback.from || playback.held) {
+                if (playback.from) {
+                    _advance(playback.from, playback.fromTime, dt);
+                }
+                playback.fade += dt / playback.fadeDuration;
+                if (playback.fade >= 1.0f) {
+                    playback.from = nullptr;
+                    playback.held = false;
+                }
+            }
         }
     }
-    if (channel.current != channel.frames.end()) {
-        return &(*channel.current);
-    }
-    return nullptr;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "gpu.h"
+
+#include <algorithm>
+
+// clang-format off
+static const float _quadCorners[] = {
+    -0.5f, -0.5f,
+    +0.5f, -0.5f,
+    -0.5f, +0.5f,
+    +0.5f, +0.5f,
+};
+// clang-format on
+
+static void _create(gpu::SpriteBatch &batch) {
+    batch.vao = gpu::createVertexArray();
+    batch.quad = gpu::createVertexBuffer();
+    batch.vao->bind();
+    glBindBuffer(GL_ARRAY_BUFFER, *batch.quad);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(_quadCorners), _quadCorners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    for (GLuint location{1}; location <= 4; ++location) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    batch.vao->unbind();
+}
+
+static const gpu::InstanceAttribute _attributes[] = {
+    {1, 4, offsetof(gpu::SpriteInstance, axes)},
+    {2, 4, offsetof(gpu::SpriteInstance, region)},
+    {3, 4, offsetof(gpu::SpriteInstance, tint)},
+    {4, 3, offsetof(gpu::SpriteInstance, translation)},
+};
+
+void gpu::SpriteBatch::add(Texture *texture, int32_t layer, const glm::mat4 &model,
+                           const glm::vec4 &region, const glm::vec4 &tint) {
+    _keys.push_back({layer, texture, static_cast<uint32_t>(_added.size())});
+    _added.push_back({glm::vec4{model[0].x, model[0].y, model[1].x, model[1].y}, region, tint,
+                      glm::vec3{model[3]}});
+}
+
+void gpu::SpriteBatch::draw(ShaderProgram *shaderProgram) {
+    if (vao == nullptr) {
+        _create(*this);
+    }
+    _drawCalls = 0;
+    if (_keys.empty()) {
+        return;
+    }
+    // sprites within a layer keep the order they were added in, overlapping sprites blend in it
+    std::stable_sort(_keys.begin(), _keys.end(),
+                     [](const Key &a, const Key &b) { return a.layer < b.layer; });
+    _sorted.resize(_keys.size());
+    for (size_t i{0}; i < _keys.size(); ++i) {
+        _sorted[i] = _added[_keys[i].index];
+    }
+
+    instances.upload(_sorted.data(), _sorted.size(), sizeof(SpriteInstance));
+
+    shaderProgram->use();
+    vao->bind();
+    gpu::Texture_activeUnit(0);
+    for (size_t i{0}; i < _keys.size();) {
+        const size_t first = i;
+        Texture *texture = _keys[i].texture;
+        // adjacent sprites of a texture draw together, a run may carry on into the next layer
+        for (; i < _keys.size() && _keys[i].texture == texture; ++i) {
+        }
+        texture->bind();
+        instances.point(_attributes, std::size(_attributes), static_cast<uint32_t>(first));
+        Stats_draw(GL_TRIANGLE_STRIP, 4, static_cast<uint32_t>(i - first));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(i - first));
+        ++_drawCalls;
+    }
+    vao->unbind();
+
+    _keys.clear();
+    _added.clear();
+}
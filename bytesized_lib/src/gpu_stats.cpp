@@ -0,0 +1,219 @@
+#include "gpu_stats.h"
+
+#include "logging.h"
+#include "opengl.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+static const char *_stateChangeNames[] = {"program", "texture", "vertex_array", "framebuffer"};
+static_assert(sizeof(_stateChangeNames) / sizeof(_stateChangeNames[0]) ==
+              static_cast<size_t>(gpu::StateChange::COUNT));
+
+static gpu::FrameStats _current{};
+static gpu::FrameStats _last{};
+static std::vector<gpu::PoolUsage> _pools;
+static std::chrono::steady_clock::time_point _start;
+static gpu::RenderBudget _budget{};
+static uint32_t _framesOverBudget{0};
+static bool _wasOverBudget{false};
+static FILE *_capture{nullptr};
+static bool _captureJson{false};
+static uint64_t _capturedFrames{0};
+
+static uint32_t _stateChanges(const gpu::FrameStats &stats) {
+    uint32_t sum{0};
+    for (uint32_t count : stats.stateChanges) {
+        sum += count;
+    }
+    return sum;
+}
+
+static void _writeCsvHeader() {
+    fprintf(_capture, "frame,cpu_ms,draw_calls,triangles");
+    for (const char *name : _stateChangeNames) {
+        fprintf(_capture, ",%s_changes", name);
+    }
+    fprintf(_capture, ",uniform_uploads,buffer_bytes,texture_bytes");
+    for (const auto &pool : _pools) {
+        fprintf(_capture, ",%s_used,%s_high", pool.name, pool.name);
+    }
+    fprintf(_capture, "\n");
+}
+
+static void _writeCsv(const gpu::FrameStats &stats) {
+    fprintf(_capture, "%" PRIu64 ",%.3f,%u,%" PRIu64, stats.frame, stats.cpuMs, stats.drawCalls,
+            stats.triangles);
+    for (uint32_t count : stats.stateChanges) {
+        fprintf(_capture, ",%u", count);
+    }
+    fprintf(_capture, ",%u,%" PRIu64 ",%" PRIu64, stats.uniformUploads, stats.bufferBytes,
+            stats.textureBytes);
+    for (const auto &pool : _pools) {
+        fprintf(_capture, ",%u,%u", pool.used, pool.highWater);
+    }
+    fprintf(_capture, "\n");
+}
+
+static void _writeJson(const gpu::FrameStats &stats) {
+    fprintf(_capture,
+            "%s\n  {\"frame\": %" PRIu64 ", \"cpu_ms\": %.3f, \"draw_calls\": %u, "
+            "\"triangles\": %" PRIu64 ", \"state_changes\": {",
+            _capturedFrames > 0 ? "," : "", stats.frame, stats.cpuMs, stats.drawCalls,
+            stats.triangles);
+    for (size_t i{0}; i < static_cast<size_t>(gpu::StateChange::COUNT); ++i) {
+        fprintf(_capture, "%s\"%s\": %u", i > 0 ? ", " : "", _stateChangeNames[i],
+                stats.stateChanges[i]);
+    }
+    fprintf(_capture,
+            "}, \"uniform_uploads\": %u, \"buffer_bytes\": %" PRIu64
+            ", \"texture_bytes\": %" PRIu64 ", \"pools\": {",
+            stats.uniformUploads, stats.bufferBytes, stats.textureBytes);
+    for (size_t i{0}; i < _pools.size(); ++i) {
+        fprintf(_capture, "%s\"%s\": [%u, %u, %u]", i > 0 ? ", " : "", _pools[i].name,
+                _pools[i].used, _pools[i].highWater, _pools[i].capacity);
+    }
+    fprintf(_capture, "}}");
+}
+
+static bool _overBudget(const char *what, uint64_t value, uint64_t limit, uint64_t frame,
+                        bool report) {
+    if (limit == 0 || value <= limit) {
+        return false;
+    }
+    if (report) {
+        LOG_WARN("Frame %" PRIu64 ": %" PRIu64 " %s, budget is %" PRIu64, frame, value, what,
+                 limit);
+    }
+    return true;
+}
+
+static bool _checkBudget(const gpu::FrameStats &stats, bool report) {
+    // every limit is checked so that all of them get reported
+    return _overBudget("draw calls", stats.drawCalls, _budget.drawCalls, stats.frame, report) |
+           _overBudget("triangles", stats.triangles, _budget.triangles, stats.frame, report) |
+           _overBudget("state changes", _stateChanges(stats), _budget.stateChanges, stats.frame,
+                       report) |
+           _overBudget("buffer bytes", stats.bufferBytes, _budget.bufferBytes, stats.frame,
+                       report) |
+           _overBudget("texture bytes", stats.textureBytes, _budget.textureBytes, stats.frame,
+                       report);
+}
+
+void gpu::Stats_beginFrame() {
+    _current.frame = _last.frame + 1;
+    _start = std::chrono::steady_clock::now();
+}
+
+void gpu::Stats_endFrame() {
+    const std::chrono::duration<float, std::milli> elapsed =
+        std::chrono::steady_clock::now() - _start;
+    _current.cpuMs = elapsed.count();
+    updatePoolUsage(_pools);
+    _last = _current;
+    _current = {};
+
+    // only the first frame of a run over budget is reported
+    const bool over = _checkBudget(_last, !_wasOverBudget);
+    if (over) {
+        ++_framesOverBudget;
+    }
+    _wasOverBudget = over;
+
+    if (_capture) {
+        _captureJson ? _writeJson(_last) : _writeCsv(_last);
+        ++_capturedFrames;
+    }
+}
+
+void gpu::Stats_draw(uint32_t mode, uint32_t count, uint32_t instances) {
+    ++_current.drawCalls;
+    switch (mode) {
+    case GL_TRIANGLES:
+        _current.triangles += static_cast<uint64_t>(count / 3) * instances;
+        break;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+        _current.triangles += static_cast<uint64_t>(count > 2 ? count - 2 : 0) * instances;
+        break;
+    default:
+        break;
+    }
+}
+
+void gpu::Stats_stateChange(StateChange change) {
+    ++_current.stateChanges[static_cast<size_t>(change)];
+}
+
+void gpu::Stats_uniformUpload() { ++_current.uniformUploads; }
+
+void gpu::Stats_bufferUpload(size_t bytes) { _current.bufferBytes += bytes; }
+
+void gpu::Stats_textureUpload(size_t bytes) { _current.textureBytes += bytes; }
+
+const gpu::FrameStats &gpu::Stats_lastFrame() { return _last; }
+
+const std::vector<gpu::PoolUsage> &gpu::Stats_pools() { return _pools; }
+
+void gpu::Stats_setBudget(const RenderBudget &budget) {
+    _budget = budget;
+    _framesOverBudget = 0;
+    _wasOverBudget = false;
+}
+
+uint32_t gpu::Stats_framesOverBudget() { return _framesOverBudget; }
+
+bool gpu::Stats_startCapture(const char *path) {
+    Stats_stopCapture();
+    _capture = fopen(path, "w");
+    if (_capture == nullptr) {
+        LOG_ERROR("Failed to open %s for render stats", path);
+        return false;
+    }
+    const size_t length = strlen(path);
+    _captureJson = length >= 5 && strcmp(path + length - 5, ".json") == 0;
+    _capturedFrames = 0;
+    if (_captureJson) {
+        fprintf(_capture, "[");
+    } else {
+        updatePoolUsage(_pools);
+        _writeCsvHeader();
+    }
+    return true;
+}
+
+void gpu::Stats_stopCapture() {
+    if (_capture == nullptr) {
+        return;
+    }
+    if (_captureJson) {
+        fprintf(_capture, "\n]\n");
+    }
+    fclose(_capture);
+    _capture = nullptr;
+}
+
+void gpu::Stats_print() {
+    printf("\nFrame %" PRIu64 " (%.3f ms):\n", _last.frame, _last.cpuMs);
+    printf("draw calls: %u, triangles: %" PRIu64 "\n", _last.drawCalls, _last.triangles);
+    for (size_t i{0}; i < static_cast<size_t>(StateChange::COUNT); ++i) {
+        printf("%s changes: %u\n", _stateChangeNames[i], _last.stateChanges[i]);
+    }
+    printf("uniform uploads: %u\n", _last.uniformUploads);
+    printf("uploaded: %" PRIu64 " buffer bytes, %" PRIu64 " texture bytes\n", _last.bufferBytes,
+           _last.textureBytes);
+    for (const auto &pool : _pools) {
+        printf("%s: %u / %u (high %u)\n", pool.name, pool.used, pool.capacity, pool.highWater);
+    }
+    if (_framesOverBudget > 0) {
+        printf("%u frames over budget\n", _framesOverBudget);
+    }
+    printf("-------------------------\n\n");
+}
+
+void gpu::Stats_summary(char *buf, size_t size) {
+    snprintf(buf, size, "dc:%u tri:%" PRIu64 "k st:%u up:%" PRIu64 "kB", _last.drawCalls,
+             _last.triangles / 1000, _stateChanges(_last),
+             (_last.bufferBytes + _last.textureBytes) / 1024);
+}
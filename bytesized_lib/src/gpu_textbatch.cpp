@@ -0,0 +1,142 @@
+#include "gpu.h"
+
+#include "logging.h"
+#include <algorithm>
+#include <cstring>
+
+static_assert(BYTESIZED_TEXTBATCH_GLYPHS * 4 <= 65536, "glyph corners are indexed by uint16_t");
+
+uint32_t *gpu::createQuadIndexBuffer(uint32_t quads) {
+    // 2-3
+    // 0-1
+    std::vector<uint16_t> indices(quads * 6);
+    for (uint32_t i{0}; i < quads; ++i) {
+        const uint16_t corner = static_cast<uint16_t>(i * 4);
+        const uint16_t quad[] = {0, 1, 2, 1, 3, 2};
+        for (uint32_t j{0}; j < 6; ++j) {
+            indices[i * 6 + j] = corner + quad[j];
+        }
+    }
+    uint32_t *ebo = gpu::createVertexBuffer();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(),
+                 GL_STATIC_DRAW);
+    return ebo;
+}
+
+static void _create(gpu::TextBatch &batch) {
+    batch.vao = gpu::createVertexArray();
+    batch.vbo = gpu::createVertexBuffer();
+    batch.vao->bind();
+    glBindBuffer(GL_ARRAY_BUFFER, *batch.vbo);
+    glBufferData(GL_ARRAY_BUFFER, BYTESIZED_TEXTBATCH_GLYPHS * 4 * sizeof(gpu::TextVertex),
+                 nullptr, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(gpu::TextVertex),
+                          (void *)offsetof(gpu::TextVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(gpu::TextVertex),
+                          (void *)offsetof(gpu::TextVertex, wave));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(gpu::TextVertex),
+                          (void *)offsetof(gpu::TextVertex, uv));
+    glEnableVertexAttribArray(2);
+
+    batch.ebo = gpu::createQuadIndexBuffer(BYTESIZED_TEXTBATCH_GLYPHS);
+    batch.vao->unbind();
+}
+
+static void _write(const gpu::TextBatch::Entry &entry, gpu::TextVertex *vertices) {
+    const gpu::Text &text = *entry.text;
+    const float w = text.bdfFont->pw;
+    const float h = text.bdfFont->ph;
+    const float u = 1.0f / 16.0f;
+    const float v = 1.0f / 8.0f;
+    const glm::vec3 up{entry.model[1]};
+    for (uint32_t i{0}; i < entry.glyphs; ++i) {
+        const glm::vec4 &glyph = text.glyphs[i];
+        const glm::vec2 corners[] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}};
+        for (uint32_t j{0}; j < 4; ++j) {
+            const float x = glyph.x + corners[j].x * w;
+            const float y = glyph.y + corners[j].y * h;
+            vertices[i * 4 + j] = {glm::vec3{entry.model * glm::vec4{x, y, 0.0f, 1.0f}},
+                                   glm::vec4{up, x},
+                                   {glyph.z + corners[j].x * u, glyph.w + corners[j].y * v}};
+        }
+    }
+}
+
+void gpu::TextBatch::add(Text *text) {
+    _entries.push_back({text, text->version, text->node->model(), 0,
+                        static_cast<uint32_t>(text->glyphs.size())});
+}
+
+void gpu::TextBatch::draw(ShaderProgram *shaderProgram) {
+    if (vao == nullptr) {
+        _create(*this);
+    }
+    // texts sharing an atlas end up next to each other and draw together
+    std::stable_sort(_entries.begin(), _entries.end(), [](const Entry &a, const Entry &b) {
+        return a.text->bdfFont->gpuInstance < b.text->bdfFont->gpuInstance;
+    });
+    uint32_t glyphs{0};
+    for (auto &entry : _entries) {
+        if (glyphs + entry.glyphs > BYTESIZED_TEXTBATCH_GLYPHS) {
+            LOG_WARN("Text batch full, %u glyphs dropped", entry.glyphs);
+            entry.glyphs = 0;
+        }
+        entry.first = glyphs;
+        glyphs += entry.glyphs;
+    }
+    _staging.resize(std::max<size_t>(_staging.size(), glyphs * 4));
+
+    uint32_t dirtyBegin{UINT32_MAX};
+    uint32_t dirtyEnd{0};
+    _uploadedGlyphs = 0;
+    for (size_t i{0}; i < _entries.size(); ++i) {
+        const Entry &entry = _entries[i];
+        if (i < _previous.size()) {
+            const Entry &previous = _previous[i];
+            if (previous.text == entry.text && previous.version == entry.version &&
+                previous.first == entry.first && previous.glyphs == entry.glyphs &&
+                std::memcmp(&previous.model, &entry.model, sizeof(glm::mat4)) == 0) {
+                continue;
+            }
+        }
+        if (entry.glyphs == 0) {
+            continue;
+        }
+        _write(entry, _staging.data() + entry.first * 4);
+        dirtyBegin = std::min(dirtyBegin, entry.first);
+        dirtyEnd = std::max(dirtyEnd, entry.first + entry.glyphs);
+        _uploadedGlyphs += entry.glyphs;
+    }
+    if (dirtyBegin < dirtyEnd) {
+        glBindBuffer(GL_ARRAY_BUFFER, *vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin * 4 * sizeof(TextVertex),
+                        (dirtyEnd - dirtyBegin) * 4 * sizeof(TextVertex),
+                        _staging.data() + dirtyBegin * 4);
+        Stats_bufferUpload((dirtyEnd - dirtyBegin) * 4 * sizeof(TextVertex));
+    }
+
+    shaderProgram->uniforms.at("u_model") << glm::mat4{1.0f};
+    vao->bind();
+    gpu::Texture_activeUnit(0);
+    for (size_t i{0}; i < _entries.size();) {
+        void *atlas = _entries[i].text->bdfFont->gpuInstance;
+        const uint32_t first = _entries[i].first;
+        uint32_t count{0};
+        for (; i < _entries.size() && _entries[i].text->bdfFont->gpuInstance == atlas; ++i) {
+            count += _entries[i].glyphs;
+        }
+        if (count > 0) {
+            static_cast<Texture *>(atlas)->bind();
+            Stats_draw(GL_TRIANGLES, count * 6);
+            glDrawElements(GL_TRIANGLES, count * 6, GL_UNSIGNED_SHORT,
+                           (void *)(first * 6 * sizeof(uint16_t)));
+        }
+    }
+    vao->unbind();
+
+    _previous.swap(_entries);
+    _entries.clear();
+}
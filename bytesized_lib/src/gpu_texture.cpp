@@ -1,11 +1,69 @@
 #include "gpu_texture.h"
 
+#include "bytesized_info.h"
+#include "gpu_stats.h"
+#include "logging.h"
 #include "opengl.h"
+#include "texpack.h"
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <optional>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RG_RGTC2
+#define GL_COMPRESSED_RG_RGTC2 0x8DBD
+#endif
+
+static uint32_t _activeUnit{0};
+static uint32_t _boundTextures[BYTESIZED_TEXTURE_UNITS];
+
+static void _bindTexture(uint32_t id) {
+    if (_activeUnit < BYTESIZED_TEXTURE_UNITS) {
+        if (_boundTextures[_activeUnit] == id) {
+            return;
+        }
+        _boundTextures[_activeUnit] = id;
+    }
+    glBindTexture(GL_TEXTURE_2D, id);
+}
+
+static size_t _pixelSize(GLenum format, uint32_t type) {
+    size_t components;
+    switch (format) {
+    case GL_RED:
+        components = 1;
+        break;
+    case GL_RGB:
+        components = 3;
+        break;
+    case GL_RGBA:
+        components = 4;
+        break;
+    default: // depth and stencil are packed into one component
+        components = 1;
+        break;
+    }
+    switch (type) {
+    case GL_FLOAT:
+    case GL_UNSIGNED_INT:
+    case GL_UNSIGNED_INT_24_8:
+        return components * 4;
+    case GL_HALF_FLOAT:
+        return components * 2;
+    default:
+        return components;
+    }
+}
 
 void gpu::Texture_create(const gpu::Texture &texture, const uint8_t *data, uint32_t width,
                          uint32_t height, ChannelSetting channels, uint32_t type) {
-    glBindTexture(GL_TEXTURE_2D, texture.id);
+    _bindTexture(texture.id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -22,6 +80,9 @@ void gpu::Texture_create(const gpu::Texture &texture, const uint8_t *data, uint3
         break;
     case ChannelSetting::RGBA:
         format = internalFormat = GL_RGBA;
+        if (type == GL_FLOAT) {
+            internalFormat = GL_RGBA32F;
+        }
         break;
     case ChannelSetting::DS:
         internalFormat = GL_DEPTH24_STENCIL8;
@@ -33,9 +94,133 @@ void gpu::Texture_create(const gpu::Texture &texture, const uint8_t *data, uint3
         break;
     }
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    _bindTexture(0);
+    if (data) {
+        Stats_textureUpload(static_cast<size_t>(width) * height * _pixelSize(format, type));
+    }
 }
 
-void gpu::Texture::bind() { glBindTexture(GL_TEXTURE_2D, id); }
+static bool _hasExtension(const char *name) {
+    GLint count{0};
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i{0}; i < count; ++i) {
+        const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool _querySupported(texpack::Format format) {
+    switch (format) {
+    case texpack::RGBA8:
+        return true;
+    case texpack::BC1:
+    case texpack::BC3:
+        return _hasExtension("GL_EXT_texture_compression_s3tc") ||
+               _hasExtension("GL_WEBGL_compressed_texture_s3tc");
+    case texpack::BC5:
+#if defined(__EMSCRIPTEN__) || defined(__ANDROID__)
+        return _hasExtension("GL_EXT_texture_compression_rgtc");
+#else
+        return true;
+#endif
+    case texpack::ETC2_RGB8:
+    case texpack::ETC2_RGBA8:
+#if defined(__EMSCRIPTEN__)
+        return _hasExtension("GL_WEBGL_compressed_texture_etc");
+#elif defined(__ANDROID__)
+        return true;
+#else
+        return _hasExtension("GL_ARB_ES3_compatibility");
+#endif
+    }
+    return false;
+}
+
+static bool _isSupported(texpack::Format format) {
+    // the extensions of a context do not change, each format is looked up once
+    static std::optional<bool> supported[texpack::ETC2_RGBA8 + 1];
+    if (!supported[format]) {
+        supported[format] = _querySupported(format);
+    }
+    return *supported[format];
+}
+
+static GLenum _internalFormat(texpack::Format format) {
+    switch (format) {
+    case texpack::BC1:
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case texpack::BC3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case texpack::BC5:
+        return GL_COMPRESSED_RG_RGTC2;
+    case texpack::ETC2_RGB8:
+        return GL_COMPRESSED_RGB8_ETC2;
+    case texpack::ETC2_RGBA8:
+        return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    case texpack::RGBA8:
+    default:
+        return GL_RGBA8;
+    }
+}
+
+bool gpu::Texture_createPacked(const gpu::Texture &texture, const uint8_t *data, size_t len) {
+    texpack::Header header;
+    const bool valid = texpack::header(data, len, header);
+    const texpack::Format format =
+        valid ? static_cast<texpack::Format>(header.format) : texpack::RGBA8;
+    if (!valid || !_isSupported(format)) {
+        LOG_ERROR("Packed texture format %u not supported", valid ? header.format : 0u);
+        static const uint8_t white[] = {0xFF, 0xFF, 0xFF, 0xFF};
+        Texture_create(texture, white, 1, 1, ChannelSetting::RGBA, GL_UNSIGNED_BYTE);
+        return false;
+    }
+    _bindTexture(texture.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.levels - 1);
+    for (uint32_t i{0}; i < header.levels; ++i) {
+        const GLsizei width = std::max(header.width >> i, 1u);
+        const GLsizei height = std::max(header.height >> i, 1u);
+        if (texpack::isCompressed(format)) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, _internalFormat(format), width, height, 0,
+                                   header.sizes[i], data + header.offsets[i]);
+            Stats_textureUpload(header.sizes[i]);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                         data + header.offsets[i]);
+            Stats_textureUpload(static_cast<size_t>(width) * height * 4);
+        }
+    }
+    _bindTexture(0);
+    return true;
+}
+
+void gpu::Texture::bind() {
+    if (_activeUnit >= BYTESIZED_TEXTURE_UNITS || _boundTextures[_activeUnit] != id) {
+        Stats_stateChange(StateChange::TEXTURE);
+    }
+    _bindTexture(id);
+}
+
+void gpu::Texture::unbind() { _bindTexture(0); }
+
+void gpu::Texture_activeUnit(uint32_t unit) {
+    if (unit != _activeUnit) {
+        _activeUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void gpu::Texture_bind(uint32_t unit, Texture *texture) {
+    Texture_activeUnit(unit);
+    texture->bind();
+}
 
-void gpu::Texture::unbind() { glBindTexture(GL_TEXTURE_2D, 0); }
\ No newline at end of file
+void gpu::Texture_resetBindings() {
+    std::fill(std::begin(_boundTextures), std::end(_boundTextures), 0u);
+}
\ No newline at end of file
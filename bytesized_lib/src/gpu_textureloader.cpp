@@ -0,0 +1,127 @@
+#include "gpu_textureloader.h"
+
+#include "gpu.h"
+#include "jobs.h"
+#include "logging.h"
+#include "opengl.h"
+#include "recycler.hpp"
+#include "stb_image.h"
+#include "texpack.h"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TextureLoad {
+    gpu::Texture *texture; // only touched on the GL thread
+    const uint8_t *addr;
+    uint32_t len;
+    std::string path;
+    bool flip;
+    uint8_t *pixels;
+    const char *failure; // stb keeps the reason per thread, read on the worker
+    int width;
+    int height;
+    int channels;
+};
+
+static recycler<TextureLoad, BYTESIZED_TEXTURELOAD_COUNT> LOADS = {};
+static size_t _inFlight{0};
+static std::mutex _mutex;
+static std::vector<TextureLoad *> _decoded;
+static std::deque<TextureLoad *> _uploading;
+
+static void _decode(TextureLoad *load) {
+    // every decode sets the flip of its own thread, the global setting is never used
+    stbi_set_flip_vertically_on_load_thread(load->flip);
+    if (load->addr) {
+        load->pixels = stbi_load_from_memory(load->addr, load->len, &load->width, &load->height,
+                                             &load->channels, 0);
+    } else {
+        load->pixels =
+            stbi_load(load->path.c_str(), &load->width, &load->height, &load->channels, 0);
+    }
+    if (load->pixels == nullptr) {
+        load->failure = stbi_failure_reason();
+    }
+    std::lock_guard<std::mutex> lock{_mutex};
+    _decoded.push_back(load);
+}
+
+static gpu::Texture *_submit(const uint8_t *addr, uint32_t len, const char *path, bool flip) {
+    if (_inFlight == BYTESIZED_TEXTURELOAD_COUNT) {
+        LOG_WARN("Texture loads full, loading synchronously");
+        return addr ? gpu::createTextureFromMem(addr, len, flip)
+                    : gpu::createTextureFromFile(path, flip);
+    }
+    static const uint8_t placeholder[]{0xFF, 0xFF, 0xFF};
+    TextureLoad *load = LOADS.acquire();
+    ++_inFlight;
+    load->texture =
+        gpu::createTexture(placeholder, 1, 1, gpu::ChannelSetting::RGB, GL_UNSIGNED_BYTE);
+    load->addr = addr;
+    load->len = len;
+    load->path = path ? path : "";
+    load->flip = flip;
+    gpu::Texture *texture = load->texture;
+    jobs::submit([load] { _decode(load); });
+    return texture;
+}
+
+gpu::Texture *gpu::createTextureAsync(const uint8_t *addr, uint32_t len, bool flip) {
+    texpack::Header header;
+    if (texpack::header(addr, len, header)) {
+        return createTextureFromMem(addr, len, flip);
+    }
+    return _submit(addr, len, nullptr, flip);
+}
+
+gpu::Texture *gpu::createTextureFromFileAsync(const char *path, bool flip) {
+    return _submit(nullptr, 0, path, flip);
+}
+
+size_t gpu::TextureLoader_upload(size_t budget) {
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _uploading.insert(_uploading.end(), _decoded.begin(), _decoded.end());
+        _decoded.clear();
+    }
+    size_t uploaded{0};
+    while (!_uploading.empty() && uploaded < budget) {
+        TextureLoad *load = _uploading.front();
+        _uploading.pop_front();
+        if (load->texture && load->pixels) {
+            Texture_create(*load->texture, load->pixels, load->width, load->height,
+                           static_cast<ChannelSetting>(load->channels), GL_UNSIGNED_BYTE);
+            ++uploaded;
+        } else if (load->texture) {
+            LOG_ERROR("Failed to decode texture: %s", load->failure ? load->failure : "unknown");
+        }
+        stbi_image_free(load->pixels);
+        *load = {};
+        LOADS.free(load);
+        --_inFlight;
+    }
+    return _inFlight;
+}
+
+size_t gpu::TextureLoader_pending() { return _inFlight; }
+
+void gpu::TextureLoader_cancel(Texture *texture) {
+    for (size_t i{0}; i < LOADS.count(); ++i) {
+        if (LOADS[i].texture == texture) {
+            LOADS[i].texture = nullptr;
+        }
+    }
+}
+
+void gpu::disposeTextureLoader() {
+    // workers are stopped by now, loads still decoding will never finish
+    for (size_t i{0}; i < LOADS.count(); ++i) {
+        stbi_image_free(LOADS[i].pixels);
+    }
+    LOADS.clear();
+    _decoded.clear();
+    _uploading.clear();
+    _inFlight = 0;
+}
@@ -0,0 +1,109 @@
+#include "gpu.h"
+
+#include "logging.h"
+#include <cstring>
+
+static_assert(BYTESIZED_UIBATCH_QUADS * 4 <= 65536, "quad corners are indexed by uint16_t");
+
+static void _create(gpu::UIBatch &batch) {
+    batch.vao = gpu::createVertexArray();
+    batch.vbo = gpu::createVertexBuffer();
+    batch.vao->bind();
+    glBindBuffer(GL_ARRAY_BUFFER, *batch.vbo);
+    glBufferData(GL_ARRAY_BUFFER, BYTESIZED_UIBATCH_QUADS * 4 * sizeof(gpu::UIVertex), nullptr,
+                 GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(gpu::UIVertex),
+                          (void *)offsetof(gpu::UIVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(gpu::UIVertex),
+                          (void *)offsetof(gpu::UIVertex, color));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(gpu::UIVertex),
+                          (void *)offsetof(gpu::UIVertex, uv));
+    glEnableVertexAttribArray(2);
+    batch.ebo = gpu::createQuadIndexBuffer(BYTESIZED_UIBATCH_QUADS);
+    batch.vao->unbind();
+}
+
+bool gpu::UIBatch::_reserve(Texture *texture, bool text, uint32_t quads) {
+    const uint32_t first = static_cast<uint32_t>(_vertices.size() / 4);
+    if (first + quads > BYTESIZED_UIBATCH_QUADS) {
+        LOG_WARN("UI batch full, %u quads dropped", quads);
+        return false;
+    }
+    if (_runs.empty() || _runs.back().texture != texture || _runs.back().text != text) {
+        _runs.push_back({texture, text, first, 0});
+    }
+    _runs.back().quads += quads;
+    return true;
+}
+
+void gpu::UIBatch::quad(Texture *texture, const glm::vec2 &position, const glm::vec2 &size,
+                        const glm::vec2 &uv, const glm::vec2 &uvSize, const glm::vec4 &color) {
+    if (!_reserve(texture, false, 1)) {
+        return;
+    }
+    // 2-3
+    // 0-1
+    for (int i{0}; i < 4; ++i) {
+        const glm::vec2 corner{static_cast<float>(i & 1), static_cast<float>(i >> 1)};
+        _vertices.push_back({position + corner * size, color, uv + corner * uvSize});
+    }
+}
+
+void gpu::UIBatch::text(Text *text, const glm::vec4 &color) {
+    auto *atlas = static_cast<Texture *>(text->bdfFont->gpuInstance);
+    if (text->glyphs.empty() ||
+        !_reserve(atlas, true, static_cast<uint32_t>(text->glyphs.size()))) {
+        return;
+    }
+    const glm::mat4 &model = text->node->model();
+    const glm::vec2 size{static_cast<float>(text->bdfFont->pw),
+                         static_cast<float>(text->bdfFont->ph)};
+    const glm::vec2 uvSize{1.0f / 16.0f, 1.0f / 8.0f};
+    for (const glm::vec4 &glyph : text->glyphs) {
+        for (int i{0}; i < 4; ++i) {
+            const glm::vec2 corner{static_cast<float>(i & 1), static_cast<float>(i >> 1)};
+            const glm::vec2 local = glm::vec2{glyph.x, glyph.y} + corner * size;
+            _vertices.push_back({glm::vec2{model * glm::vec4{local, 0.0f, 1.0f}}, color,
+                                 glm::vec2{glyph.z, glyph.w} + corner * uvSize});
+        }
+    }
+}
+
+void gpu::UIBatch::draw(ShaderProgram *shaderProgram) {
+    if (vao == nullptr) {
+        _create(*this);
+    }
+    if (_vertices.size() != _uploaded.size() ||
+        std::memcmp(_vertices.data(), _uploaded.data(), _vertices.size() * sizeof(UIVertex)) !=
+            0) {
+        glBindBuffer(GL_ARRAY_BUFFER, *vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, _vertices.size() * sizeof(UIVertex),
+                        _vertices.data());
+        Stats_bufferUpload(_vertices.size() * sizeof(UIVertex));
+        _uploaded = _vertices;
+    }
+
+    const bool depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    Uniform *text = shaderProgram->uniform("u_text");
+    vao->bind();
+    gpu::Texture_activeUnit(0);
+    for (const auto &run : _runs) {
+        run.texture->bind();
+        if (text) {
+            *text << static_cast<int>(run.text);
+        }
+        Stats_draw(GL_TRIANGLES, run.quads * 6);
+        glDrawElements(GL_TRIANGLES, run.quads * 6, GL_UNSIGNED_SHORT,
+                       (void *)(run.first * 6 * sizeof(uint16_t)));
+    }
+    vao->unbind();
+    if (depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+    _drawCalls = static_cast<uint32_t>(_runs.size());
+    _vertices.clear();
+    _runs.clear();
+}
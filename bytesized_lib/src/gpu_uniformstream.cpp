@@ -0,0 +1,188 @@
+#include "gpu_uniformstream.h"
+
+#include "bytesized_info.h"
+#include "gpu.h"
+#include "logging.h"
+#include "opengl.h"
+#include <cstring>
+
+constexpr uint32_t MAX_BINDINGS{16};
+#ifndef __EMSCRIPTEN__
+constexpr GLuint64 FENCE_TIMEOUT{1000000}; // 1 ms
+#endif
+
+struct StickyBlock {
+    const void *data;
+    uint32_t length;
+};
+
+static uint32_t *_buffer{nullptr};
+static uint8_t *_mapped{nullptr};
+static gpu::UniformRing _ring{};
+static uint32_t _bytesWritten{0};
+// the region is fenced at the end of a frame, the next push or frame moves on to a new one
+static bool _fenced{false};
+#ifndef __EMSCRIPTEN__
+static GLsync _fences[BYTESIZED_UNIFORMSTREAM_FRAMES] = {};
+#endif
+static StickyBlock _sticky[MAX_BINDINGS] = {};
+
+uint32_t gpu::UniformRing::alignUp(uint32_t value) const {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool gpu::UniformRing::fits(uint32_t length) const {
+    return offset + alignUp(length) <= regionSize;
+}
+
+uint32_t gpu::UniformRing::take(uint32_t length) {
+    const uint32_t start = region * regionSize + offset;
+    offset += alignUp(length);
+    return start;
+}
+
+uint32_t gpu::UniformRing::next() const { return (region + 1) % BYTESIZED_UNIFORMSTREAM_FRAMES; }
+
+void gpu::UniformRing::enter(uint32_t region) {
+    this->region = region;
+    offset = 0;
+}
+
+static void _write(uint32_t offset, const void *data, uint32_t length) {
+    gpu::Stats_bufferUpload(length);
+    if (_mapped) {
+        std::memcpy(_mapped + offset, data, length);
+        return;
+    }
+#ifdef __EMSCRIPTEN__
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, length, data);
+#else
+    // the fences keep the range out of use by the GPU, the driver does not have to
+    void *dst = glMapBufferRange(GL_UNIFORM_BUFFER, offset, length,
+                                 GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                     GL_MAP_INVALIDATE_RANGE_BIT);
+    std::memcpy(dst, data, length);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+#endif
+}
+
+static uint32_t _push(uint32_t bindingPoint, const void *data, uint32_t length);
+
+static void _enterRegion(uint32_t region) {
+    _ring.enter(region);
+#ifndef __EMSCRIPTEN__
+    // WebGL only takes a zero timeout and signals fences between frames, bufferSubData is
+    // synchronized by the browser instead
+    if (GLsync fence = _fences[region]) {
+        GLenum status;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fence);
+        _fences[region] = nullptr;
+    }
+#endif
+    for (uint32_t i{0}; i < MAX_BINDINGS; ++i) {
+        if (_sticky[i].data) {
+            _push(i, _sticky[i].data, _sticky[i].length);
+        }
+    }
+}
+
+static void _leaveRegion() {
+#ifndef __EMSCRIPTEN__
+    if (_fences[_ring.region]) {
+        glDeleteSync(_fences[_ring.region]);
+    }
+    _fences[_ring.region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+}
+
+static void _openRegion() {
+    if (_fenced) {
+        _fenced = false;
+        _bytesWritten = 0;
+        _enterRegion(_ring.next());
+    }
+}
+
+static uint32_t _push(uint32_t bindingPoint, const void *data, uint32_t length) {
+    assert(_ring.alignUp(length) <= _ring.regionSize);
+    if (!_ring.fits(length)) {
+        LOG_TRACE("Uniform stream region %u full, moving on", _ring.region);
+        _leaveRegion();
+        _enterRegion(_ring.next());
+    }
+    const uint32_t offset = _ring.take(length);
+    _write(offset, data, length);
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, *_buffer, offset, length);
+    _bytesWritten += _ring.alignUp(length);
+    return offset;
+}
+
+void gpu::createUniformStream() {
+    GLint alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    _ring.alignment = alignment > 0 ? alignment : 256;
+    _ring.regionSize = _ring.alignUp(BYTESIZED_UNIFORMSTREAM_SIZE);
+    const uint32_t size = _ring.regionSize * BYTESIZED_UNIFORMSTREAM_FRAMES;
+
+    _buffer = createVertexBuffer();
+    glBindBuffer(GL_UNIFORM_BUFFER, *_buffer);
+#ifdef BYTESIZED_USE_BUFFER_STORAGE
+    if (GLEW_ARB_buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+        _mapped = (uint8_t *)glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags);
+    }
+#endif
+    if (_mapped == nullptr) {
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    }
+    LOG_INFO("Uniform stream: %u x %u bytes, %s", BYTESIZED_UNIFORMSTREAM_FRAMES, _ring.regionSize,
+             _mapped ? "persistent" : "unsynchronized");
+    _enterRegion(0);
+}
+
+void gpu::disposeUniformStream() {
+#ifndef __EMSCRIPTEN__
+    for (auto &fence : _fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+#endif
+    if (_mapped) {
+        glBindBuffer(GL_UNIFORM_BUFFER, *_buffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        _mapped = nullptr;
+    }
+    std::memset(_sticky, 0, sizeof(_sticky));
+    _fenced = false;
+    _buffer = nullptr;
+}
+
+void gpu::UniformStream_beginFrame() {
+    glBindBuffer(GL_UNIFORM_BUFFER, *_buffer);
+    _openRegion();
+}
+
+void gpu::UniformStream_endFrame() {
+    _leaveRegion();
+    _fenced = true;
+}
+
+void gpu::UniformStream_push(uint32_t bindingPoint, const void *data, uint32_t length,
+                             bool sticky) {
+    assert(bindingPoint < MAX_BINDINGS);
+    if (sticky) {
+        _sticky[bindingPoint] = {data, length};
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, *_buffer);
+    // pushed between frames, e.g. on resize, the data goes to the next frame's region
+    _openRegion();
+    _push(bindingPoint, data, length);
+}
+
+uint32_t gpu::UniformStream_bytesWritten() { return _bytesWritten; }
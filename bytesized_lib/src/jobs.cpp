@@ -0,0 +1,132 @@
+#include "jobs.h"
+
+#include "logging.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Batch {
+    const jobs::Task *task;
+    size_t count;
+    size_t grain;
+    std::atomic<size_t> next;
+};
+
+static std::vector<std::thread> _workers;
+static std::mutex _mutex;
+static std::mutex _submitMutex;
+static std::condition_variable _wake;
+static std::condition_variable _idle;
+static Batch *_batch{nullptr};
+static std::deque<jobs::Job> _queue;
+static size_t _generation{0};
+static size_t _busy{0};
+static bool _running{false};
+static thread_local bool _insideWorker{false};
+
+static void _runBatch(Batch &batch) {
+    size_t begin;
+    while ((begin = batch.next.fetch_add(batch.grain)) < batch.count) {
+        (*batch.task)(begin, std::min(begin + batch.grain, batch.count));
+    }
+}
+
+static void _workerLoop() {
+    _insideWorker = true;
+    size_t seen{0};
+    std::unique_lock<std::mutex> lock{_mutex};
+    while (true) {
+        _wake.wait(lock, [&seen] {
+            return !_running || (_batch && _generation != seen) || !_queue.empty();
+        });
+        if (!_running) {
+            break;
+        }
+        if (!_batch || _generation == seen) {
+            // background jobs do not count as busy, parallelFor never waits on them
+            jobs::Job job = std::move(_queue.front());
+            _queue.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+            continue;
+        }
+        seen = _generation;
+        Batch *batch = _batch;
+        ++_busy;
+        lock.unlock();
+        _runBatch(*batch);
+        lock.lock();
+        if (--_busy == 0) {
+            _idle.notify_all();
+        }
+    }
+}
+
+void jobs::start(size_t workerCount) {
+    if (!_workers.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _running = true;
+    }
+    for (size_t i{0}; i < workerCount; ++i) {
+        _workers.emplace_back(_workerLoop);
+    }
+    LOG_INFO("jobs: started %zu workers", workerCount);
+}
+
+void jobs::stop() {
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _running = false;
+    }
+    _wake.notify_all();
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+    _workers.clear();
+    _queue.clear();
+}
+
+size_t jobs::workerCount() { return _workers.size(); }
+
+void jobs::parallelFor(size_t count, size_t grain, const Task &task) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    if (_workers.empty() || _insideWorker || count <= grain) {
+        task(0, count);
+        return;
+    }
+    std::lock_guard<std::mutex> submit{_submitMutex};
+    Batch batch{&task, count, grain, {0}};
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _batch = &batch;
+        ++_generation;
+    }
+    _wake.notify_all();
+    _runBatch(batch);
+    std::unique_lock<std::mutex> lock{_mutex};
+    _batch = nullptr;
+    _idle.wait(lock, [] { return _busy == 0; });
+}
+
+void jobs::submit(Job job) {
+    if (_workers.empty()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _queue.push_back(std::move(job));
+    }
+    _wake.notify_one();
+}
@@ -0,0 +1,345 @@
+#include "occlusion.h"
+
+#include "jobs.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static_assert(occlusion::DEPTH_WIDTH % 4 == 0, "depth rows are processed four pixels at a time");
+
+constexpr int BAND_HEIGHT{8};
+constexpr float NEAR_W{1e-4f};
+
+static constexpr int _levelCount() {
+    int count{1};
+    for (int w{occlusion::DEPTH_WIDTH}, h{occlusion::DEPTH_HEIGHT}; w > 1 || h > 1; ++count) {
+        w = std::max(w >> 1, 1);
+        h = std::max(h >> 1, 1);
+    }
+    return count;
+}
+
+constexpr int LEVEL_COUNT{_levelCount()};
+
+struct ScreenTriangle {
+    float a[3];
+    float b[3];
+    float c[3];
+    float z;
+    float dzdx;
+    float dzdy;
+    int minX;
+    int maxX;
+    int minY;
+    int maxY;
+};
+
+alignas(16) static float _depth[occlusion::DEPTH_WIDTH * occlusion::DEPTH_HEIGHT];
+static std::vector<float> _hiz;
+static int _levelOffsets[LEVEL_COUNT];
+static glm::mat4 _viewProjection{1.0f};
+static std::vector<glm::vec4> _vertices;
+static std::vector<uint32_t> _indices;
+static std::vector<ScreenTriangle> _triangles;
+static std::vector<uint8_t> _triangleValid;
+static occlusion::Stats _stats;
+
+static int _levelWidth(int level) { return std::max(occlusion::DEPTH_WIDTH >> level, 1); }
+static int _levelHeight(int level) { return std::max(occlusion::DEPTH_HEIGHT >> level, 1); }
+
+static float *_level(int level) {
+    return level == 0 ? _depth : _hiz.data() + _levelOffsets[level];
+}
+
+void occlusion::begin(const glm::mat4 &viewProjection) {
+    if (_hiz.empty()) {
+        int offset{0};
+        for (int level{1}; level < LEVEL_COUNT; ++level) {
+            _levelOffsets[level] = offset;
+            offset += _levelWidth(level) * _levelHeight(level);
+        }
+        _hiz.resize(offset);
+    }
+    _viewProjection = viewProjection;
+    _vertices.clear();
+    _indices.clear();
+    _stats = {};
+    std::fill(std::begin(_depth), std::end(_depth), 1.0f);
+}
+
+template <typename T>
+static void _addOccluder(const glm::mat4 &model, const glm::vec3 *positions, size_t positionCount,
+                         const T *indices, size_t indexCount) {
+    const glm::mat4 mvp = _viewProjection * model;
+    const uint32_t base = static_cast<uint32_t>(_vertices.size());
+    for (size_t i{0}; i < positionCount; ++i) {
+        _vertices.push_back(mvp * glm::vec4{positions[i], 1.0f});
+    }
+    for (size_t i{0}; i + 2 < indexCount; i += 3) {
+        if (indices[i] >= positionCount || indices[i + 1] >= positionCount ||
+            indices[i + 2] >= positionCount) {
+            continue;
+        }
+        _indices.push_back(base + indices[i]);
+        _indices.push_back(base + indices[i + 1]);
+        _indices.push_back(base + indices[i + 2]);
+    }
+    ++_stats.occluders;
+}
+
+void occlusion::addOccluder(const glm::mat4 &model, const glm::vec3 *positions,
+                            size_t positionCount, const uint16_t *indices, size_t indexCount) {
+    _addOccluder(model, positions, positionCount, indices, indexCount);
+}
+
+void occlusion::addOccluder(const glm::mat4 &model, const glm::vec3 *positions,
+                            size_t positionCount, const uint32_t *indices, size_t indexCount) {
+    _addOccluder(model, positions, positionCount, indices, indexCount);
+}
+
+void occlusion::addOccluderBox(const glm::mat4 &model, const glm::vec3 &min, const glm::vec3 &max) {
+    const glm::vec3 corners[] = {
+        {min.x, min.y, min.z}, {max.x, min.y, min.z}, {max.x, max.y, min.z},
+        {min.x, max.y, min.z}, {min.x, min.y, max.z}, {max.x, min.y, max.z},
+        {max.x, max.y, max.z}, {min.x, max.y, max.z},
+    };
+    static const uint16_t indices[] = {
+        0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+        3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5,
+    };
+    _addOccluder(model, corners, 8, indices, sizeof(indices) / sizeof(indices[0]));
+}
+
+static glm::vec3 _toScreen(const glm::vec4 &clip) {
+    glm::vec3 ndc = glm::vec3{clip} / clip.w;
+    return {(ndc.x * 0.5f + 0.5f) * occlusion::DEPTH_WIDTH,
+            (ndc.y * 0.5f + 0.5f) * occlusion::DEPTH_HEIGHT, ndc.z * 0.5f + 0.5f};
+}
+
+static bool _setupTriangle(const glm::vec4 &c0, const glm::vec4 &c1, const glm::vec4 &c2,
+                           ScreenTriangle &tri) {
+    // triangles crossing the near plane are dropped, losing occlusion is always safe
+    if (c0.w < NEAR_W || c1.w < NEAR_W || c2.w < NEAR_W) {
+        return false;
+    }
+    glm::vec3 v[3] = {_toScreen(c0), _toScreen(c1), _toScreen(c2)};
+    float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+    if (std::abs(area) < 1e-6f) {
+        return false;
+    }
+    // occluders are rasterized two-sided, only the nearest depth is kept anyway
+    if (area < 0.0f) {
+        std::swap(v[1], v[2]);
+    }
+    const float minX = std::min({v[0].x, v[1].x, v[2].x});
+    const float maxX = std::max({v[0].x, v[1].x, v[2].x});
+    const float minY = std::min({v[0].y, v[1].y, v[2].y});
+    const float maxY = std::max({v[0].y, v[1].y, v[2].y});
+    const float minZ = std::min({v[0].z, v[1].z, v[2].z});
+    if (maxX < 0.0f || minX >= occlusion::DEPTH_WIDTH || maxY < 0.0f ||
+        minY >= occlusion::DEPTH_HEIGHT || minZ > 1.0f) {
+        return false;
+    }
+    tri.minX = std::max(static_cast<int>(minX), 0);
+    tri.maxX = std::min(static_cast<int>(maxX), occlusion::DEPTH_WIDTH - 1);
+    tri.minY = std::max(static_cast<int>(minY), 0);
+    tri.maxY = std::min(static_cast<int>(maxY), occlusion::DEPTH_HEIGHT - 1);
+    for (int i{0}; i < 3; ++i) {
+        // shared edges are always set up from the same end so neighbours get exactly negated
+        // edge functions and no pixel falls through the crack between them
+        const glm::vec3 &p = v[i];
+        const glm::vec3 &q = v[(i + 1) % 3];
+        const bool flip = p.x > q.x || (p.x == q.x && p.y > q.y);
+        const glm::vec3 &from = flip ? q : p;
+        const glm::vec3 &to = flip ? p : q;
+        const float sign = flip ? -1.0f : 1.0f;
+        tri.a[i] = sign * (from.y - to.y);
+        tri.b[i] = sign * (to.x - from.x);
+        tri.c[i] = -sign * ((from.y - to.y) * from.x + (to.x - from.x) * from.y);
+    }
+    const glm::vec3 d1 = v[1] - v[0];
+    const glm::vec3 d2 = v[2] - v[0];
+    const float det = d1.x * d2.y - d2.x * d1.y;
+    tri.dzdx = (d1.z * d2.y - d2.z * d1.y) / det;
+    tri.dzdy = (d1.x * d2.z - d2.x * d1.z) / det;
+    tri.z = v[0].z - tri.dzdx * v[0].x - tri.dzdy * v[0].y;
+    return true;
+}
+
+static void _rasterizeRow(const ScreenTriangle &tri, int y, float *row) {
+    const float py = y + 0.5f;
+    const int x0 = tri.minX & ~3;
+#if defined(__SSE2__)
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 e[3];
+    __m128 step[3];
+    for (int i{0}; i < 3; ++i) {
+        __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x0)), offsets);
+        e[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.a[i]), px),
+                          _mm_set1_ps(tri.b[i] * py + tri.c[i]));
+        step[i] = _mm_set1_ps(tri.a[i] * 4.0f);
+    }
+    __m128 z = _mm_add_ps(
+        _mm_mul_ps(_mm_set1_ps(tri.dzdx), _mm_add_ps(_mm_set1_ps(static_cast<float>(x0)), offsets)),
+        _mm_set1_ps(tri.z + tri.dzdy * py));
+    const __m128 zstep = _mm_set1_ps(tri.dzdx * 4.0f);
+    for (int x{x0}; x <= tri.maxX; x += 4) {
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)),
+                                   _mm_cmpge_ps(e[2], zero));
+        if (_mm_movemask_ps(inside)) {
+            __m128 d = _mm_load_ps(row + x);
+            __m128 nearest = _mm_min_ps(d, z);
+            _mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, d)));
+        }
+        for (int i{0}; i < 3; ++i) {
+            e[i] = _mm_add_ps(e[i], step[i]);
+        }
+        z = _mm_add_ps(z, zstep);
+    }
+#else
+    for (int x{x0}; x <= tri.maxX; x += 4) {
+        for (int lane{0}; lane < 4; ++lane) {
+            const float px = x + lane + 0.5f;
+            const float e0 = tri.a[0] * px + tri.b[0] * py + tri.c[0];
+            const float e1 = tri.a[1] * px + tri.b[1] * py + tri.c[1];
+            const float e2 = tri.a[2] * px + tri.b[2] * py + tri.c[2];
+            if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f) {
+                const float z = tri.z + tri.dzdx * px + tri.dzdy * py;
+                row[x + lane] = std::min(row[x + lane], z);
+            }
+        }
+    }
+#endif
+}
+
+static void _buildHierarchicalDepth() {
+    for (int level{1}; level < LEVEL_COUNT; ++level) {
+        const float *src = _level(level - 1);
+        float *dst = _level(level);
+        const int srcWidth = _levelWidth(level - 1);
+        const int srcHeight = _levelHeight(level - 1);
+        const int width = _levelWidth(level);
+        const int height = _levelHeight(level);
+        for (int y{0}; y < height; ++y) {
+            const int y0 = std::min(y * 2, srcHeight - 1);
+            const int y1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (int x{0}; x < width; ++x) {
+                const int x0 = std::min(x * 2, srcWidth - 1);
+                const int x1 = std::min(x * 2 + 1, srcWidth - 1);
+                dst[y * width + x] =
+                    std::max({src[y0 * srcWidth + x0], src[y0 * srcWidth + x1],
+                              src[y1 * srcWidth + x0], src[y1 * srcWidth + x1]});
+            }
+        }
+    }
+}
+
+void occlusion::rasterize() {
+    const size_t count = _indices.size() / 3;
+    _triangles.resize(count);
+    _triangleValid.resize(count);
+    jobs::parallelFor(count, 64, [](size_t begin, size_t end) {
+        for (size_t i{begin}; i < end; ++i) {
+            _triangleValid[i] =
+                _setupTriangle(_vertices[_indices[i * 3]], _vertices[_indices[i * 3 + 1]],
+                               _vertices[_indices[i * 3 + 2]], _triangles[i]);
+        }
+    });
+    _stats.triangles = count;
+    _stats.rasterized = std::count(_triangleValid.begin(), _triangleValid.end(), 1);
+
+    // every band owns its rows of the depth buffer, no synchronization needed
+    constexpr int bandCount = (DEPTH_HEIGHT + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    jobs::parallelFor(bandCount, 1, [count](size_t begin, size_t end) {
+        for (size_t band{begin}; band < end; ++band) {
+            const int bandMinY = static_cast<int>(band) * BAND_HEIGHT;
+            const int bandMaxY = std::min(bandMinY + BAND_HEIGHT, DEPTH_HEIGHT) - 1;
+            for (size_t i{0}; i < count; ++i) {
+                if (!_triangleValid[i]) {
+                    continue;
+                }
+                const ScreenTriangle &tri = _triangles[i];
+                const int minY = std::max(tri.minY, bandMinY);
+                const int maxY = std::min(tri.maxY, bandMaxY);
+                for (int y{minY}; y <= maxY; ++y) {
+                    _rasterizeRow(tri, y, _depth + y * DEPTH_WIDTH);
+                }
+            }
+        }
+    });
+    _buildHierarchicalDepth();
+}
+
+bool occlusion::isVisible(const glm::mat4 &model, const glm::vec3 &min, const glm::vec3 &max) {
+    const glm::mat4 mvp = _viewProjection * model;
+    glm::vec3 lo{std::numeric_limits<float>::max()};
+    glm::vec3 hi{std::numeric_limits<float>::lowest()};
+    int behind{0};
+    for (int i{0}; i < 8; ++i) {
+        const glm::vec4 clip = mvp * glm::vec4{(i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y,
+                                               (i & 4) ? max.z : min.z, 1.0f};
+        if (clip.w < NEAR_W) {
+            ++behind;
+            continue;
+        }
+        const glm::vec3 screen = _toScreen(clip);
+        lo = glm::min(lo, screen);
+        hi = glm::max(hi, screen);
+    }
+    if (behind > 0) {
+        // boxes crossing the near plane can not be projected, assume visible
+        return behind < 8;
+    }
+    if (hi.x < 0.0f || lo.x >= DEPTH_WIDTH || hi.y < 0.0f || lo.y >= DEPTH_HEIGHT || lo.z > 1.0f) {
+        return false;
+    }
+    const int x0 = std::max(static_cast<int>(lo.x), 0);
+    const int x1 = std::min(static_cast<int>(hi.x), DEPTH_WIDTH - 1);
+    const int y0 = std::max(static_cast<int>(lo.y), 0);
+    const int y1 = std::min(static_cast<int>(hi.y), DEPTH_HEIGHT - 1);
+    int level{0};
+    while (level < LEVEL_COUNT - 1 && ((x1 >> level) - (x0 >> level) > 1 ||
+                                       (y1 >> level) - (y0 >> level) > 1)) {
+        ++level;
+    }
+    const float *hiz = _level(level);
+    const int width = _levelWidth(level);
+    for (int y{y0 >> level}; y <= (y1 >> level); ++y) {
+        for (int x{x0 >> level}; x <= (x1 >> level); ++x) {
+            if (lo.z <= hiz[y * width + x]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool occlusion::isVisible(const glm::vec3 &min, const glm::vec3 &max) {
+    return isVisible(glm::mat4{1.0f}, min, max);
+}
+
+void occlusion::testVisibility(const Bounds *bounds, size_t count, uint8_t *visible) {
+    jobs::parallelFor(count, 32, [bounds, visible](size_t begin, size_t end) {
+        for (size_t i{begin}; i < end; ++i) {
+            visible[i] = isVisible(bounds[i].min, bounds[i].max);
+        }
+    });
+    _stats.tested += count;
+    _stats.culled += std::count(visible, visible + count, 0);
+}
+
+float occlusion::depth(int x, int y) { return _depth[y * DEPTH_WIDTH + x]; }
+
+float occlusion::hierarchicalDepth(int level, int x, int y) {
+    return _level(level)[y * _levelWidth(level) + x];
+}
+
+int occlusion::levels() { return LEVEL_COUNT; }
+
+const occlusion::Stats &occlusion::stats() { return _stats; }
@@ -0,0 +1,274 @@
+#include "picking.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+constexpr uint32_t LEAF_SIZE{4};
+constexpr int STACK_SIZE{64};
+
+struct Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// interior nodes have count 0 and their children at first and first + 1
+struct BVHNode {
+    glm::vec3 min;
+    uint32_t first;
+    glm::vec3 max;
+    uint32_t count;
+};
+
+struct Mesh {
+    std::vector<glm::vec3> triangles; // three corners each, in leaf order
+    std::vector<BVHNode> nodes;
+};
+
+struct Instance {
+    size_t object;
+    uint32_t mesh;
+    glm::mat4 inverse;
+};
+
+static std::vector<Mesh> _meshes;
+static std::vector<Instance> _instances;
+static std::vector<Bounds> _instanceBounds;
+static std::vector<uint32_t> _order;
+static std::vector<BVHNode> _nodes;
+
+// Splits at the median centroid of the longest axis, items are reordered so that every leaf refers
+// to a contiguous range.
+static void _build(std::vector<BVHNode> &nodes, std::vector<uint32_t> &items,
+                   const std::vector<Bounds> &bounds) {
+    nodes.clear();
+    if (items.empty()) {
+        return;
+    }
+    nodes.push_back({{}, 0, {}, static_cast<uint32_t>(items.size())});
+    uint32_t stack[STACK_SIZE];
+    int top{0};
+    stack[top++] = 0;
+    while (top > 0) {
+        const uint32_t index = stack[--top];
+        const uint32_t first = nodes[index].first;
+        const uint32_t count = nodes[index].count;
+        Bounds box{glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX}};
+        Bounds centroids{glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX}};
+        for (uint32_t i{first}; i < first + count; ++i) {
+            const Bounds &b = bounds[items[i]];
+            const glm::vec3 centroid = (b.min + b.max) * 0.5f;
+            box.min = glm::min(box.min, b.min);
+            box.max = glm::max(box.max, b.max);
+            centroids.min = glm::min(centroids.min, centroid);
+            centroids.max = glm::max(centroids.max, centroid);
+        }
+        nodes[index].min = box.min;
+        nodes[index].max = box.max;
+        if (count <= LEAF_SIZE || top + 2 > STACK_SIZE) {
+            continue;
+        }
+        const glm::vec3 extent = centroids.max - centroids.min;
+        const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2)
+                                             : (extent.y > extent.z ? 1 : 2);
+        const uint32_t half = count / 2;
+        std::nth_element(items.begin() + first, items.begin() + first + half,
+                         items.begin() + first + count, [&bounds, axis](uint32_t a, uint32_t b) {
+                             return bounds[a].min[axis] + bounds[a].max[axis] <
+                                    bounds[b].min[axis] + bounds[b].max[axis];
+                         });
+        const uint32_t left = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({{}, first, {}, half});
+        nodes.push_back({{}, first + half, {}, count - half});
+        nodes[index].first = left;
+        nodes[index].count = 0;
+        stack[top++] = left;
+        stack[top++] = left + 1;
+    }
+}
+
+static bool _slab(const BVHNode &node, const glm::vec3 &origin, const glm::vec3 &invDirection,
+                  float tmax, float &tmin) {
+    const glm::vec3 t0 = (node.min - origin) * invDirection;
+    const glm::vec3 t1 = (node.max - origin) * invDirection;
+    const glm::vec3 lo = glm::min(t0, t1);
+    const glm::vec3 hi = glm::max(t0, t1);
+    tmin = std::max(std::max(lo.x, lo.y), std::max(lo.z, 0.0f));
+    return tmin <= std::min(std::min(hi.x, hi.y), std::min(hi.z, tmax));
+}
+
+// Visits the leaves hit by the ray nearest first, leaf shortens tmax when it finds a hit.
+template <typename Leaf>
+static void _traverse(const std::vector<BVHNode> &nodes, const glm::vec3 &origin,
+                      const glm::vec3 &direction, float &tmax, Leaf leaf) {
+    if (nodes.empty()) {
+        return;
+    }
+    const glm::vec3 invDirection = glm::vec3{1.0f} / direction;
+    uint32_t stack[STACK_SIZE];
+    int top{0};
+    float t;
+    if (_slab(nodes[0], origin, invDirection, tmax, t)) {
+        stack[top++] = 0;
+    }
+    while (top > 0) {
+        const BVHNode &node = nodes[stack[--top]];
+        if (node.count > 0) {
+            for (uint32_t i{node.first}; i < node.first + node.count; ++i) {
+                leaf(i, tmax);
+            }
+            continue;
+        }
+        float tl, tr;
+        const bool hitLeft = _slab(nodes[node.first], origin, invDirection, tmax, tl);
+        const bool hitRight = _slab(nodes[node.first + 1], origin, invDirection, tmax, tr);
+        if (hitLeft && hitRight) {
+            stack[top++] = tl < tr ? node.first + 1 : node.first;
+            stack[top++] = tl < tr ? node.first : node.first + 1;
+        } else if (hitLeft || hitRight) {
+            stack[top++] = hitLeft ? node.first : node.first + 1;
+        }
+    }
+}
+
+// Möller-Trumbore, both faces count as a hit
+static bool _triangle(const glm::vec3 &origin, const glm::vec3 &direction, const glm::vec3 *v,
+                      float &t) {
+    const glm::vec3 e1 = v[1] - v[0];
+    const glm::vec3 e2 = v[2] - v[0];
+    const glm::vec3 p = glm::cross(direction, e2);
+    const float det = glm::dot(e1, p);
+    if (std::abs(det) < 1e-12f) {
+        return false;
+    }
+    const float invDet = 1.0f / det;
+    const glm::vec3 s = origin - v[0];
+    const float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    const glm::vec3 q = glm::cross(s, e1);
+    const float w = glm::dot(direction, q) * invDet;
+    if (w < 0.0f || u + w > 1.0f) {
+        return false;
+    }
+    t = glm::dot(e2, q) * invDet;
+    return t > 0.0f;
+}
+
+picking::Ray picking::screenRay(const glm::mat4 &inverseViewProjection, float x, float y,
+                                float width, float height) {
+    const float ndcX = x / width * 2.0f - 1.0f;
+    const float ndcY = 1.0f - y / height * 2.0f;
+    const glm::vec4 near = inverseViewProjection * glm::vec4{ndcX, ndcY, -1.0f, 1.0f};
+    const glm::vec4 far = inverseViewProjection * glm::vec4{ndcX, ndcY, 1.0f, 1.0f};
+    const glm::vec3 origin = glm::vec3{near} / near.w;
+    return {origin, glm::normalize(glm::vec3{far} / far.w - origin)};
+}
+
+template <typename T>
+static uint32_t _createMesh(const glm::vec3 *positions, size_t positionCount, const T *indices,
+                            size_t indexCount) {
+    std::vector<size_t> triangles;
+    std::vector<Bounds> bounds;
+    for (size_t i{0}; i + 2 < indexCount; i += 3) {
+        if (indices[i] >= positionCount || indices[i + 1] >= positionCount ||
+            indices[i + 2] >= positionCount) {
+            continue;
+        }
+        const glm::vec3 &a = positions[indices[i]];
+        const glm::vec3 &b = positions[indices[i + 1]];
+        const glm::vec3 &c = positions[indices[i + 2]];
+        triangles.push_back(i);
+        bounds.push_back({glm::min(glm::min(a, b), c), glm::max(glm::max(a, b), c)});
+    }
+    std::vector<uint32_t> items(triangles.size());
+    for (size_t i{0}; i < items.size(); ++i) {
+        items[i] = static_cast<uint32_t>(i);
+    }
+    Mesh &mesh = _meshes.emplace_back();
+    _build(mesh.nodes, items, bounds);
+    mesh.triangles.reserve(items.size() * 3);
+    for (uint32_t item : items) {
+        for (size_t k{0}; k < 3; ++k) {
+            mesh.triangles.push_back(positions[indices[triangles[item] + k]]);
+        }
+    }
+    return static_cast<uint32_t>(_meshes.size() - 1);
+}
+
+uint32_t picking::createMesh(const glm::vec3 *positions, size_t positionCount,
+                             const uint16_t *indices, size_t indexCount) {
+    return _createMesh(positions, positionCount, indices, indexCount);
+}
+
+uint32_t picking::createMesh(const glm::vec3 *positions, size_t positionCount,
+                             const uint32_t *indices, size_t indexCount) {
+    return _createMesh(positions, positionCount, indices, indexCount);
+}
+
+void picking::begin() {
+    _instances.clear();
+    _instanceBounds.clear();
+}
+
+void picking::addInstance(size_t object, uint32_t mesh, const glm::mat4 &model) {
+    const Mesh &m = _meshes.at(mesh);
+    if (m.nodes.empty()) {
+        return;
+    }
+    const BVHNode &root = m.nodes[0];
+    Bounds world{glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX}};
+    for (int i{0}; i < 8; ++i) {
+        const glm::vec3 corner{model * glm::vec4{(i & 1) ? root.max.x : root.min.x,
+                                                 (i & 2) ? root.max.y : root.min.y,
+                                                 (i & 4) ? root.max.z : root.min.z, 1.0f}};
+        world.min = glm::min(world.min, corner);
+        world.max = glm::max(world.max, corner);
+    }
+    _instances.push_back({object, mesh, glm::inverse(model)});
+    _instanceBounds.push_back(world);
+}
+
+void picking::build() {
+    _order.resize(_instances.size());
+    for (size_t i{0}; i < _order.size(); ++i) {
+        _order[i] = static_cast<uint32_t>(i);
+    }
+    _build(_nodes, _order, _instanceBounds);
+}
+
+bool picking::raycast(const Ray &ray, Hit &hit) {
+    float tmax{FLT_MAX};
+    bool found{false};
+    _traverse(_nodes, ray.origin, ray.direction, tmax, [&](uint32_t i, float &best) {
+        const Instance &instance = _instances[_order[i]];
+        const Mesh &mesh = _meshes[instance.mesh];
+        // the local direction keeps its length so that distances compare across instances
+        const glm::vec3 origin{instance.inverse * glm::vec4{ray.origin, 1.0f}};
+        const glm::vec3 direction{instance.inverse * glm::vec4{ray.direction, 0.0f}};
+        _traverse(mesh.nodes, origin, direction, best, [&](uint32_t j, float &t) {
+            float d;
+            if (_triangle(origin, direction, &mesh.triangles[j * 3], d) && d < t) {
+                t = d;
+                hit.object = instance.object;
+                found = true;
+            }
+        });
+    });
+    hit.distance = tmax * glm::length(ray.direction);
+    return found;
+}
+
+size_t picking::meshCount() { return _meshes.size(); }
+
+size_t picking::instanceCount() { return _instances.size(); }
+
+void picking::dispose() {
+    _meshes.clear();
+    _instances.clear();
+    _instanceBounds.clear();
+    _order.clear();
+    _nodes.clear();
+}
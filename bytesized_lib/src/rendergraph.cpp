@@ -0,0 +1,241 @@
+#include "rendergraph.h"
+
+#include "opengl.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+constexpr uint32_t MAX_COLOR_ATTACHMENTS{4};
+constexpr uint32_t TEXTURE_MAX_AGE{120}; // frames a physical texture may go unused
+
+struct ResourceEntry {
+    const char *name;
+    rendergraph::TextureDesc desc;
+    gpu::Texture *texture;
+    bool imported;
+    int first;
+    int last;
+};
+
+struct Pass {
+    const char *name;
+    std::vector<rendergraph::Resource> reads;
+    std::vector<rendergraph::Resource> writes;
+    std::function<void()> execute;
+    bool sideEffect;
+    bool culled;
+};
+
+struct PhysicalTexture {
+    rendergraph::TextureDesc desc;
+    gpu::Texture *texture;
+    int busyUntil;
+    uint32_t lastFrame;
+};
+
+struct CachedFramebuffer {
+    uint32_t attachments[MAX_COLOR_ATTACHMENTS + 1]; // texture ids, depth stencil last
+    gpu::Framebuffer *fbo;
+};
+
+static std::vector<ResourceEntry> _resources;
+static std::vector<Pass> _passes;
+static std::vector<PhysicalTexture> _textures;
+static std::vector<CachedFramebuffer> _framebuffers;
+static std::vector<rendergraph::PassStats> _stats;
+static uint32_t _frame{0};
+
+void rendergraph::begin(uint32_t backbufferWidth, uint32_t backbufferHeight) {
+    _resources.clear();
+    _passes.clear();
+    _resources.push_back(
+        {"backbuffer", {backbufferWidth, backbufferHeight, gpu::ChannelSetting::RGBA, 0}, nullptr,
+         true, -1, -1});
+    ++_frame;
+}
+
+rendergraph::Resource rendergraph::createTexture(const char *name, const TextureDesc &desc) {
+    _resources.push_back({name, desc, nullptr, false, -1, -1});
+    return static_cast<Resource>(_resources.size() - 1);
+}
+
+rendergraph::Resource rendergraph::importTexture(const char *name, gpu::Texture *texture,
+                                                const TextureDesc &desc) {
+    _resources.push_back({name, desc, texture, true, -1, -1});
+    return static_cast<Resource>(_resources.size() - 1);
+}
+
+void rendergraph::addPass(const char *name, std::initializer_list<Resource> reads,
+                          std::initializer_list<Resource> writes, std::function<void()> execute,
+                          bool sideEffect) {
+    _passes.push_back({name, reads, writes, std::move(execute), sideEffect, false});
+}
+
+gpu::Texture *rendergraph::texture(Resource resource) { return _resources.at(resource).texture; }
+
+static void _cull() {
+    // walking backwards, a pass lives if anything later needs what it writes
+    std::vector<bool> needed(_resources.size());
+    for (size_t i{0}; i < _resources.size(); ++i) {
+        needed[i] = _resources[i].imported;
+    }
+    for (auto it = _passes.rbegin(); it != _passes.rend(); ++it) {
+        it->culled = !it->sideEffect && std::none_of(it->writes.begin(), it->writes.end(),
+                                                     [&needed](auto r) { return needed[r]; });
+        if (!it->culled) {
+            for (auto r : it->reads) {
+                needed[r] = true;
+            }
+        }
+    }
+}
+
+static gpu::Texture *_acquireTexture(const rendergraph::TextureDesc &desc, int first, int last) {
+    for (auto &physical : _textures) {
+        if (physical.lastFrame != _frame || physical.busyUntil < first) {
+            if (physical.desc == desc) {
+                physical.busyUntil = last;
+                physical.lastFrame = _frame;
+                return physical.texture;
+            }
+        }
+    }
+    gpu::Texture *texture =
+        gpu::createTexture(nullptr, desc.width, desc.height, desc.channels, desc.type);
+    _textures.push_back({desc, texture, last, _frame});
+    return texture;
+}
+
+static void _allocate() {
+    for (int i{0}; i < static_cast<int>(_passes.size()); ++i) {
+        if (_passes[i].culled) {
+            continue;
+        }
+        for (const auto *list : {&_passes[i].reads, &_passes[i].writes}) {
+            for (auto r : *list) {
+                ResourceEntry &resource = _resources[r];
+                resource.first = resource.first < 0 ? i : resource.first;
+                resource.last = i;
+            }
+        }
+    }
+    // resources are handed out in order of first use, so aliases never overlap in time
+    std::vector<ResourceEntry *> order;
+    for (auto &resource : _resources) {
+        if (!resource.imported && resource.first >= 0) {
+            order.push_back(&resource);
+        }
+    }
+    std::sort(order.begin(), order.end(),
+              [](const ResourceEntry *a, const ResourceEntry *b) { return a->first < b->first; });
+    for (auto *resource : order) {
+        resource->texture = _acquireTexture(resource->desc, resource->first, resource->last);
+    }
+}
+
+static void _bindFramebuffer(const Pass &pass) {
+    if (pass.writes.empty()) {
+        return;
+    }
+    const rendergraph::TextureDesc &target = _resources[pass.writes.front()].desc;
+    glViewport(0, 0, target.width, target.height);
+    CachedFramebuffer key{};
+    uint32_t colors{0};
+    for (auto r : pass.writes) {
+        if (r == rendergraph::BACKBUFFER) {
+            gpu::Stats_stateChange(gpu::StateChange::FRAMEBUFFER);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            return;
+        }
+        const ResourceEntry &resource = _resources[r];
+        if (resource.desc.channels == gpu::ChannelSetting::DS) {
+            key.attachments[MAX_COLOR_ATTACHMENTS] = resource.texture->id;
+        } else if (colors < MAX_COLOR_ATTACHMENTS) {
+            key.attachments[colors++] = resource.texture->id;
+        }
+    }
+    for (const auto &cached : _framebuffers) {
+        if (std::equal(std::begin(key.attachments), std::end(key.attachments),
+                       std::begin(cached.attachments))) {
+            cached.fbo->bind();
+            return;
+        }
+    }
+    key.fbo = gpu::createFramebuffer();
+    key.fbo->bind();
+    GLenum drawBuffers[MAX_COLOR_ATTACHMENTS];
+    colors = 0;
+    for (auto r : pass.writes) {
+        const ResourceEntry &resource = _resources[r];
+        if (resource.desc.channels == gpu::ChannelSetting::DS) {
+            key.fbo->attach(GL_DEPTH_STENCIL_ATTACHMENT, resource.texture);
+        } else if (colors < MAX_COLOR_ATTACHMENTS) {
+            drawBuffers[colors] = GL_COLOR_ATTACHMENT0 + colors;
+            key.fbo->attach(drawBuffers[colors++], resource.texture);
+        }
+    }
+    if (colors == 0) {
+        drawBuffers[colors++] = GL_NONE;
+    }
+    glDrawBuffers(colors, drawBuffers);
+    key.fbo->checkStatus(pass.name);
+    _framebuffers.push_back(key);
+}
+
+static void _release(uint32_t textureId) {
+    for (auto it = _framebuffers.begin(); it != _framebuffers.end();) {
+        if (std::find(std::begin(it->attachments), std::end(it->attachments), textureId) !=
+            std::end(it->attachments)) {
+            gpu::freeFramebuffer(it->fbo);
+            it = _framebuffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void rendergraph::execute() {
+    _cull();
+    _allocate();
+    _stats.clear();
+    for (auto &pass : _passes) {
+        _stats.push_back({pass.name, pass.culled, 0.0f});
+        if (pass.culled) {
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        _bindFramebuffer(pass);
+        pass.execute();
+        const std::chrono::duration<float, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        _stats.back().cpuMs = elapsed.count();
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (auto it = _textures.begin(); it != _textures.end();) {
+        if (_frame - it->lastFrame > TEXTURE_MAX_AGE) {
+            _release(it->texture->id);
+            gpu::freeTexture(it->texture);
+            it = _textures.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+const std::vector<rendergraph::PassStats> &rendergraph::stats() { return _stats; }
+
+size_t rendergraph::textureCount() { return _textures.size(); }
+
+void rendergraph::dispose() {
+    for (auto &cached : _framebuffers) {
+        gpu::freeFramebuffer(cached.fbo);
+    }
+    for (auto &physical : _textures) {
+        gpu::freeTexture(physical.texture);
+    }
+    _framebuffers.clear();
+    _textures.clear();
+    _resources.clear();
+    _passes.clear();
+}
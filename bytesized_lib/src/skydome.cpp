@@ -139,8 +139,8 @@ void skydome::setSky(const Sky &sky) {
 void skydome::render() {
     _shaderProgram->use();
     glFrontFace(GL_CW);
-    glActiveTexture(GL_TEXTURE0);
-    gpu::builtinMaterial(gpu::BuiltinMaterial::WHITE)->textures[GL_TEXTURE0]->bind();
+    gpu::Texture_activeUnit(0);
+    gpu::builtinMaterial(gpu::BuiltinMaterial::WHITE)->textures[0]->bind();
     gpu::builtinPrimitives(gpu::SPHERE)->render();
     glFrontFace(GL_CCW);
 }
\ No newline at end of file
@@ -1,28 +1,29 @@
 #include "sprite.h"
 #include "gpu.h"
+#include "tilemap.h"
 #include <algorithm>
 
+static recycler<Sprite, BYTESIZED_SPRITE_COUNT> SPRITES = {};
+
 static const char *_spriteVert = BYTESIZED_GLSL_VERSION R"(
-layout (location=0) in vec4 aXYUV;
+layout (location=0) in vec2 aCorner;
+layout (location=1) in vec4 aAxes;
+layout (location=2) in vec4 aRegion;
+layout (location=3) in vec4 aTint;
+layout (location=4) in vec3 aTranslation;
 
 uniform mat4 u_projection;
 uniform mat4 u_view;
-uniform mat4 u_model;
-uniform ivec2 u_flip;
 
 out vec2 UV;
+out vec4 Tint;
 
 void main()
 {
-    UV = aXYUV.zw;
-    if(u_flip.x > 0) {
-        UV.x = 1.0 - UV.x;
-    }
-    if(u_flip.y > 0) {
-        UV.y = 1.0 - UV.y;
-    }
+    UV = aRegion.xy + (aCorner + 0.5) * aRegion.zw;
+    Tint = aTint;
 
-    vec3 p = vec3(u_model * vec4(aXYUV.xy, 0.0, 1.0));
+    vec3 p = vec3(aAxes.xy * aCorner.x + aAxes.zw * aCorner.y, 0.0) + aTranslation;
     gl_Position = u_projection * u_view * vec4(p, 1.0);
 }
 )";
@@ -33,55 +34,64 @@ precision highp float;
 out vec4 FragColor;
   
 in vec2 UV;
+in vec4 Tint;
 
-uniform sampler2D u_texture;
-uniform vec4 u_sprite;
+uniform sampler2D u_diffuse;
 
 void main()
 {
-    vec2 xy = u_sprite.xy;
-    vec2 uv = u_sprite.zw;
-
-    vec4 diffuse = texture(u_texture, UV * uv + xy);
+    vec4 diffuse = texture(u_diffuse, UV);
     if(diffuse.a < 0.1) {
         discard;
     }
-    FragColor = diffuse;
+    FragColor = diffuse * Tint;
 }
 )";
 
-// clang-format off
-static const float _spriteVertices[] = {
-    -0.5f, -0.5f, 0.0f, 0.0f,
-    +0.5f, -0.5f, 1.0f, 0.0f,
-    -0.5f, +0.5f, 0.0f, 1.0f,
-    +0.5f, +0.5f, 1.0f, 1.0f,
-    -0.5f, +0.5f, 0.0f, 1.0f,
-    +0.5f, -0.5f, 1.0f, 0.0f,
-};
-// clang-format on
-
 SpriteRenderer::SpriteRenderer(float width, float height)
     : projection{glm::ortho(0.0f, width, 0.0f, height, -1.0f, 1.0f)} {}
 
+Sprite *SpriteRenderer::createSprite(const glm::vec2 &t, const glm::vec2 &s) {
+    Sprite *sprite = SPRITES.acquire();
+    // a reused slot keeps what its last sprite left, TRS can not be assigned as a whole
+    sprite->translation = glm::vec3{t, 0.0f};
+    sprite->rotation = glm::quat{1.0f, 0.0f, 0.0f, 0.0f};
+    sprite->scale = glm::vec3{s, 1.0f};
+    sprite->animations.clear();
+    sprite->frame_ms = 0;
+    sprite->flip = {0, 0};
+    sprite->tint = glm::vec4{1.0f};
+    sprite->layer = 0;
+    sprite->hidden = false;
+    sprites.push_back(sprite);
+    return sprite;
+}
+
+void SpriteRenderer::freeSprite(Sprite *sprite) {
+    sprites.erase(std::find(sprites.begin(), sprites.end(), sprite));
+    SPRITES.free(sprite);
+}
+
 void SpriteRenderer::update(uint16_t dt) {
-    for (auto &sprite : sprites) {
-        auto &frames = sprite.animation_it->frames;
-        if (sprite.frame_ms <= dt) {
-            ++sprite.frame_it;
-            if (sprite.frame_it == frames.end()) {
-                sprite.frame_it = frames.begin();
+    for (Sprite *sprite : sprites) {
+        if (sprite->animations.empty()) {
+            continue;
+        }
+        auto &frames = sprite->animation_it->frames;
+        if (sprite->frame_ms <= dt) {
+            ++sprite->frame_it;
+            if (sprite->frame_it == frames.end()) {
+                sprite->frame_it = frames.begin();
             }
-            sprite.frame_ms += sprite.frame_it->duration - dt;
+            sprite->frame_ms += sprite->frame_it->duration - dt;
         } else {
-            sprite.frame_ms -= dt;
+            sprite->frame_ms -= dt;
         }
     }
 }
 
 void SpriteRenderer::render() {
     static gpu::ShaderProgram *_shaderProgram = nullptr;
-    static gpu::VertexArray *_planeVAO = nullptr;
 
     if (_shaderProgram == nullptr) {
         _shaderProgram =
@@ -89,34 +99,31 @@ void SpriteRenderer::render() {
                                      gpu::createShader(GL_FRAGMENT_SHADER, _spriteFrag),
                                      {{"u_projection", projection},
                                       {"u_view", glm::mat4{1.0f}},
-                                      {"u_diffuse", 0},
-                                      {"u_model", glm::mat4{1.0f}},
-                                      {"u_sprite", glm::vec4{0.0f, 0.0f, 0.0f, 0.0f}},
-                                      {"u_flip", glm::ivec2{0, 0}}});
+                                      {"u_diffuse", 0}});
     }
-    if (_planeVAO == nullptr) {
-        _planeVAO = gpu::createVertexArray();
-        _planeVAO->bind();
-        uint32_t *vbo = gpu::createVertexBuffer();
-        glBindBuffer(GL_ARRAY_BUFFER, *vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_spriteVertices), _spriteVertices, GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+
+    for (TileLayer *tileLayer : tileLayers) {
+        tileLayer->render(projection);
     }
 
     _shaderProgram->use();
     _shaderProgram->uniforms.at("u_projection") << projection;
-    std::for_each(sprites.begin(), sprites.end(), [](Sprite &sprite) {
-        if (sprite.hidden) {
-            return;
+    for (Sprite *sprite : sprites) {
+        if (sprite->hidden || sprite->animations.empty()) {
+            continue;
+        }
+        const AtlasRegion &region = sprite->frame_it->region;
+        // a flipped axis samples its region from the far edge back
+        glm::vec4 uv{region.bottomLeft, region.size};
+        if (sprite->flip.x > 0) {
+            uv.x += uv.z;
+            uv.z = -uv.z;
         }
-        _shaderProgram->uniforms.at("u_model") << sprite.model();
-        _shaderProgram->uniforms.at("u_sprite")
-            << glm::vec4(sprite.frame_it->region.bottomLeft, sprite.frame_it->region.size);
-        _shaderProgram->uniforms.at("u_flip") << sprite.flip;
-        sprite.animation_it->texture->bind();
-
-        _planeVAO->bind();
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-    });
-}
\ No newline at end of file
+        if (sprite->flip.y > 0) {
+            uv.y += uv.w;
+            uv.w = -uv.w;
+        }
+        batch.add(sprite->animation_it->texture, sprite->layer, sprite->model(), uv, sprite->tint);
+    }
+    batch.draw(_shaderProgram);
+}
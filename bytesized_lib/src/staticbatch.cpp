@@ -0,0 +1,248 @@
+#include "staticbatch.h"
+
+#include "occlusion.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static uint64_t _packKey(const glm::ivec3 &key) {
+    // 21 bits per axis, offset so that negative cells pack as well
+    const auto axis = [](int v) { return static_cast<uint64_t>(v + (1 << 20)) & 0x1FFFFF; };
+    return axis(key.x) | (axis(key.y) << 21) | (axis(key.z) << 42);
+}
+
+static void _appendIndices(const library::Accessor *accessor, uint32_t baseVertex,
+                           std::vector<uint32_t> &indices) {
+    const void *data = const_cast<library::Accessor *>(accessor)->data();
+    for (uint32_t i{0}; i < accessor->count; ++i) {
+        switch (accessor->componentType) {
+        case GL_UNSIGNED_BYTE:
+            indices.push_back(baseVertex + static_cast<const uint8_t *>(data)[i]);
+            break;
+        case GL_UNSIGNED_SHORT:
+            indices.push_back(baseVertex + static_cast<const uint16_t *>(data)[i]);
+            break;
+        default:
+            indices.push_back(baseVertex + static_cast<const uint32_t *>(data)[i]);
+            break;
+        }
+    }
+}
+
+static void _appendPrimitive(const library::Primitive &primitive, const glm::mat4 &model,
+                             const glm::mat3 &normalMatrix, BakedGeometry &geometry) {
+    using Attribute = library::Primitive::Attribute;
+    const auto [positions, count] = primitive.positions();
+    const glm::vec3 *normals = primitive.attributes[Attribute::NORMAL]
+                                   ? primitive.normals().first
+                                   : nullptr;
+    const library::Accessor *uvAccessor = primitive.attributes[Attribute::TEXCOORD_0];
+    const glm::vec2 *uvs = uvAccessor && uvAccessor->componentType == GL_FLOAT
+                               ? primitive.texcoords().first
+                               : nullptr;
+    const uint32_t baseVertex = static_cast<uint32_t>(geometry.vertices.size());
+    for (size_t i{0}; i < count; ++i) {
+        geometry.vertices.push_back(
+            {glm::vec3{model * glm::vec4{positions[i], 1.0f}},
+             normals ? glm::normalize(normalMatrix * normals[i]) : glm::vec3{0.0f},
+             uvs ? uvs[i] : glm::vec2{0.0f}});
+    }
+    if (primitive.indices) {
+        _appendIndices(primitive.indices, baseVertex, geometry.indices);
+    } else {
+        for (uint32_t i{0}; i < count; ++i) {
+            geometry.indices.push_back(baseVertex + i);
+        }
+    }
+}
+
+void StaticBatch::add(gpu::Node *node) {
+    if (contains(node)) {
+        return;
+    }
+    const glm::ivec3 key = cellKey(glm::vec3{node->model()[3]});
+    const uint64_t packed = _packKey(key);
+    auto it = _cellIndices.find(packed);
+    if (it == _cellIndices.end()) {
+        it = _cellIndices.emplace(packed, static_cast<uint32_t>(cells.size())).first;
+        cells.push_back({key, glm::vec3{0.0f}, glm::vec3{0.0f}, {}, {}, true});
+    }
+    Cell &cell = cells[it->second];
+    cell.nodes.push_back(node);
+    cell.dirty = true;
+    _nodeCells.emplace(node, it->second);
+}
+
+void StaticBatch::remove(gpu::Node *node) {
+    if (node == _excluded) {
+        _excluded = nullptr;
+    }
+    auto it = _nodeCells.find(node);
+    if (it == _nodeCells.end()) {
+        return;
+    }
+    Cell &cell = cells[it->second];
+    cell.nodes.erase(std::find(cell.nodes.begin(), cell.nodes.end(), node));
+    cell.dirty = true;
+    _nodeCells.erase(it);
+}
+
+void StaticBatch::invalidate(const gpu::Node *node) {
+    auto it = _nodeCells.find(node);
+    if (it != _nodeCells.end()) {
+        cells[it->second].dirty = true;
+    }
+}
+
+gpu::Node *StaticBatch::exclude(gpu::Node *node) {
+    if (node == _excluded) {
+        return nullptr;
+    }
+    gpu::Node *previous = _excluded;
+    _excluded = nullptr;
+    if (node && contains(node)) {
+        remove(node);
+        _excluded = node;
+    }
+    return previous;
+}
+
+glm::ivec3 StaticBatch::cellKey(const glm::vec3 &position) const {
+    return glm::ivec3{glm::floor(position / cellSize)};
+}
+
+void StaticBatch::buildCell(const Cell &cell, std::vector<BakedGeometry> &geometry) const {
+    for (gpu::Node *root : cell.nodes) {
+        root->recursive([&geometry](gpu::Node *node) {
+            if (node->hidden || node->mesh == nullptr || node->mesh->libraryMesh == nullptr) {
+                return;
+            }
+            const glm::mat4 &model = node->model();
+            const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3{model}));
+            const auto &libraryPrimitives = node->mesh->libraryMesh->primitives;
+            for (size_t i{0}; i < node->mesh->primitives.size() && i < libraryPrimitives.size();
+                 ++i) {
+                gpu::Material *material = node->mesh->primitives[i].second;
+                auto it = std::find_if(geometry.begin(), geometry.end(),
+                                       [material](const BakedGeometry &g) {
+                                           return g.material == material;
+                                       });
+                if (it == geometry.end()) {
+                    it = geometry.insert(geometry.end(), {material, {}, {}});
+                }
+                _appendPrimitive(libraryPrimitives[i], model, normalMatrix, *it);
+            }
+        });
+    }
+}
+
+void StaticBatch::_freeBatches(Cell &cell) {
+    for (const Batch &batch : cell.batches) {
+        gpu::freeVertexBuffer(batch.vbo);
+        gpu::freeVertexBuffer(batch.ebo);
+        gpu::freeMaterial(batch.material);
+    }
+    cell.batches.clear();
+}
+
+uint32_t StaticBatch::bake() {
+    uint32_t baked{0};
+    for (Cell &cell : cells) {
+        if (!cell.dirty) {
+            continue;
+        }
+        if (vao == nullptr) {
+            vao = gpu::createVertexArray();
+            vao->bind();
+            glEnableVertexAttribArray(0);
+            glEnableVertexAttribArray(1);
+            glEnableVertexAttribArray(2);
+        }
+        // the element buffer binding is vao state and webgl types a buffer by its first binding
+        vao->bind();
+        _freeBatches(cell);
+        _geometry.clear();
+        buildCell(cell, _geometry);
+        cell.min = glm::vec3{FLT_MAX};
+        cell.max = glm::vec3{-FLT_MAX};
+        for (const auto &geometry : _geometry) {
+            if (geometry.indices.empty()) {
+                continue;
+            }
+            for (const auto &vertex : geometry.vertices) {
+                cell.min = glm::min(cell.min, vertex.position);
+                cell.max = glm::max(cell.max, vertex.position);
+            }
+            // the batch outlives the nodes it was baked from until the cell is rebaked
+            gpu::Material *material = gpu::retainMaterial(geometry.material);
+            Batch &batch = cell.batches.emplace_back(
+                material, gpu::createVertexBuffer(), gpu::createVertexBuffer(),
+                static_cast<uint32_t>(geometry.indices.size()));
+            glBindBuffer(GL_ARRAY_BUFFER, *batch.vbo);
+            glBufferData(GL_ARRAY_BUFFER, geometry.vertices.size() * sizeof(BakedVertex),
+                         geometry.vertices.data(), GL_STATIC_DRAW);
+            gpu::Stats_bufferUpload(geometry.vertices.size() * sizeof(BakedVertex));
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *batch.ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, geometry.indices.size() * sizeof(uint32_t),
+                         geometry.indices.data(), GL_STATIC_DRAW);
+            gpu::Stats_bufferUpload(geometry.indices.size() * sizeof(uint32_t));
+        }
+        cell.dirty = false;
+        ++baked;
+    }
+    if (baked > 0) {
+        vao->unbind();
+    }
+    return baked;
+}
+
+void StaticBatch::render(gpu::ShaderProgram *shaderProgram, bool cull) {
+    _drawCalls = 0;
+    _visible.clear();
+    for (const Cell &cell : cells) {
+        if (cell.batches.empty() || (cull && !occlusion::isVisible(cell.min, cell.max))) {
+            continue;
+        }
+        for (const Batch &batch : cell.batches) {
+            _visible.push_back(&batch);
+        }
+    }
+    if (_visible.empty()) {
+        return;
+    }
+    // cells sharing a material are drawn after one another
+    std::stable_sort(_visible.begin(), _visible.end(), [](const Batch *a, const Batch *b) {
+        return a->material < b->material;
+    });
+    shaderProgram->uniforms.at("u_model") << glm::mat4{1.0f};
+    vao->bind();
+    gpu::Material *material{nullptr};
+    for (const Batch *batch : _visible) {
+        if (batch->material != material) {
+            material = batch->material;
+            gpu::bindMaterial(shaderProgram, material);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, *batch->vbo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex),
+                              (void *)offsetof(BakedVertex, position));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex),
+                              (void *)offsetof(BakedVertex, normal));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex),
+                              (void *)offsetof(BakedVertex, uv));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *batch->ebo);
+        gpu::Stats_draw(GL_TRIANGLES, batch->count);
+        glDrawElements(GL_TRIANGLES, batch->count, GL_UNSIGNED_INT, 0);
+        ++_drawCalls;
+    }
+    vao->unbind();
+}
+
+void StaticBatch::dispose() {
+    for (Cell &cell : cells) {
+        _freeBatches(cell);
+    }
+    cells.clear();
+    _cellIndices.clear();
+    _nodeCells.clear();
+    _excluded = nullptr;
+}
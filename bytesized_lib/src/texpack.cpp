@@ -0,0 +1,474 @@
+#include "texpack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+uint32_t texpack::blockSize(Format format) {
+    switch (format) {
+    case BC1:
+    case ETC2_RGB8:
+        return 8;
+    case BC3:
+    case BC5:
+    case ETC2_RGBA8:
+        return 16;
+    case RGBA8:
+    default:
+        return 4;
+    }
+}
+
+bool texpack::isCompressed(Format format) { return format != RGBA8; }
+
+uint32_t texpack::levelSize(Format format, uint32_t width, uint32_t height) {
+    if (!isCompressed(format)) {
+        return width * height * blockSize(format);
+    }
+    return ((width + 3) / 4) * ((height + 3) / 4) * blockSize(format);
+}
+
+uint32_t texpack::levelCount(uint32_t width, uint32_t height) {
+    uint32_t levels{1};
+    for (uint32_t size = std::max(width, height); size > 1 && levels < MAX_LEVELS; size /= 2) {
+        ++levels;
+    }
+    return levels;
+}
+
+bool texpack::header(const uint8_t *data, size_t len, Header &header) {
+    if (data == nullptr || len < sizeof(Header) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    // embedded data has no alignment guarantees
+    std::memcpy(&header, data, sizeof(Header));
+    if (header.format > ETC2_RGBA8 || header.width == 0 || header.height == 0 ||
+        header.levels == 0 || header.levels > levelCount(header.width, header.height)) {
+        return false;
+    }
+    const Format format = static_cast<Format>(header.format);
+    for (uint32_t i{0}; i < header.levels; ++i) {
+        const uint32_t width = std::max(header.width >> i, 1u);
+        const uint32_t height = std::max(header.height >> i, 1u);
+        if (header.sizes[i] != levelSize(format, width, height) ||
+            static_cast<size_t>(header.offsets[i]) + header.sizes[i] > len) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void texpack::downsample(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst) {
+    const uint32_t w = std::max(width / 2, 1u);
+    const uint32_t h = std::max(height / 2, 1u);
+    for (uint32_t y{0}; y < h; ++y) {
+        const uint32_t y0 = std::min(y * 2, height - 1);
+        const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x{0}; x < w; ++x) {
+            const uint32_t x0 = std::min(x * 2, width - 1);
+            const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            for (uint32_t c{0}; c < 4; ++c) {
+                const uint32_t sum = src[(y0 * width + x0) * 4 + c] +
+                                     src[(y0 * width + x1) * 4 + c] +
+                                     src[(y1 * width + x0) * 4 + c] + src[(y1 * width + x1) * 4 + c];
+                dst[(y * w + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+static inline int _sq(int v) { return v * v; }
+
+static inline uint8_t _clamp8(int v) { return static_cast<uint8_t>(std::clamp(v, 0, 255)); }
+
+static inline void _storeLE(uint8_t *out, uint64_t bits, int bytes) {
+    for (int i{0}; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+}
+
+static inline void _storeBE(uint8_t *out, uint64_t bits) {
+    for (int i{0}; i < 8; ++i) {
+        out[i] = static_cast<uint8_t>(bits >> ((7 - i) * 8));
+    }
+}
+
+static uint16_t _to565(const float color[3]) {
+    const int r = std::clamp(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    const int g = std::clamp(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    const int b = std::clamp(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+static void _from565(uint16_t c, int rgb[3]) {
+    const int r = c >> 11 & 0x1F;
+    const int g = c >> 5 & 0x3F;
+    const int b = c & 0x1F;
+    rgb[0] = r << 3 | r >> 2;
+    rgb[1] = g << 2 | g >> 4;
+    rgb[2] = b << 3 | b >> 2;
+}
+
+void texpack::encodeBC1(const uint8_t rgba[64], uint8_t out[8]) {
+    // endpoints along the principal axis of the colors, inset to reduce the error at the ends
+    float mean[3]{};
+    for (int i{0}; i < 16; ++i) {
+        for (int c{0}; c < 3; ++c) {
+            mean[c] += rgba[i * 4 + c] / 16.0f;
+        }
+    }
+    float cov[6]{};
+    for (int i{0}; i < 16; ++i) {
+        const float r = rgba[i * 4 + 0] - mean[0];
+        const float g = rgba[i * 4 + 1] - mean[1];
+        const float b = rgba[i * 4 + 2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+    float axis[3]{1.0f, 1.0f, 1.0f};
+    for (int i{0}; i < 8; ++i) {
+        const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        const float m = std::max({std::fabs(x), std::fabs(y), std::fabs(z)});
+        if (m < 1e-6f) {
+            break;
+        }
+        axis[0] = x / m;
+        axis[1] = y / m;
+        axis[2] = z / m;
+    }
+    float minT{0.0f};
+    float maxT{0.0f};
+    for (int i{0}; i < 16; ++i) {
+        const float t = (rgba[i * 4 + 0] - mean[0]) * axis[0] +
+                        (rgba[i * 4 + 1] - mean[1]) * axis[1] +
+                        (rgba[i * 4 + 2] - mean[2]) * axis[2];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    const float length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    const float inset = (maxT - minT) / 16.0f;
+    float hi[3];
+    float lo[3];
+    for (int c{0}; c < 3; ++c) {
+        hi[c] = mean[c] + axis[c] * (maxT - inset) / std::max(length, 1e-6f);
+        lo[c] = mean[c] + axis[c] * (minT + inset) / std::max(length, 1e-6f);
+    }
+    uint16_t c0 = _to565(hi);
+    uint16_t c1 = _to565(lo);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+    uint32_t indices{0};
+    if (c0 != c1) {
+        int palette[4][3];
+        _from565(c0, palette[0]);
+        _from565(c1, palette[1]);
+        for (int c{0}; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i{0}; i < 16; ++i) {
+            int best{0};
+            int bestError{INT32_MAX};
+            for (int j{0}; j < 4; ++j) {
+                const int error = _sq(rgba[i * 4 + 0] - palette[j][0]) +
+                                  _sq(rgba[i * 4 + 1] - palette[j][1]) +
+                                  _sq(rgba[i * 4 + 2] - palette[j][2]);
+                if (error < bestError) {
+                    best = j;
+                    bestError = error;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (i * 2);
+        }
+    }
+    _storeLE(out, c0, 2);
+    _storeLE(out + 2, c1, 2);
+    _storeLE(out + 4, indices, 4);
+}
+
+// BC4, one channel with eight interpolated values
+static void _encodeChannel(const uint8_t rgba[64], int channel, uint8_t out[8]) {
+    int a0{0};
+    int a1{255};
+    for (int i{0}; i < 16; ++i) {
+        a0 = std::max(a0, static_cast<int>(rgba[i * 4 + channel]));
+        a1 = std::min(a1, static_cast<int>(rgba[i * 4 + channel]));
+    }
+    uint64_t bits = static_cast<uint64_t>(a0) | static_cast<uint64_t>(a1) << 8;
+    if (a0 != a1) {
+        int values[8]{a0, a1};
+        for (int j{1}; j < 7; ++j) {
+            values[j + 1] = ((7 - j) * a0 + j * a1) / 7;
+        }
+        for (int i{0}; i < 16; ++i) {
+            int best{0};
+            for (int j{1}; j < 8; ++j) {
+                if (std::abs(rgba[i * 4 + channel] - values[j]) <
+                    std::abs(rgba[i * 4 + channel] - values[best])) {
+                    best = j;
+                }
+            }
+            bits |= static_cast<uint64_t>(best) << (16 + i * 3);
+        }
+    }
+    _storeLE(out, bits, 8);
+}
+
+void texpack::encodeBC3(const uint8_t rgba[64], uint8_t out[16]) {
+    _encodeChannel(rgba, 3, out);
+    encodeBC1(rgba, out + 8);
+}
+
+void texpack::encodeBC5(const uint8_t rgba[64], uint8_t out[16]) {
+    _encodeChannel(rgba, 0, out);
+    _encodeChannel(rgba, 1, out + 8);
+}
+
+static constexpr int ETC_MODIFIERS[8][4] = {
+    {2, 8, -2, -8},     {5, 17, -5, -17},   {9, 29, -9, -29},     {13, 42, -13, -42},
+    {18, 60, -18, -60}, {24, 80, -24, -80}, {33, 106, -33, -106}, {47, 183, -47, -183},
+};
+
+struct EtcSubblock {
+    int table;
+    int error;
+    uint32_t indices[8];
+};
+
+// ETC pixels are indexed column major, the flip bit selects a 2x4 or 4x2 split
+static inline int _etcPixel(int flip, int subblock, int i) {
+    const int x = flip ? i % 4 : subblock * 2 + i / 4;
+    const int y = flip ? subblock * 2 + i / 4 : i % 4;
+    return x * 4 + y;
+}
+
+static EtcSubblock _fitSubblock(const uint8_t rgba[64], int flip, int subblock, const int base[3]) {
+    EtcSubblock result{0, INT32_MAX, {}};
+    for (int table{0}; table < 8; ++table) {
+        EtcSubblock candidate{table, 0, {}};
+        for (int i{0}; i < 8; ++i) {
+            const int p = _etcPixel(flip, subblock, i);
+            const uint8_t *pixel = rgba + ((p % 4) * 4 + p / 4) * 4;
+            int bestError{INT32_MAX};
+            for (int j{0}; j < 4; ++j) {
+                const int m = ETC_MODIFIERS[table][j];
+                const int error = _sq(pixel[0] - _clamp8(base[0] + m)) +
+                                  _sq(pixel[1] - _clamp8(base[1] + m)) +
+                                  _sq(pixel[2] - _clamp8(base[2] + m));
+                if (error < bestError) {
+                    bestError = error;
+                    candidate.indices[i] = j;
+                }
+            }
+            candidate.error += bestError;
+        }
+        if (candidate.error < result.error) {
+            result = candidate;
+        }
+    }
+    return result;
+}
+
+void texpack::encodeETC2RGB(const uint8_t rgba[64], uint8_t out[8]) {
+    // individual and differential modes only, which every ETC1 and ETC2 decoder accepts
+    uint64_t bestBits{0};
+    int bestError{INT32_MAX};
+    for (int flip{0}; flip < 2; ++flip) {
+        float avg[2][3]{};
+        for (int s{0}; s < 2; ++s) {
+            for (int i{0}; i < 8; ++i) {
+                const int p = _etcPixel(flip, s, i);
+                for (int c{0}; c < 3; ++c) {
+                    avg[s][c] += rgba[((p % 4) * 4 + p / 4) * 4 + c] / 8.0f;
+                }
+            }
+        }
+        for (int diff{0}; diff < 2; ++diff) {
+            const int levels = diff ? 31 : 15;
+            int quantized[2][3];
+            int base[2][3];
+            bool valid{true};
+            for (int s{0}; s < 2; ++s) {
+                for (int c{0}; c < 3; ++c) {
+                    quantized[s][c] = static_cast<int>(avg[s][c] * levels / 255.0f + 0.5f);
+                    base[s][c] = diff ? (quantized[s][c] << 3 | quantized[s][c] >> 2)
+                                      : (quantized[s][c] << 4 | quantized[s][c]);
+                }
+            }
+            for (int c{0}; c < 3 && diff; ++c) {
+                const int delta = quantized[1][c] - quantized[0][c];
+                valid = valid && delta >= -4 && delta <= 3;
+            }
+            if (!valid) {
+                continue;
+            }
+            const EtcSubblock first = _fitSubblock(rgba, flip, 0, base[0]);
+            const EtcSubblock second = _fitSubblock(rgba, flip, 1, base[1]);
+            if (first.error + second.error >= bestError) {
+                continue;
+            }
+            bestError = first.error + second.error;
+            uint64_t bits{0};
+            for (int c{0}; c < 3; ++c) {
+                const int shift = 56 - c * 8;
+                if (diff) {
+                    const int delta = quantized[1][c] - quantized[0][c];
+                    bits |= static_cast<uint64_t>(quantized[0][c]) << (shift + 3);
+                    bits |= static_cast<uint64_t>(delta & 0x7) << shift;
+                } else {
+                    bits |= static_cast<uint64_t>(quantized[0][c]) << (shift + 4);
+                    bits |= static_cast<uint64_t>(quantized[1][c]) << shift;
+                }
+            }
+            bits |= static_cast<uint64_t>(first.table) << 37;
+            bits |= static_cast<uint64_t>(second.table) << 34;
+            bits |= static_cast<uint64_t>(diff) << 33;
+            bits |= static_cast<uint64_t>(flip) << 32;
+            for (int s{0}; s < 2; ++s) {
+                const EtcSubblock &sub = s ? second : first;
+                for (int i{0}; i < 8; ++i) {
+                    const int p = _etcPixel(flip, s, i);
+                    bits |= static_cast<uint64_t>(sub.indices[i] >> 1) << (16 + p);
+                    bits |= static_cast<uint64_t>(sub.indices[i] & 1) << p;
+                }
+            }
+            bestBits = bits;
+        }
+    }
+    _storeBE(out, bestBits);
+}
+
+static constexpr int EAC_MODIFIERS[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14},  {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12},  {-3, -6, -8, -12, 2, 5, 7, 11},  {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},  {-3, -5, -8, -11, 2, 4, 7, 10},  {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},   {-2, -4, -8, -10, 1, 3, 7, 9},   {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},   {-1, -2, -3, -10, 0, 1, 2, 9},   {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8},
+};
+
+static void _encodeEAC(const uint8_t rgba[64], uint8_t out[8]) {
+    int lo{255};
+    int hi{0};
+    for (int i{0}; i < 16; ++i) {
+        lo = std::min(lo, static_cast<int>(rgba[i * 4 + 3]));
+        hi = std::max(hi, static_cast<int>(rgba[i * 4 + 3]));
+    }
+    const int base = (lo + hi + 1) / 2;
+    uint64_t bestBits{0};
+    int bestError{INT32_MAX};
+    for (int table{0}; table < 16; ++table) {
+        const int *modifiers = EAC_MODIFIERS[table];
+        const int span = modifiers[7] - modifiers[3];
+        const int guess = std::clamp((hi - lo + span / 2) / span, 1, 15);
+        for (int multiplier = std::max(guess - 1, 1); multiplier <= std::min(guess + 1, 15);
+             ++multiplier) {
+            uint64_t bits = static_cast<uint64_t>(base) << 56 |
+                            static_cast<uint64_t>(multiplier) << 52 |
+                            static_cast<uint64_t>(table) << 48;
+            int error{0};
+            for (int p{0}; p < 16; ++p) {
+                const int alpha = rgba[((p % 4) * 4 + p / 4) * 4 + 3];
+                int best{0};
+                int bestPixel{INT32_MAX};
+                for (int j{0}; j < 8; ++j) {
+                    const int e = _sq(alpha - _clamp8(base + modifiers[j] * multiplier));
+                    if (e < bestPixel) {
+                        best = j;
+                        bestPixel = e;
+                    }
+                }
+                error += bestPixel;
+                bits |= static_cast<uint64_t>(best) << (45 - p * 3);
+            }
+            if (error < bestError) {
+                bestError = error;
+                bestBits = bits;
+            }
+        }
+    }
+    _storeBE(out, bestBits);
+}
+
+void texpack::encodeETC2RGBA(const uint8_t rgba[64], uint8_t out[16]) {
+    _encodeEAC(rgba, out);
+    encodeETC2RGB(rgba, out + 8);
+}
+
+static void _encodeLevel(const uint8_t *rgba, uint32_t width, uint32_t height,
+                         texpack::Format format, uint8_t *out) {
+    if (!texpack::isCompressed(format)) {
+        std::memcpy(out, rgba, width * height * 4);
+        return;
+    }
+    const uint32_t blockSize = texpack::blockSize(format);
+    uint8_t block[64];
+    for (uint32_t by{0}; by < height; by += 4) {
+        for (uint32_t bx{0}; bx < width; bx += 4) {
+            for (uint32_t i{0}; i < 16; ++i) {
+                const uint32_t x = std::min(bx + i % 4, width - 1);
+                const uint32_t y = std::min(by + i / 4, height - 1);
+                std::memcpy(block + i * 4, rgba + (y * width + x) * 4, 4);
+            }
+            switch (format) {
+            case texpack::BC1:
+                texpack::encodeBC1(block, out);
+                break;
+            case texpack::BC3:
+                texpack::encodeBC3(block, out);
+                break;
+            case texpack::BC5:
+                texpack::encodeBC5(block, out);
+                break;
+            case texpack::ETC2_RGB8:
+                texpack::encodeETC2RGB(block, out);
+                break;
+            case texpack::ETC2_RGBA8:
+                texpack::encodeETC2RGBA(block, out);
+                break;
+            default:
+                break;
+            }
+            out += blockSize;
+        }
+    }
+}
+
+std::vector<uint8_t> texpack::pack(const uint8_t *rgba, uint32_t width, uint32_t height,
+                                   Format format) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.format = format;
+    header.width = width;
+    header.height = height;
+    header.levels = levelCount(width, height);
+    uint32_t offset = sizeof(Header);
+    for (uint32_t i{0}; i < header.levels; ++i) {
+        header.offsets[i] = offset;
+        header.sizes[i] = levelSize(format, std::max(width >> i, 1u), std::max(height >> i, 1u));
+        offset += header.sizes[i];
+    }
+    std::vector<uint8_t> packed(offset);
+    std::memcpy(packed.data(), &header, sizeof(Header));
+
+    std::vector<uint8_t> level(rgba, rgba + width * height * 4);
+    std::vector<uint8_t> next;
+    for (uint32_t i{0}; i < header.levels; ++i) {
+        const uint32_t w = std::max(width >> i, 1u);
+        const uint32_t h = std::max(height >> i, 1u);
+        _encodeLevel(level.data(), w, h, format, packed.data() + header.offsets[i]);
+        if (i + 1 < header.levels) {
+            next.resize(std::max(w / 2, 1u) * std::max(h / 2, 1u) * 4);
+            downsample(level.data(), w, h, next.data());
+            level.swap(next);
+        }
+    }
+    return packed;
+}
@@ -0,0 +1,187 @@
+#include "tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+
+static_assert(BYTESIZED_TILEMAP_CHUNK * BYTESIZED_TILEMAP_CHUNK * 4 <= 65536,
+              "chunk corners are indexed by uint16_t");
+
+static const char *_tileVert = BYTESIZED_GLSL_VERSION R"(
+layout (location=0) in vec2 aPos;
+layout (location=1) in vec2 aUV;
+
+uniform mat4 u_projection;
+uniform mat4 u_view;
+
+out vec2 UV;
+
+void main()
+{
+    UV = aUV;
+    gl_Position = u_projection * u_view * vec4(aPos, 0.0, 1.0);
+}
+)";
+
+static const char *_tileFrag = BYTESIZED_GLSL_VERSION R"(
+precision highp float;
+
+out vec4 FragColor;
+
+in vec2 UV;
+
+uniform sampler2D u_diffuse;
+
+void main()
+{
+    vec4 diffuse = texture(u_diffuse, UV);
+    if(diffuse.a < 0.1) {
+        discard;
+    }
+    FragColor = diffuse;
+}
+)";
+
+TileLayer::TileLayer(uint32_t width_, uint32_t height_, const glm::vec2 &tileSize_,
+                     gpu::Texture *texture_, const AtlasRegion *regions_, size_t regionCount_)
+    : width{width_}, height{height_}, tileSize{tileSize_}, texture{texture_}, regions{regions_},
+      regionCount{regionCount_}, chunksX{(width_ + CHUNK_SIZE - 1) / CHUNK_SIZE},
+      chunksY{(height_ + CHUNK_SIZE - 1) / CHUNK_SIZE},
+      tiles(static_cast<size_t>(width_) * height_, EMPTY), chunks(chunksX * chunksY) {}
+
+void TileLayer::set(uint32_t x, uint32_t y, uint16_t tile) {
+    uint16_t &current = tiles[y * width + x];
+    if (current != tile) {
+        current = tile;
+        chunks[(y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE].dirty = true;
+    }
+}
+
+void TileLayer::fill(uint16_t tile) {
+    std::fill(tiles.begin(), tiles.end(), tile);
+    for (auto &chunk : chunks) {
+        chunk.dirty = true;
+    }
+}
+
+void TileLayer::visibleChunks(const glm::mat4 &viewProjection,
+                              std::vector<uint32_t> &chunkIndices) const {
+    const glm::mat4 inverse = glm::inverse(viewProjection);
+    glm::vec2 min{INFINITY};
+    glm::vec2 max{-INFINITY};
+    for (int i{0}; i < 4; ++i) {
+        const glm::vec4 corner =
+            inverse * glm::vec4{(i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, 0.0f, 1.0f};
+        const glm::vec2 p = glm::vec2{corner} / corner.w;
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+    const glm::vec2 chunkSize = tileSize * static_cast<float>(CHUNK_SIZE);
+    const glm::vec2 first = glm::floor((min - origin) / chunkSize);
+    const glm::vec2 last = glm::floor((max - origin) / chunkSize);
+    if (last.x < 0.0f || last.y < 0.0f || first.x >= chunksX || first.y >= chunksY) {
+        return;
+    }
+    const uint32_t x0 = static_cast<uint32_t>(std::max(first.x, 0.0f));
+    const uint32_t y0 = static_cast<uint32_t>(std::max(first.y, 0.0f));
+    const uint32_t x1 = std::min(static_cast<uint32_t>(last.x), chunksX - 1);
+    const uint32_t y1 = std::min(static_cast<uint32_t>(last.y), chunksY - 1);
+    for (uint32_t y{y0}; y <= y1; ++y) {
+        for (uint32_t x{x0}; x <= x1; ++x) {
+            chunkIndices.push_back(y * chunksX + x);
+        }
+    }
+}
+
+uint32_t TileLayer::buildChunk(uint32_t chunk, std::vector<TileVertex> &vertices) const {
+    const uint32_t cx = (chunk % chunksX) * CHUNK_SIZE;
+    const uint32_t cy = (chunk / chunksX) * CHUNK_SIZE;
+    uint32_t quads{0};
+    for (uint32_t y{cy}; y < std::min(cy + CHUNK_SIZE, height); ++y) {
+        for (uint32_t x{cx}; x < std::min(cx + CHUNK_SIZE, width); ++x) {
+            const uint16_t tile = tiles[y * width + x];
+            if (tile == EMPTY || tile >= regionCount) {
+                continue;
+            }
+            const AtlasRegion &region = regions[tile];
+            const glm::vec2 position =
+                origin + glm::vec2{static_cast<float>(x), static_cast<float>(y)} * tileSize;
+            // 2-3
+            // 0-1
+            for (int i{0}; i < 4; ++i) {
+                const glm::vec2 corner{static_cast<float>(i & 1), static_cast<float>(i >> 1)};
+                vertices.push_back(
+                    {position + corner * tileSize, region.bottomLeft + corner * region.size});
+            }
+            ++quads;
+        }
+    }
+    return quads;
+}
+
+void TileLayer::render(const glm::mat4 &projection, const glm::mat4 &view) {
+    static gpu::ShaderProgram *_shaderProgram = nullptr;
+
+    if (_shaderProgram == nullptr) {
+        _shaderProgram = gpu::createShaderProgram(
+            gpu::createShader(GL_VERTEX_SHADER, _tileVert),
+            gpu::createShader(GL_FRAGMENT_SHADER, _tileFrag),
+            {{"u_projection", projection}, {"u_view", view}, {"u_diffuse", 0}});
+    }
+    if (vao == nullptr) {
+        vao = gpu::createVertexArray();
+        vao->bind();
+        ebo = gpu::createQuadIndexBuffer(CHUNK_SIZE * CHUNK_SIZE);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        vao->unbind();
+    }
+
+    _visible.clear();
+    visibleChunks(projection * view, _visible);
+
+    _shaderProgram->use();
+    _shaderProgram->uniforms.at("u_projection") << projection;
+    _shaderProgram->uniforms.at("u_view") << view;
+    vao->bind();
+    gpu::Texture_activeUnit(0);
+    texture->bind();
+    _drawCalls = 0;
+    _rebuiltChunks = 0;
+    for (uint32_t index : _visible) {
+        Chunk &chunk = chunks[index];
+        if (chunk.dirty) {
+            _vertices.clear();
+            chunk.quads = buildChunk(index, _vertices);
+            if (chunk.vbo == nullptr) {
+                chunk.vbo = gpu::createVertexBuffer();
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, *chunk.vbo);
+            glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(TileVertex), _vertices.data(),
+                         GL_STATIC_DRAW);
+            gpu::Stats_bufferUpload(_vertices.size() * sizeof(TileVertex));
+            chunk.dirty = false;
+            ++_rebuiltChunks;
+        }
+        if (chunk.quads == 0) {
+            continue;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, *chunk.vbo);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TileVertex),
+                              (void *)offsetof(TileVertex, position));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TileVertex),
+                              (void *)offsetof(TileVertex, uv));
+        gpu::Stats_draw(GL_TRIANGLES, chunk.quads * 6);
+        glDrawElements(GL_TRIANGLES, chunk.quads * 6, GL_UNSIGNED_SHORT, 0);
+        ++_drawCalls;
+    }
+    vao->unbind();
+}
+
+void TileLayer::dispose() {
+    for (auto &chunk : chunks) {
+        if (chunk.vbo != nullptr) {
+            gpu::freeVertexBuffer(chunk.vbo);
+        }
+        chunk = {};
+    }
+}
@@ -75,40 +75,48 @@ gpu::Uniform &gpu::Uniform::operator=(const glm::ivec2 &value) {
 }
 
 gpu::Uniform &gpu::Uniform::operator<<(const int &value) {
+    Stats_uniformUpload();
     glUniform1i(location, value);
     return *this;
 }
 
 gpu::Uniform &gpu::Uniform::operator<<(const float &value) {
+    Stats_uniformUpload();
     glUniform1f(location, value);
     return *this;
 }
 
 gpu::Uniform &gpu::Uniform::operator<<(const glm::vec2 &value) {
+    Stats_uniformUpload();
     glUniform2fv(location, 1, glm::value_ptr(value));
     return *this;
 }
 
 gpu::Uniform &gpu::Uniform::operator<<(const glm::vec3 &value) {
+    Stats_uniformUpload();
     glUniform3fv(location, 1, glm::value_ptr(value));
     return *this;
 }
 
 gpu::Uniform &gpu::Uniform::operator<<(const glm::vec4 &value) {
+    Stats_uniformUpload();
     glUniform4fv(location, 1, glm::value_ptr(value));
     return *this;
 }
 
 gpu::Uniform &gpu::Uniform::operator<<(const glm::mat3 &value) {
+    Stats_uniformUpload();
     glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
     return *this;
 }
 
 gpu::Uniform &gpu::Uniform::operator<<(const glm::mat4 &value) {
+    Stats_uniformUpload();
     glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
     return *this;
 }
 gpu::Uniform &gpu::Uniform::operator<<(const glm::ivec2 &value) {
+    Stats_uniformUpload();
     glUniform2iv(location, 1, glm::value_ptr(value));
     return *this;
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "gpu.h"
+
+/// @brief A linearly interpolated track over count keys of an animation, from key first.
+inline gpu::Track linearTrack(gpu::Node *node, gpu::Animation::ChannelType type, uint32_t first,
+                              uint32_t count) {
+    return {node, type, library::Sampler::LINEAR, 0, first, count, 0, {}, {}};
+}
+
+/// @brief Holds node at x along the x axis for endTime seconds, with a single key.
+inline gpu::Animation holdAnimation(gpu::Node *node, const char *name, float x, float endTime) {
+    gpu::Animation animation{};
+    animation.name = name;
+    animation.endTime = endTime;
+    animation.times = {0.0f};
+    animation.values = {{x, 0.0f, 0.0f, 0.0f}};
+    animation.tracks = {linearTrack(node, gpu::Animation::CH_TRANSLATION, 0, 1)};
+    return animation;
+}
+
+/// @brief Moves node from 0 to distance along the x axis in endTime seconds.
+inline gpu::Animation walkAnimation(gpu::Node *node, const char *name, float endTime,
+                                    float distance) {
+    gpu::Animation animation{};
+    animation.name = name;
+    animation.endTime = endTime;
+    animation.times = {0.0f, endTime};
+    animation.values = {{0.0f, 0.0f, 0.0f, 0.0f}, {distance, 0.0f, 0.0f, 0.0f}};
+    animation.tracks = {linearTrack(node, gpu::Animation::CH_TRANSLATION, 0, 2)};
+    return animation;
+}
+
+/// @brief A skinned node with one joint, walking it one unit per second along x. Like in glTF the
+/// skinned mesh is on a child of the node holding the skin.
+struct Walker {
+    gpu::Node root{};
+    gpu::Node joint{};
+    gpu::Node body{};
+    gpu::Primitive primitives[2]{};
+    gpu::Material material{};
+    gpu::Mesh mesh{};
+    library::Skin librarySkin;
+    gpu::Skin skin{};
+    gpu::Animation walk{};
+    gpu::Animation wave{};
+
+    Walker() {
+        root.translation = glm::vec3{10.0f, 0.0f, 0.0f};
+        root.children.push_back(&joint);
+        joint.setParent(&root);
+        joint.translation = glm::vec3{0.0f, 3.0f, 0.0f};
+        root.children.push_back(&body);
+        body.setParent(&root);
+        body.translation = glm::vec3{0.0f, 0.0f, 2.0f};
+        mesh.primitives = {{&primitives[0], &material}, {&primitives[1], &material}};
+        body.mesh = &mesh;
+        librarySkin.inverseBindMatrices = {glm::mat4{1.0f}};
+        skin.librarySkin = &librarySkin;
+        skin.joints = {&joint};
+        root.skin = &skin;
+
+        walk = walkAnimation(&joint, "Walk", 1.0f, 1.0f);
+        walk.looping = true;
+        wave = walkAnimation(&joint, "Wave", 0.3f, 1.0f);
+        skin.addAnimation(&walk);
+        skin.addAnimation(&wave);
+    }
+};
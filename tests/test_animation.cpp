@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "animation_fixtures.h"
+
+#include <cmath>
+
+// one node, a translation track with three keys and a rotation track with two
+struct Clip {
+    gpu::Node node{};
+    gpu::Animation animation{};
+
+    Clip() {
+        animation.times = {0.0f, 1.0f, 2.0f, 0.0f, 2.0f};
+        animation.values = {{0.0f, 0.0f, 0.0f, 0.0f},
+                            {2.0f, 0.0f, 0.0f, 0.0f},
+                            {2.0f, 4.0f, 0.0f, 0.0f},
+                            {0.0f, 0.0f, 0.0f, 1.0f},
+                            {0.0f, std::sqrt(0.5f), 0.0f, std::sqrt(0.5f)}};
+        animation.tracks = {linearTrack(&node, gpu::Animation::CH_TRANSLATION, 0, 3),
+                            linearTrack(&node, gpu::Animation::CH_ROTATION, 3, 2)};
+    }
+};
+
+TEST(TestAnimation, FindKey) {
+    const float times[] = {0.0f, 0.5f, 1.0f, 1.5f, 2.0f};
+    EXPECT_EQ(gpu::findKey(times, 5, -1.0f, 0), 0);
+    EXPECT_EQ(gpu::findKey(times, 5, 0.7f, 0), 1);
+    EXPECT_EQ(gpu::findKey(times, 5, 0.7f, 1), 1);
+    EXPECT_EQ(gpu::findKey(times, 5, 1.2f, 1), 2);
+    EXPECT_EQ(gpu::findKey(times, 5, 1.7f, 4), 3);
+    EXPECT_EQ(gpu::findKey(times, 5, 1.5f, 0), 3);
+    EXPECT_EQ(gpu::findKey(times, 5, 3.0f, 2), 4);
+}
+
+TEST(TestAnimation, InterpolatesBetweenKeys) {
+    Clip clip;
+    gpu::Track &translation = clip.animation.tracks[0];
+    glm::vec4 value = gpu::sampleTrack(clip.animation, translation, 1.5f);
+    EXPECT_FLOAT_EQ(value.x, 2.0f);
+    EXPECT_FLOAT_EQ(value.y, 2.0f);
+    EXPECT_EQ(translation.cursor, 1);
+    EXPECT_FLOAT_EQ(gpu::sampleTrack(clip.animation, translation, -1.0f).x, 0.0f);
+    EXPECT_FLOAT_EQ(gpu::sampleTrack(clip.animation, translation, 5.0f).y, 4.0f);
+
+    translation.interpolation = library::Sampler::STEP;
+    EXPECT_FLOAT_EQ(gpu::sampleTrack(clip.animation, translation, 1.9f).y, 0.0f);
+
+    // halfway between identity and a quarter turn about y is an eighth turn
+    value = gpu::sampleTrack(clip.animation, clip.animation.tracks[1], 1.0f);
+    EXPECT_NEAR(value.y, std::sin(glm::radians(22.5f)), 1e-5f);
+    EXPECT_NEAR(value.w, std::cos(glm::radians(22.5f)), 1e-5f);
+}
+
+TEST(TestAnimation, SampleIsIndependentOfHistory) {
+    Clip a;
+    Clip b;
+    for (float t : {0.1f, 0.4f, 1.9f, 0.2f}) {
+        a.animation.sample(t);
+    }
+    a.animation.sample(0.75f);
+    b.animation.sample(0.75f);
+    EXPECT_EQ(glm::vec3{a.node.translation.data()}, glm::vec3{b.node.translation.data()});
+    EXPECT_FLOAT_EQ(glm::vec3{b.node.translation.data()}.x, 1.5f);
+    EXPECT_EQ(glm::quat{a.node.rotation.data()}, glm::quat{b.node.rotation.data()});
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include "animation_fixtures.h"
+
+TEST(TestAnimBake, BakesEveryFrameOfEveryClip) {
+    Walker walker;
+    gpu::AnimationBake bake{};
+    ASSERT_TRUE(gpu::bakeAnimations(bake, &walker.root, 4.0f));
+    EXPECT_EQ(bake.boneCount, 1);
+    ASSERT_EQ(bake.clips.size(), 2);
+    EXPECT_EQ(bake.clips[0].firstFrame, 0);
+    EXPECT_EQ(bake.clips[0].frameCount, 5);
+    EXPECT_FLOAT_EQ(bake.clips[0].frameRate, 4.0f);
+    EXPECT_TRUE(bake.clips[0].looping);
+    // 0.3 seconds take two intervals, spread so that the last frame is the last key
+    EXPECT_EQ(bake.clips[1].firstFrame, 5);
+    EXPECT_EQ(bake.clips[1].frameCount, 3);
+    EXPECT_FLOAT_EQ(bake.clips[1].frameRate, 2.0f / 0.3f);
+    EXPECT_FALSE(bake.clips[1].looping);
+    EXPECT_EQ(bake.palettes.size(), 8);
+    EXPECT_EQ(bake.findClip("Wave"), 1);
+    EXPECT_EQ(bake.findClip("Run"), -1);
+
+    // bones are relative to the skinned node
+    EXPECT_FLOAT_EQ(bake.palettes[2][3].x, 0.5f);
+    EXPECT_FLOAT_EQ(bake.palettes[4][3].x, 1.0f);
+    EXPECT_FLOAT_EQ(bake.palettes[6][3].x, 0.5f);
+}
+
+TEST(TestAnimBake, RestoresThePose) {
+    Walker walker;
+    gpu::AnimationBake bake{};
+    ASSERT_TRUE(gpu::bakeAnimations(bake, &walker.root, 4.0f));
+    EXPECT_EQ(walker.joint.translation.data(), (glm::vec3{0.0f, 3.0f, 0.0f}));
+    EXPECT_FLOAT_EQ(walker.joint.model()[3].x, 10.0f);
+    EXPECT_FLOAT_EQ(walker.joint.model()[3].y, 3.0f);
+}
+
+TEST(TestAnimBake, RefusesMoreFramesThanATextureHolds) {
+    Walker walker;
+    gpu::AnimationBake bake{};
+    // 1.3 seconds of clips take 2602 frames at 2000 per second, 1302 at 1000
+    EXPECT_FALSE(gpu::bakeAnimations(bake, &walker.root, 2000.0f));
+    EXPECT_TRUE(bake.clips.empty());
+    EXPECT_TRUE(bake.palettes.empty());
+    EXPECT_TRUE(gpu::bakeAnimations(bake, &walker.root, 1000.0f));
+    EXPECT_EQ(bake.palettes.size(), 1302);
+}
+
+TEST(TestAnimBake, CollectsMeshesBelowTheSkinnedNode) {
+    Walker walker;
+    gpu::AnimationBake bake{};
+    ASSERT_TRUE(gpu::bakeAnimations(bake, &walker.root, 4.0f));
+    ASSERT_EQ(bake.meshes.size(), 1);
+    EXPECT_EQ(bake.meshes[0].mesh, &walker.mesh);
+    // relative to the skinned node, its own translation is left to the instances
+    EXPECT_EQ(glm::vec3{bake.meshes[0].transform[3]}, (glm::vec3{0.0f, 0.0f, 2.0f}));
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "animation_fixtures.h"
+#include "gpu_animcompress.h"
+
+#include <cmath>
+
+static float _angle(const glm::vec4 &a, const glm::vec4 &b) {
+    const glm::quat qa{a.w, a.x, a.y, a.z};
+    const glm::quat qb{b.w, b.x, b.y, b.z};
+    return 2.0f * std::acos(std::min(std::abs(glm::dot(qa, qb)), 1.0f));
+}
+
+TEST(TestAnimCompress, RotationRoundTrip) {
+    const glm::quat rotations[] = {
+        glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+        glm::angleAxis(glm::radians(90.0f), glm::vec3{0.0f, 1.0f, 0.0f}),
+        glm::angleAxis(glm::radians(-170.0f), glm::normalize(glm::vec3{1.0f, 2.0f, -3.0f})),
+        -glm::angleAxis(glm::radians(45.0f), glm::vec3{1.0f, 0.0f, 0.0f}),
+    };
+    for (const glm::quat &q : rotations) {
+        uint16_t packed[3];
+        gpu::packRotation(q, packed);
+        EXPECT_LT(_angle({q.x, q.y, q.z, q.w}, gpu::unpackRotation(packed)), 1e-3f);
+    }
+}
+
+TEST(TestAnimCompress, DropsReconstructibleKeys) {
+    gpu::Node node{};
+    gpu::Animation animation{};
+    // a straight walk, a constant scale and a rotation that turns at a steady rate
+    for (int i{0}; i <= 10; ++i) {
+        animation.times.push_back(i * 0.1f);
+        animation.values.emplace_back(i * 0.5f, 1.0f, -i * 0.25f, 0.0f);
+    }
+    for (int i{0}; i <= 10; ++i) {
+        animation.times.push_back(i * 0.1f);
+        animation.values.emplace_back(2.0f, 2.0f, 2.0f, 0.0f);
+    }
+    for (int i{0}; i <= 10; ++i) {
+        const glm::quat q = glm::angleAxis(glm::radians(i * 9.0f), glm::vec3{0.0f, 1.0f, 0.0f});
+        animation.times.push_back(i * 0.1f);
+        animation.values.emplace_back(q.x, q.y, q.z, q.w);
+    }
+    animation.tracks = {linearTrack(&node, gpu::Animation::CH_TRANSLATION, 0, 11),
+                        linearTrack(&node, gpu::Animation::CH_SCALE, 11, 11),
+                        linearTrack(&node, gpu::Animation::CH_ROTATION, 22, 11)};
+    gpu::Animation raw = animation;
+
+    gpu::compressAnimation(animation);
+    EXPECT_EQ(animation.tracks[0].count, 2);
+    EXPECT_EQ(animation.tracks[1].count, 1);
+    EXPECT_EQ(animation.tracks[2].count, 2);
+    EXPECT_TRUE(animation.values.empty());
+    EXPECT_LT(gpu::animationBytes(animation), gpu::animationBytes(raw) / 4);
+
+    for (float t : {0.0f, 0.15f, 0.5f, 0.73f, 1.0f}) {
+        for (size_t i{0}; i < 3; ++i) {
+            const glm::vec4 expected = gpu::sampleTrack(raw, raw.tracks[i], t);
+            const glm::vec4 actual = gpu::sampleTrack(animation, animation.tracks[i], t);
+            if (i == 2) {
+                EXPECT_LT(_angle(expected, actual), 0.003f);
+            } else {
+                EXPECT_LT(glm::length(glm::vec3{expected} - glm::vec3{actual}), 0.002f);
+            }
+        }
+    }
+}
+
+TEST(TestAnimCompress, KeepsKeysOutsideTheError) {
+    gpu::Node node{};
+    gpu::Animation animation{};
+    animation.times = {0.0f, 1.0f, 2.0f, 3.0f};
+    // the second key is off the line by less than the error, the third turns a corner
+    animation.values = {{0.0f, 0.0f, 0.0f, 0.0f},
+                        {1.0f, 0.0f, 0.0f, 0.0f},
+                        {2.0f, 0.005f, 0.0f, 0.0f},
+                        {3.0f, 1.0f, 0.0f, 0.0f}};
+    animation.tracks = {linearTrack(&node, gpu::Animation::CH_TRANSLATION, 0, 4)};
+    gpu::AnimationCompression settings;
+    settings.translationError = 0.01f;
+    gpu::compressAnimation(animation, settings);
+    ASSERT_EQ(animation.tracks[0].count, 3);
+    EXPECT_FLOAT_EQ(animation.times[1], 2.0f);
+    EXPECT_FLOAT_EQ(animation.times[2], 3.0f);
+}
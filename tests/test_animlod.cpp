@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "animation_fixtures.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+TEST(TestAnimLod, SignificanceIsScreenSize) {
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    const glm::mat4 view{1.0f};
+    EXPECT_NEAR(gpu::animationSignificance(projection, view, {0.0f, 0.0f, -10.0f}, 1.0f), 0.1f,
+                1e-5f);
+    EXPECT_NEAR(gpu::animationSignificance(projection, view, {0.0f, 0.0f, -20.0f}, 1.0f), 0.05f,
+                1e-5f);
+    // behind the camera and beside the view
+    EXPECT_EQ(gpu::animationSignificance(projection, view, {0.0f, 0.0f, 10.0f}, 1.0f), 0.0f);
+    EXPECT_EQ(gpu::animationSignificance(projection, view, {-20.0f, 0.0f, -10.0f}, 1.0f), 0.0f);
+    // partly inside
+    EXPECT_GT(gpu::animationSignificance(projection, view, {-10.5f, 0.0f, -10.0f}, 1.0f), 0.0f);
+}
+
+TEST(TestAnimLod, RatesFitTheBudget) {
+    const float significance[] = {0.5f, 0.1f, 0.03f, 0.001f, 0.0f};
+    gpu::AnimationRate rates[5];
+    gpu::AnimationLodSettings settings;
+    gpu::assignAnimationRates(significance, 5, settings, rates);
+    EXPECT_EQ(rates[0], gpu::RATE_EVERY_TICK);
+    EXPECT_EQ(rates[1], gpu::RATE_EVERY_2ND);
+    EXPECT_EQ(rates[2], gpu::RATE_EVERY_4TH);
+    EXPECT_EQ(rates[3], gpu::RATE_PAUSED);
+    EXPECT_EQ(rates[4], gpu::RATE_PAUSED);
+
+    settings.hiddenRate = gpu::RATE_EVERY_4TH;
+    settings.budget = 1.0f;
+    gpu::assignAnimationRates(significance, 5, settings, rates);
+    EXPECT_EQ(rates[0], gpu::RATE_EVERY_2ND);
+    EXPECT_EQ(rates[1], gpu::RATE_EVERY_4TH);
+    EXPECT_EQ(rates[2], gpu::RATE_PAUSED);
+    EXPECT_EQ(rates[3], gpu::RATE_PAUSED);
+    EXPECT_EQ(rates[4], gpu::RATE_PAUSED);
+}
+
+TEST(TestAnimLod, SkinsAreSampledAheadEveryIntervalTicks) {
+    gpu::Node node{};
+    gpu::Animation walk = walkAnimation(&node, "Walk", 10.0f, 10.0f);
+    gpu::Skin skin{};
+    skin.addAnimation(&walk);
+    skin.playback = gpu::createPlayback(&walk, &skin);
+    skin.updateInterval = 4;
+
+    uint32_t samples{0};
+    for (int i{0}; i < 8; ++i) {
+        const float time = skin.playback->time;
+        gpu::animate(0.25f);
+        if (skin.sampled) {
+            ++samples;
+            skin.sampled = false;
+            EXPECT_EQ(skin.ticksSinceSample, 0);
+            // posed for the last tick before the next sample
+            EXPECT_FLOAT_EQ(node.translation.x, time + 0.75f);
+        }
+    }
+    EXPECT_EQ(samples, 2);
+    EXPECT_FLOAT_EQ(skin.playback->time, 2.0f);
+
+    // paused skins keep their pose while time goes on
+    skin.updateInterval = 0;
+    const float x = node.translation.x;
+    gpu::animate(0.25f);
+    EXPECT_FALSE(skin.sampled);
+    EXPECT_EQ(node.translation.x, x);
+    EXPECT_FLOAT_EQ(skin.playback->time, 2.25f);
+    gpu::freePlayback(skin.playback);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "gpu.h"
+
+struct Layout {
+    library::Accessor position{nullptr, GL_FLOAT, 3, library::Accessor::VEC3};
+    library::Accessor uv{nullptr, GL_FLOAT, 3, library::Accessor::VEC2};
+    library::Accessor joints{nullptr, GL_UNSIGNED_BYTE, 3, library::Accessor::VEC4};
+    library::Accessor index{nullptr, GL_UNSIGNED_SHORT, 3, library::Accessor::SCALAR};
+    library::Primitive primitive{};
+
+    Layout() {
+        primitive.attributes[library::Primitive::POSITION] = &position;
+        primitive.attributes[library::Primitive::TEXCOORD_0] = &uv;
+        primitive.indices = &index;
+    }
+};
+
+TEST(TestArena, VertexFormatFollowsTheAttributes) {
+    Layout a;
+    Layout b;
+    const gpu::VertexFormat format = gpu::VertexFormat_of(a.primitive);
+    EXPECT_EQ(format.sizes[library::Primitive::POSITION], 3);
+    EXPECT_EQ(format.attributeSize(library::Primitive::POSITION), 12u);
+    EXPECT_EQ(format.attributeSize(library::Primitive::TEXCOORD_0), 8u);
+    EXPECT_EQ(format.sizes[library::Primitive::NORMAL], 0);
+    EXPECT_EQ(format.attributeSize(library::Primitive::NORMAL), 0u);
+    EXPECT_EQ(format, gpu::VertexFormat_of(b.primitive));
+
+    // primitives share an arena only with the same attributes in the same types
+    b.primitive.attributes[library::Primitive::JOINTS_0] = &b.joints;
+    EXPECT_NE(format, gpu::VertexFormat_of(b.primitive));
+    EXPECT_EQ(gpu::VertexFormat_of(b.primitive).attributeSize(library::Primitive::JOINTS_0), 4u);
+}
+
+TEST(TestArena, FitsUntilFull) {
+    gpu::GeometryArena arena{};
+    EXPECT_TRUE(arena.fits(BYTESIZED_GEOMETRYARENA_VERTICES, BYTESIZED_GEOMETRYARENA_INDICES));
+    arena.vertexCount = BYTESIZED_GEOMETRYARENA_VERTICES - 3;
+    EXPECT_TRUE(arena.fits(3, 3));
+    EXPECT_FALSE(arena.fits(4, 3));
+    arena.indexCount = BYTESIZED_GEOMETRYARENA_INDICES;
+    EXPECT_FALSE(arena.fits(0, 1));
+}
+
+TEST(TestArena, RefusesWhatNoArenaHolds) {
+    Layout layout;
+    gpu::Primitive primitive{};
+    layout.position.count = BYTESIZED_GEOMETRYARENA_VERTICES + 1;
+    EXPECT_FALSE(gpu::arenaAllocate(layout.primitive, primitive));
+    layout.position.count = 3;
+    layout.index.count = BYTESIZED_GEOMETRYARENA_INDICES + 1;
+    EXPECT_FALSE(gpu::arenaAllocate(layout.primitive, primitive));
+    // without indices there is nothing to draw from an arena
+    layout.index.count = 3;
+    layout.primitive.indices = nullptr;
+    EXPECT_FALSE(gpu::arenaAllocate(layout.primitive, primitive));
+    EXPECT_EQ(primitive.arena, nullptr);
+}
+
+TEST(TestArena, SpaceIsReclaimedWithTheLastPrimitive) {
+    gpu::GeometryArena arena{};
+    arena.vertexCount = 6;
+    arena.indexCount = 6;
+    arena.primitiveCount = 2;
+    gpu::Primitive primitives[2]{};
+    primitives[0].arena = &arena;
+    primitives[1].arena = &arena;
+
+    gpu::arenaFree(primitives[0]);
+    EXPECT_EQ(primitives[0].arena, nullptr);
+    EXPECT_EQ(arena.vertexCount, 6u);
+    gpu::arenaFree(primitives[1]);
+    EXPECT_EQ(arena.primitiveCount, 0u);
+    EXPECT_EQ(arena.vertexCount, 0u);
+    EXPECT_EQ(arena.indexCount, 0u);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "gpu.h"
+#include "jobs.h"
+
+#include <list>
+
+static constexpr size_t GRAIN = 16;
+
+struct Scene {
+    gpu::Material materials[3]{};
+    gpu::Primitive primitives[4]{};
+    gpu::GeometryArena arena{};
+    std::list<gpu::Mesh> meshes;
+    std::list<gpu::Node> nodes;
+    std::vector<gpu::Node *> roots;
+
+    explicit Scene(size_t count) {
+        // ids run against the addresses, the sort must follow the ids
+        for (uint32_t i{0}; i < 3; ++i) {
+            materials[i].id = 2 - i;
+        }
+        arena.id = 0;
+        primitives[2].arena = &arena;
+        primitives[3].arena = &arena;
+        for (size_t i{0}; i < count; ++i) {
+            gpu::Mesh &mesh = meshes.emplace_back();
+            mesh.primitives = {{&primitives[i % 4], &materials[i % 3]},
+                               {&primitives[(i + 1) % 4], &materials[(i + 2) % 3]}};
+            gpu::Node &root = nodes.emplace_back();
+            root.mesh = &mesh;
+            root.translation = glm::vec3{static_cast<float>(i), 0.0f, 0.0f};
+            gpu::Node &child = nodes.emplace_back();
+            child.mesh = &mesh;
+            child.hidden = i % 5 == 0;
+            child.translation = glm::vec3{0.0f, 1.0f, 0.0f};
+            child.setParent(&root);
+            root.children.push_back(&child);
+            roots.push_back(&root);
+        }
+    }
+};
+
+static void _record(std::vector<gpu::Node *> &roots, std::vector<gpu::CommandBuffer> &buffers) {
+    buffers.resize((roots.size() + GRAIN - 1) / GRAIN);
+    jobs::parallelFor(roots.size(), GRAIN, [&](size_t begin, size_t end) {
+        gpu::CommandBuffer &buffer = buffers[begin / GRAIN];
+        buffer.clear();
+        for (size_t i{begin}; i < end; ++i) {
+            roots[i]->record(buffer);
+        }
+    });
+}
+
+TEST(TestCommands, RecordNode) {
+    Scene scene{1};
+    gpu::CommandBuffer buffer;
+    scene.roots[0]->record(buffer);
+    // the hidden child is skipped, the root records both of its primitives
+    ASSERT_EQ(buffer.draws.size(), 2);
+    EXPECT_EQ(buffer.draws[0].node, scene.roots[0]);
+    EXPECT_EQ(buffer.draws[0].primitive, &scene.primitives[0]);
+    EXPECT_EQ(buffer.draws[1].material, &scene.materials[2]);
+
+    Scene moved{2};
+    buffer.clear();
+    moved.roots[1]->record(buffer);
+    ASSERT_EQ(buffer.draws.size(), 4);
+    EXPECT_EQ(buffer.draws[0].node, moved.roots[1]->children[0]);
+    EXPECT_FLOAT_EQ(buffer.draws[0].model[3][0], 1.0f);
+    EXPECT_FLOAT_EQ(buffer.draws[0].model[3][1], 1.0f);
+}
+
+TEST(TestCommands, MergeSortsByMaterial) {
+    Scene scene{40};
+    std::vector<gpu::CommandBuffer> buffers;
+    std::vector<gpu::DrawCommand> commands;
+    _record(scene.roots, buffers);
+    gpu::mergeCommands(buffers, commands);
+    EXPECT_EQ(commands.size(), 40 * 2 + 32 * 2);
+
+    size_t materialChanges{0};
+    for (size_t i{1}; i < commands.size(); ++i) {
+        const gpu::DrawCommand &a = commands[i - 1];
+        const gpu::DrawCommand &b = commands[i];
+        EXPECT_LE(a.material->id, b.material->id);
+        if (a.material == b.material) {
+            EXPECT_LE(a.primitive->arena != nullptr, b.primitive->arena != nullptr);
+        } else {
+            ++materialChanges;
+        }
+    }
+    EXPECT_EQ(materialChanges, 2);
+}
+
+TEST(TestCommands, MergeKeepsBlendedCommandsLastInRecordedOrder) {
+    Scene scene{40};
+    scene.materials[1].color = Color{1.0f, 1.0f, 1.0f, 0.5f};
+    std::vector<gpu::CommandBuffer> buffers;
+    std::vector<gpu::DrawCommand> commands;
+    _record(scene.roots, buffers);
+    gpu::mergeCommands(buffers, commands);
+
+    std::vector<gpu::DrawCommand> recorded;
+    for (const auto &buffer : buffers) {
+        for (const auto &draw : buffer.draws) {
+            if (draw.material == &scene.materials[1]) {
+                recorded.push_back(draw);
+            }
+        }
+    }
+    ASSERT_EQ(commands.size(), 40 * 2 + 32 * 2);
+    const size_t opaque = commands.size() - recorded.size();
+    for (size_t i{0}; i < commands.size(); ++i) {
+        if (i < opaque) {
+            EXPECT_NE(commands[i].material, &scene.materials[1]);
+        } else {
+            EXPECT_EQ(commands[i].node, recorded[i - opaque].node);
+            EXPECT_EQ(commands[i].primitive, recorded[i - opaque].primitive);
+        }
+    }
+}
+
+TEST(TestCommands, ParallelMatchesSerial) {
+    Scene scene{1000};
+    std::vector<gpu::CommandBuffer> buffers;
+    std::vector<gpu::DrawCommand> serial;
+    std::vector<gpu::DrawCommand> parallel;
+    _record(scene.roots, buffers);
+    gpu::mergeCommands(buffers, serial);
+
+    for (auto &node : scene.nodes) {
+        node.invalidate();
+    }
+    jobs::start(4);
+    _record(scene.roots, buffers);
+    gpu::mergeCommands(buffers, parallel);
+    jobs::stop();
+
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i{0}; i < serial.size(); ++i) {
+        EXPECT_EQ(parallel[i].node, serial[i].node);
+        EXPECT_EQ(parallel[i].primitive, serial[i].primitive);
+        EXPECT_EQ(parallel[i].material, serial[i].material);
+        EXPECT_EQ(parallel[i].model, serial[i].model);
+    }
+}
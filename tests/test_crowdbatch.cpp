@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "animation_fixtures.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+TEST(TestCrowdBatch, CollectsOneDrawPerBakeAndPrimitive) {
+    Walker first;
+    Walker second;
+    gpu::AnimationBake bakes[2]{};
+    ASSERT_TRUE(gpu::bakeAnimations(bakes[0], &first.root, 4.0f));
+    ASSERT_TRUE(gpu::bakeAnimations(bakes[1], &second.root, 4.0f));
+
+    gpu::CrowdBatch batch;
+    const glm::mat4 model = glm::translate(glm::mat4{1.0f}, glm::vec3{5.0f, 0.0f, 0.0f});
+    batch.add(&bakes[1], model, 0);
+    batch.add(&bakes[0], model, 1, 0.5f, 2.0f);
+    batch.add(&bakes[1], model, 1);
+    batch.add(&bakes[0], model, 0);
+    std::vector<gpu::CrowdDraw> draws;
+    batch.collect(draws);
+
+    // instances of a bake are drawn together, in the order they were added
+    const auto &sorted = batch.sorted();
+    ASSERT_EQ(sorted.size(), 4);
+    EXPECT_EQ(sorted[0].clip, (glm::vec4{5.0f, 3.0f, 2.0f / 0.3f, 0.0f}));
+    EXPECT_EQ(sorted[0].timing, (glm::vec2{0.5f, 2.0f}));
+    EXPECT_EQ(sorted[1].clip, (glm::vec4{0.0f, 5.0f, 4.0f, 1.0f}));
+    EXPECT_EQ(sorted[2].clip, (glm::vec4{0.0f, 5.0f, 4.0f, 1.0f}));
+    EXPECT_EQ(sorted[3].model, model);
+
+    // both primitives of the mesh on the child node, placed relative to the skinned node
+    ASSERT_EQ(draws.size(), 4);
+    for (size_t i{0}; i < draws.size(); ++i) {
+        const size_t b = i / 2;
+        EXPECT_EQ(draws[i].bake, &bakes[b]);
+        EXPECT_EQ(draws[i].first, b * 2);
+        EXPECT_EQ(draws[i].count, 2);
+        EXPECT_EQ(draws[i].primitive, &(b == 0 ? first : second).primitives[i % 2]);
+        EXPECT_EQ(draws[i].transform, &bakes[b].meshes[0].transform);
+        EXPECT_FLOAT_EQ((*draws[i].transform)[3].z, 2.0f);
+    }
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "jobs.h"
+
+#include <atomic>
+#include <thread>
+
+TEST(TestJobs, ParallelFor) {
+    jobs::start(4);
+    EXPECT_EQ(jobs::workerCount(), 4u);
+    std::atomic<size_t> sum{0};
+    for (int i{0}; i < 10; ++i) {
+        jobs::parallelFor(1000, 7, [&sum](size_t begin, size_t end) {
+            for (size_t j{begin}; j < end; ++j) {
+                sum += j;
+            }
+        });
+    }
+    jobs::stop();
+    EXPECT_EQ(jobs::workerCount(), 0u);
+    EXPECT_EQ(sum, 10u * 999u * 1000u / 2u);
+}
+
+TEST(TestJobs, Submit) {
+    std::atomic<int> done{0};
+    jobs::submit([&done] { ++done; });
+    EXPECT_EQ(done, 1);
+    jobs::start(2);
+    for (int i{0}; i < 20; ++i) {
+        jobs::submit([&done] { ++done; });
+    }
+    jobs::parallelFor(100, 1, [](size_t, size_t) {});
+    while (done < 21) {
+        std::this_thread::yield();
+    }
+    jobs::stop();
+    EXPECT_EQ(done, 21);
+}
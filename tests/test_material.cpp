@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "gpu.h"
+
+static uint32_t _textureChanges() {
+    return gpu::Stats_lastFrame().stateChanges[static_cast<size_t>(gpu::StateChange::TEXTURE)];
+}
+
+TEST(TestMaterial, IdsAndSlots) {
+    gpu::Texture *texture = gpu::createTexture(nullptr, 1, 1, gpu::ChannelSetting::RGBA,
+                                               GL_UNSIGNED_BYTE);
+    gpu::Material *a = gpu::createMaterial(texture);
+    gpu::Material *b = gpu::createMaterial(texture);
+    EXPECT_NE(a->id, b->id);
+    EXPECT_LT(a->id, BYTESIZED_MATERIAL_COUNT);
+    EXPECT_EQ(a->textures[0], texture);
+    EXPECT_EQ(a->textures[1], nullptr);
+    EXPECT_EQ(gpu::textureRefs(texture), 3);
+
+    gpu::freeMaterial(a);
+    gpu::freeMaterial(b);
+    EXPECT_EQ(gpu::textureRefs(texture), 1);
+    gpu::freeTexture(texture);
+}
+
+TEST(TestMaterial, RedundantTextureBindsAreSkipped) {
+    gpu::Texture first{1};
+    gpu::Texture second{2};
+    gpu::Texture_resetBindings();
+    gpu::Stats_beginFrame();
+    first.bind();
+    first.bind();
+    second.bind();
+    first.bind();
+    first.bind();
+    gpu::Stats_endFrame();
+    EXPECT_EQ(_textureChanges(), 3);
+
+    gpu::Texture_resetBindings();
+    gpu::Stats_beginFrame();
+    first.bind();
+    gpu::Stats_endFrame();
+    EXPECT_EQ(_textureChanges(), 1);
+    gpu::Texture_resetBindings();
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include "jobs.h"
+#include "occlusion.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+struct TestOcclusion : public testing::Test {
+    void SetUp() override {
+        // camera at origin looking down -z
+        viewProjection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+        occlusion::begin(viewProjection);
+    }
+
+    void addWall(float z, float halfSize) {
+        const glm::vec3 positions[] = {
+            {-halfSize, -halfSize, z},
+            {halfSize, -halfSize, z},
+            {halfSize, halfSize, z},
+            {-halfSize, halfSize, z},
+        };
+        const uint16_t indices[] = {0, 1, 2, 0, 2, 3};
+        occlusion::addOccluder(glm::mat4{1.0f}, positions, 4, indices, 6);
+    }
+
+    glm::mat4 viewProjection;
+};
+
+TEST_F(TestOcclusion, EmptyDepthBuffer) {
+    occlusion::rasterize();
+    EXPECT_FLOAT_EQ(occlusion::depth(0, 0), 1.0f);
+    EXPECT_TRUE(occlusion::isVisible({-1.0f, -1.0f, -11.0f}, {1.0f, 1.0f, -9.0f}));
+    // outside of the view
+    EXPECT_FALSE(occlusion::isVisible({-1.0f, -1.0f, 9.0f}, {1.0f, 1.0f, 11.0f}));
+    EXPECT_FALSE(occlusion::isVisible({99.0f, -1.0f, -11.0f}, {101.0f, 1.0f, -9.0f}));
+    // crossing the near plane
+    EXPECT_TRUE(occlusion::isVisible({-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}));
+}
+
+TEST_F(TestOcclusion, WallOccludesBoxBehind) {
+    addWall(-5.0f, 20.0f);
+    occlusion::rasterize();
+    EXPECT_EQ(occlusion::stats().occluders, 1u);
+    EXPECT_EQ(occlusion::stats().rasterized, 2u);
+    EXPECT_LT(occlusion::depth(occlusion::DEPTH_WIDTH / 2, occlusion::DEPTH_HEIGHT / 2), 1.0f);
+    EXPECT_LT(occlusion::hierarchicalDepth(occlusion::levels() - 1, 0, 0), 1.0f);
+
+    EXPECT_FALSE(occlusion::isVisible({-1.0f, -1.0f, -11.0f}, {1.0f, 1.0f, -9.0f}));
+    EXPECT_TRUE(occlusion::isVisible({-1.0f, -1.0f, -4.0f}, {1.0f, 1.0f, -3.0f}));
+    // straddling the wall
+    EXPECT_TRUE(occlusion::isVisible({-1.0f, -1.0f, -6.0f}, {1.0f, 1.0f, -4.0f}));
+}
+
+TEST_F(TestOcclusion, PartialOccluder) {
+    addWall(-5.0f, 1.0f);
+    occlusion::rasterize();
+    EXPECT_FALSE(occlusion::isVisible({-0.5f, -0.5f, -11.0f}, {0.5f, 0.5f, -10.0f}));
+    EXPECT_TRUE(occlusion::isVisible({-4.0f, -0.5f, -11.0f}, {-3.0f, 0.5f, -10.0f}));
+    EXPECT_TRUE(occlusion::isVisible({-8.0f, -8.0f, -11.0f}, {8.0f, 8.0f, -10.0f}));
+}
+
+TEST_F(TestOcclusion, BoxOccluderWithWorkers) {
+    jobs::start(3);
+    occlusion::addOccluderBox(glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 0.0f, -6.0f}),
+                              glm::vec3{-5.0f, -5.0f, -1.0f}, glm::vec3{5.0f, 5.0f, 1.0f});
+    occlusion::rasterize();
+    occlusion::Bounds bounds[] = {
+        {{-1.0f, -1.0f, -20.0f}, {1.0f, 1.0f, -18.0f}},
+        {{-1.0f, -1.0f, -3.0f}, {1.0f, 1.0f, -2.0f}},
+        {{-16.0f, -1.0f, -20.0f}, {-14.0f, 1.0f, -18.0f}},
+    };
+    uint8_t visible[3];
+    occlusion::testVisibility(bounds, 3, visible);
+    jobs::stop();
+    EXPECT_FALSE(visible[0]);
+    EXPECT_TRUE(visible[1]);
+    EXPECT_TRUE(visible[2]);
+    EXPECT_EQ(occlusion::stats().tested, 3u);
+    EXPECT_EQ(occlusion::stats().culled, 1u);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "picking.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+static uint32_t _createCube() {
+    static const glm::vec3 corners[] = {
+        {-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f},
+        {-0.5f, -0.5f, 0.5f},  {0.5f, -0.5f, 0.5f},  {0.5f, 0.5f, 0.5f},  {-0.5f, 0.5f, 0.5f},
+    };
+    static const uint16_t indices[] = {
+        0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+        3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5,
+    };
+    return picking::createMesh(corners, 8, indices, sizeof(indices) / sizeof(indices[0]));
+}
+
+class TestPicking : public ::testing::Test {
+  protected:
+    void SetUp() override { cube = _createCube(); }
+    void TearDown() override { picking::dispose(); }
+
+    uint32_t cube;
+};
+
+TEST_F(TestPicking, ClosestHit) {
+    picking::begin();
+    picking::addInstance(0, cube, glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 0.0f, -10.0f}));
+    picking::addInstance(1, cube, glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 0.0f, -5.0f}));
+    picking::addInstance(2, cube, glm::translate(glm::mat4{1.0f}, glm::vec3{3.0f, 0.0f, -5.0f}));
+    picking::build();
+
+    picking::Hit hit;
+    ASSERT_TRUE(picking::raycast({glm::vec3{0.0f}, glm::vec3{0.0f, 0.0f, -1.0f}}, hit));
+    EXPECT_EQ(hit.object, 1);
+    EXPECT_NEAR(hit.distance, 4.5f, 1e-4f);
+
+    ASSERT_TRUE(picking::raycast({glm::vec3{3.0f, 0.2f, 0.0f}, glm::vec3{0.0f, 0.0f, -1.0f}}, hit));
+    EXPECT_EQ(hit.object, 2);
+
+    EXPECT_FALSE(picking::raycast({glm::vec3{0.0f}, glm::vec3{0.0f, 0.0f, 1.0f}}, hit));
+    EXPECT_FALSE(picking::raycast({glm::vec3{1.5f, 0.0f, 0.0f}, glm::vec3{0.0f, 0.0f, -1.0f}}, hit));
+}
+
+TEST_F(TestPicking, ScaledInstance) {
+    picking::begin();
+    picking::addInstance(7, cube,
+                         glm::scale(glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 0.0f, -10.0f}),
+                                    glm::vec3{4.0f}));
+    picking::build();
+
+    picking::Hit hit;
+    ASSERT_TRUE(picking::raycast({glm::vec3{1.5f, 0.0f, 0.0f}, glm::vec3{0.0f, 0.0f, -1.0f}}, hit));
+    EXPECT_EQ(hit.object, 7);
+    EXPECT_NEAR(hit.distance, 8.0f, 1e-4f);
+}
+
+TEST_F(TestPicking, ManyObjects) {
+    picking::begin();
+    for (size_t i{0}; i < 1000; ++i) {
+        const glm::vec3 position{static_cast<float>(i % 40) * 2.0f,
+                                 static_cast<float>(i / 40) * 2.0f, -5.0f};
+        picking::addInstance(i, cube, glm::translate(glm::mat4{1.0f}, position));
+    }
+    picking::build();
+    EXPECT_EQ(picking::instanceCount(), 1000);
+
+    picking::Hit hit;
+    ASSERT_TRUE(picking::raycast({glm::vec3{2.0f * 17, 2.0f * 21, 0.0f},
+                                  glm::vec3{0.0f, 0.0f, -1.0f}},
+                                 hit));
+    EXPECT_EQ(hit.object, 21 * 40 + 17);
+}
+
+TEST_F(TestPicking, ScreenRay) {
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 2.0f, 0.1f, 100.0f);
+    const picking::Ray ray = picking::screenRay(glm::inverse(projection), 400.0f, 200.0f, 800.0f,
+                                                400.0f);
+    EXPECT_NEAR(ray.origin.z, -0.1f, 1e-4f);
+    EXPECT_NEAR(ray.direction.x, 0.0f, 1e-4f);
+    EXPECT_NEAR(ray.direction.y, 0.0f, 1e-4f);
+    EXPECT_NEAR(ray.direction.z, -1.0f, 1e-4f);
+
+    const picking::Ray corner = picking::screenRay(glm::inverse(projection), 0.0f, 0.0f, 800.0f,
+                                                   400.0f);
+    EXPECT_LT(corner.direction.x, 0.0f);
+    EXPECT_GT(corner.direction.y, 0.0f);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include "animation_fixtures.h"
+#include "jobs.h"
+
+#include <cmath>
+#include <list>
+
+static gpu::Pose _pose(uint32_t count, const glm::vec3 &t, const glm::quat &r) {
+    gpu::Pose pose;
+    pose.resize(count);
+    for (uint32_t i{0}; i < count; ++i) {
+        pose.setTranslation(i, t);
+        pose.setRotation(i, r);
+        pose.setScale(i, glm::vec3{1.0f});
+    }
+    return pose;
+}
+
+TEST(TestPose, StreamsArePaddedToFourJoints) {
+    gpu::Pose pose;
+    pose.resize(5);
+    EXPECT_EQ(pose.stride, 8);
+    EXPECT_EQ(pose.data.size(), 8 * gpu::Pose::STREAM_COUNT);
+    pose.setTranslation(4, {1.0f, 2.0f, 3.0f});
+    EXPECT_FLOAT_EQ(pose.stream(gpu::Pose::TY)[4], 2.0f);
+    EXPECT_EQ(pose.translation(4), (glm::vec3{1.0f, 2.0f, 3.0f}));
+}
+
+TEST(TestPose, BlendLerpsVectorsAndNlerpsRotations) {
+    const glm::quat quarter = glm::angleAxis(glm::radians(90.0f), glm::vec3{0.0f, 1.0f, 0.0f});
+    gpu::Pose pose = _pose(6, glm::vec3{0.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f});
+    gpu::Pose other = _pose(6, {2.0f, 4.0f, 0.0f}, quarter);
+    // the same rotation on the other hemisphere takes the short way as well
+    other.setRotation(5, -quarter);
+
+    gpu::Pose_blend(pose, other, 0.5f);
+    const glm::quat eighth = glm::angleAxis(glm::radians(45.0f), glm::vec3{0.0f, 1.0f, 0.0f});
+    for (uint32_t i{0}; i < 6; ++i) {
+        EXPECT_FLOAT_EQ(pose.translation(i).x, 1.0f);
+        EXPECT_FLOAT_EQ(pose.translation(i).y, 2.0f);
+        EXPECT_FLOAT_EQ(pose.scale(i).z, 1.0f);
+        const glm::quat r = pose.rotation(i);
+        EXPECT_NEAR(std::abs(glm::dot(r, eighth)), 1.0f, 1e-6f);
+    }
+}
+
+TEST(TestPose, MaskLayersPerJoint) {
+    gpu::Pose pose = _pose(3, glm::vec3{0.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f});
+    gpu::Pose other = _pose(3, glm::vec3{1.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f});
+    const float mask[4] = {0.0f, 1.0f, 0.5f, 0.0f};
+    gpu::Pose_blend(pose, other, 1.0f, mask);
+    EXPECT_FLOAT_EQ(pose.translation(0).x, 0.0f);
+    EXPECT_FLOAT_EQ(pose.translation(1).x, 1.0f);
+    EXPECT_FLOAT_EQ(pose.translation(2).x, 0.5f);
+}
+
+TEST(TestPose, PlayAnimationCrossfades) {
+    gpu::Node node{};
+    gpu::Animation idle = holdAnimation(&node, "Idle", 0.0f, 1.0f);
+    gpu::Animation run = holdAnimation(&node, "Running", 4.0f, 1.0f);
+
+    gpu::Skin skin{};
+    skin.addAnimation(&idle);
+    skin.addAnimation(&run);
+    ASSERT_EQ(skin.poseNodes, (std::vector<gpu::Node *>{&node}));
+    EXPECT_EQ(run.tracks[0].slot, 0);
+    skin.playback = gpu::createPlayback(&idle, &skin);
+
+    skin.samplePose();
+    skin.commitPose();
+    EXPECT_FLOAT_EQ(node.translation.x, 0.0f);
+
+    skin.playAnimation("Running", 1.0f);
+    EXPECT_EQ(skin.playback->from, &idle);
+    skin.playback->fade = 0.5f;
+    skin.samplePose();
+    skin.commitPose();
+    EXPECT_FLOAT_EQ(node.translation.x, 2.0f);
+
+    // a fade of zero switches at once
+    skin.playAnimation("Idle", 0.0f);
+    EXPECT_EQ(skin.playback->from, nullptr);
+    skin.samplePose();
+    skin.commitPose();
+    EXPECT_FLOAT_EQ(node.translation.x, 0.0f);
+    gpu::freePlayback(skin.playback);
+}
+
+TEST(TestPose, PlayAnimationDuringCrossfadeStartsFromTheBlend) {
+    gpu::Node node{};
+    gpu::Animation idle = holdAnimation(&node, "Idle", 0.0f, 1.0f);
+    gpu::Animation run = holdAnimation(&node, "Running", 4.0f, 1.0f);
+    gpu::Animation jump = holdAnimation(&node, "Jump", 8.0f, 1.0f);
+    gpu::Skin skin{};
+    skin.addAnimation(&idle);
+    skin.addAnimation(&run);
+    skin.addAnimation(&jump);
+    skin.playback = gpu::createPlayback(&idle, &skin);
+
+    skin.playAnimation("Running", 1.0f);
+    skin.playback->fade = 0.5f;
+    skin.playAnimation("Jump", 1.0f);
+    EXPECT_EQ(skin.playback->from, nullptr);
+    EXPECT_TRUE(skin.playback->held);
+    // the half way blend of idle and running is where the jump fades in from
+    skin.samplePose();
+    skin.commitPose();
+    EXPECT_FLOAT_EQ(node.translation.x, 2.0f);
+    skin.playback->fade = 0.5f;
+    skin.samplePose();
+    skin.commitPose();
+    EXPECT_FLOAT_EQ(node.translation.x, 5.0f);
+
+    gpu::animate(0.5f);
+    EXPECT_FALSE(skin.playback->held);
+    gpu::freePlayback(skin.playback);
+}
+
+TEST(TestPose, AnimateSamplesSkinsOnWorkers) {
+    // every skin walks its own node at its own speed
+    struct Walker {
+        gpu::Node node{};
+        gpu::Animation walk{};
+        gpu::Skin skin{};
+    };
+    std::list<Walker> walkers;
+    for (int i{0}; i < 8; ++i) {
+        Walker &walker = walkers.emplace_back();
+        walker.walk = walkAnimation(&walker.node, "Walk", 10.0f, 10.0f * i);
+        walker.skin.addAnimation(&walker.walk);
+        walker.skin.playback = gpu::createPlayback(&walker.walk, &walker.skin);
+        walker.skin.playback->time = 1.0f;
+        walker.skin.updateInterval = 1;
+    }
+    jobs::start(3);
+    gpu::animate(0.5f);
+    jobs::stop();
+    int i{0};
+    for (Walker &walker : walkers) {
+        EXPECT_FLOAT_EQ(walker.node.translation.x, 1.0f * i++);
+        EXPECT_TRUE(walker.skin.sampled);
+        EXPECT_FLOAT_EQ(walker.skin.playback->time, 1.5f);
+        gpu::freePlayback(walker.skin.playback);
+    }
+}
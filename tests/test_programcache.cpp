@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include "gpu_programcache.h"
+
+#include <cstring>
+
+TEST(TestProgramCache, Fnv1aMatchesReferenceValues) {
+    EXPECT_EQ(gpu::fnv1a(nullptr, 0), 0xcbf29ce484222325ull);
+    EXPECT_EQ(gpu::fnv1a("a", 1), 0xaf63dc4c8601ec8cull);
+    EXPECT_EQ(gpu::fnv1a("foobar", 6), 0x85944171f73967e8ull);
+}
+
+TEST(TestProgramCache, Fnv1aChainsLikeConcatenation) {
+    const char *vertex = "#version 300 es\nvoid main() {}";
+    const char *fragment = "precision mediump float;";
+    const std::string both = std::string{vertex} + fragment;
+    const uint64_t chained =
+        gpu::fnv1a(fragment, strlen(fragment), gpu::fnv1a(vertex, strlen(vertex)));
+    EXPECT_EQ(chained, gpu::fnv1a(both.data(), both.size()));
+    EXPECT_NE(chained, gpu::fnv1a(vertex, strlen(vertex), gpu::fnv1a(fragment, strlen(fragment))));
+}
+
+TEST(TestProgramCache, DisabledUntilOpened) {
+    EXPECT_FALSE(gpu::ProgramCache_enabled());
+    EXPECT_FALSE(gpu::ProgramCache_load(gpu::fnv1a("a", 1), 1));
+    gpu::ProgramCache_store(gpu::fnv1a("a", 1), 1);
+    EXPECT_FALSE(gpu::ProgramCache_enabled());
+}
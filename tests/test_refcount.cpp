@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "gpu.h"
+
+#include <cstring>
+
+static uint32_t _used(const char *pool) {
+    static std::vector<gpu::PoolUsage> pools;
+    gpu::updatePoolUsage(pools);
+    for (const auto &usage : pools) {
+        if (strcmp(usage.name, pool) == 0) {
+            return usage.used;
+        }
+    }
+    return 0;
+}
+
+TEST(TestRefcount, SharedMeshIsFreedWithItsLastNode) {
+    const uint32_t meshes = _used("MESHES");
+    const uint32_t materials = _used("MATERIALS");
+    gpu::Mesh *mesh = gpu::createMesh();
+    gpu::Material *material = gpu::createMaterial();
+    mesh->primitives.emplace_back(nullptr, material);
+    EXPECT_EQ(material->refs, 1);
+
+    gpu::Node *a = gpu::createNode(mesh);
+    gpu::Node *b = gpu::createNode(*a);
+    gpu::freeMesh(mesh);
+    EXPECT_EQ(mesh->refs, 2);
+    EXPECT_EQ(_used("MESHES"), meshes + 1);
+
+    gpu::freeNode(a);
+    EXPECT_EQ(mesh->refs, 1);
+    EXPECT_EQ(_used("MESHES"), meshes + 1);
+    EXPECT_EQ(_used("MATERIALS"), materials + 1);
+
+    gpu::freeNode(b);
+    EXPECT_EQ(_used("MESHES"), meshes);
+    EXPECT_EQ(_used("MATERIALS"), materials);
+}
+
+TEST(TestRefcount, SharedMaterialIsReleasedOnce) {
+    const uint32_t materials = _used("MATERIALS");
+    gpu::Material *material = gpu::createMaterial();
+    gpu::Mesh *first = gpu::createMesh();
+    gpu::Mesh *second = gpu::createMesh();
+    first->primitives.emplace_back(nullptr, gpu::retainMaterial(material));
+    second->primitives.emplace_back(nullptr, gpu::retainMaterial(material));
+    gpu::freeMaterial(material);
+    EXPECT_EQ(material->refs, 2);
+
+    gpu::freeMesh(first);
+    EXPECT_EQ(material->refs, 1);
+    EXPECT_EQ(_used("MATERIALS"), materials + 1);
+    gpu::freeMesh(second);
+    EXPECT_EQ(_used("MATERIALS"), materials);
+}
+
+TEST(TestRefcount, ManyNodesShareOneMesh) {
+    const uint32_t nodes = _used("NODES");
+    gpu::Mesh *mesh = gpu::createMesh();
+    std::vector<gpu::Node *> created;
+    for (size_t i{0}; i < 32; ++i) {
+        created.push_back(gpu::createNode(mesh));
+    }
+    gpu::freeMesh(mesh);
+    EXPECT_EQ(mesh->refs, 32);
+    for (gpu::Node *node : created) {
+        gpu::freeNode(node);
+    }
+    EXPECT_EQ(_used("NODES"), nodes);
+}
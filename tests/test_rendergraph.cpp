@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "blur_renderer.h"
+#include "rendergraph.h"
+
+#include <string>
+
+static const rendergraph::TextureDesc COLOR{64, 32, gpu::ChannelSetting::RGB, GL_UNSIGNED_BYTE};
+
+TEST(TestRenderGraph, PassesWithUnusedWritesAreCulled) {
+    std::string ran;
+    rendergraph::begin(64, 32);
+    const rendergraph::Resource unused = rendergraph::createTexture("unused", COLOR);
+    const rendergraph::Resource color = rendergraph::createTexture("color", COLOR);
+    rendergraph::addPass("unused", {}, {unused}, [&ran] { ran += "u"; });
+    rendergraph::addPass("scene", {}, {color}, [&ran] { ran += "s"; });
+    rendergraph::addPass("readback", {}, {}, [&ran] { ran += "r"; }, true);
+    rendergraph::addPass("screen", {color}, {rendergraph::BACKBUFFER}, [&ran] { ran += "b"; });
+    rendergraph::execute();
+
+    EXPECT_EQ(ran, "srb");
+    const auto &stats = rendergraph::stats();
+    ASSERT_EQ(stats.size(), 4);
+    EXPECT_TRUE(stats[0].culled);
+    EXPECT_FALSE(stats[1].culled);
+    EXPECT_FALSE(stats[2].culled);
+    EXPECT_FALSE(stats[3].culled);
+    EXPECT_EQ(rendergraph::texture(unused), nullptr);
+    EXPECT_EQ(rendergraph::textureCount(), 1);
+    rendergraph::dispose();
+}
+
+TEST(TestRenderGraph, TransientTexturesAliasWhenTheirLifetimesDoNotOverlap) {
+    // a ping-pong chain, each target is read by the next pass only
+    rendergraph::begin(64, 32);
+    rendergraph::Resource chain[4];
+    for (int i{0}; i < 4; ++i) {
+        chain[i] = rendergraph::createTexture("chain", COLOR);
+        if (i == 0) {
+            rendergraph::addPass("first", {}, {chain[i]}, [] {});
+        } else {
+            rendergraph::addPass("next", {chain[i - 1]}, {chain[i]}, [] {});
+        }
+    }
+    const rendergraph::Resource depth = rendergraph::createTexture(
+        "depth", {64, 32, gpu::ChannelSetting::DS, GL_UNSIGNED_INT_24_8});
+    rendergraph::addPass("screen", {chain[3]}, {rendergraph::BACKBUFFER, depth}, [] {});
+    rendergraph::execute();
+
+    EXPECT_NE(rendergraph::texture(chain[0]), rendergraph::texture(chain[1]));
+    EXPECT_EQ(rendergraph::texture(chain[2]), rendergraph::texture(chain[0]));
+    EXPECT_EQ(rendergraph::texture(chain[3]), rendergraph::texture(chain[1]));
+    // other formats never share
+    EXPECT_NE(rendergraph::texture(depth), rendergraph::texture(chain[0]));
+    EXPECT_NE(rendergraph::texture(depth), rendergraph::texture(chain[1]));
+    EXPECT_EQ(rendergraph::textureCount(), 3);
+
+    // the next frame reuses the physical textures
+    rendergraph::begin(64, 32);
+    const rendergraph::Resource color = rendergraph::createTexture("color", COLOR);
+    rendergraph::addPass("scene", {}, {color}, [] {});
+    rendergraph::addPass("screen", {color}, {rendergraph::BACKBUFFER}, [] {});
+    rendergraph::execute();
+    EXPECT_EQ(rendergraph::textureCount(), 3);
+    rendergraph::dispose();
+}
+
+TEST(TestRenderGraph, BlurTargetsShareTwoTextures) {
+    gpu::ShaderProgram program{};
+    program.uniforms = {{"u_horizontal", 0}};
+    BlurRenderer blur;
+    blur.shaderProgram = &program;
+
+    rendergraph::begin(64, 32);
+    const rendergraph::Resource scene = rendergraph::createTexture("scene", COLOR);
+    rendergraph::addPass("scene", {}, {scene}, [] {});
+    const rendergraph::Resource blurred = blur.addPasses(scene, COLOR, 6);
+    rendergraph::addPass("screen", {blurred}, {rendergraph::BACKBUFFER}, [] {});
+    rendergraph::execute();
+
+    ASSERT_EQ(rendergraph::stats().size(), 8);
+    EXPECT_STREQ(rendergraph::stats()[1].name, "blur.h");
+    EXPECT_STREQ(rendergraph::stats()[2].name, "blur.v");
+    // the scene is free once the first blur pass read it, the last target takes its texture
+    EXPECT_EQ(rendergraph::textureCount(), 2);
+    EXPECT_EQ(rendergraph::texture(scene), rendergraph::texture(blurred));
+    rendergraph::dispose();
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "gpu.h"
+
+static const float _positions[] = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+static const uint16_t _indices[] = {0, 1, 2};
+
+// the same triangle, copied into buffers of its own as if loaded from another file
+struct Triangle {
+    float positions[9];
+    uint16_t indices[3];
+    library::Buffer positionBuffer{reinterpret_cast<const unsigned char *>(positions),
+                                   sizeof(positions)};
+    library::Buffer indexBuffer{reinterpret_cast<const unsigned char *>(indices),
+                                sizeof(indices)};
+    library::Bufferview positionView{&positionBuffer, sizeof(positions), 0, 0};
+    library::Bufferview indexView{&indexBuffer, sizeof(indices), 0, 0};
+    library::Accessor position{&positionView, GL_FLOAT, 3, library::Accessor::VEC3};
+    library::Accessor index{&indexView, GL_UNSIGNED_SHORT, 3, library::Accessor::SCALAR};
+    library::Primitive primitive{};
+
+    Triangle() {
+        std::copy(std::begin(_positions), std::end(_positions), positions);
+        std::copy(std::begin(_indices), std::end(_indices), indices);
+        primitive.attributes[library::Primitive::POSITION] = &position;
+        primitive.indices = &index;
+    }
+};
+
+TEST(TestResourceCache, EqualContentKeysEqual) {
+    Triangle a;
+    Triangle b;
+    EXPECT_EQ(gpu::contentKey(a.primitive), gpu::contentKey(b.primitive));
+    EXPECT_EQ(gpu::contentKey(a.primitive).size, sizeof(_positions) + sizeof(_indices));
+    EXPECT_NE(gpu::contentKey(a.primitive).hash, gpu::contentKey(a.primitive).check);
+
+    b.positions[4] = 2.0f;
+    EXPECT_NE(gpu::contentKey(a.primitive), gpu::contentKey(b.primitive));
+    b.positions[4] = 0.0f;
+    b.primitive.attributes[library::Primitive::NORMAL] = &b.position;
+    EXPECT_NE(gpu::contentKey(a.primitive), gpu::contentKey(b.primitive));
+}
+
+TEST(TestResourceCache, MaterialKeyCoversParametersAndImages) {
+    uint8_t pixels[3][4] = {{1, 2, 3, 4}, {1, 2, 3, 4}, {0, 2, 3, 4}};
+    library::Buffer buffers[3] = {{pixels[0], sizeof(pixels[0])},
+                                  {pixels[1], sizeof(pixels[1])},
+                                  {pixels[2], sizeof(pixels[2])}};
+    library::Bufferview views[3] = {{&buffers[0], sizeof(pixels[0]), 0, 0},
+                                    {&buffers[1], sizeof(pixels[1]), 0, 0},
+                                    {&buffers[2], sizeof(pixels[2]), 0, 0}};
+    library::Image images[3]{};
+    library::Texture textures[3]{};
+    for (size_t i{0}; i < 3; ++i) {
+        images[i].view = &views[i];
+        textures[i].image = &images[i];
+    }
+    EXPECT_EQ(gpu::contentKey(textures[0]), gpu::contentKey(textures[1]));
+    EXPECT_NE(gpu::contentKey(textures[0]), gpu::contentKey(textures[2]));
+
+    library::Material a{};
+    a.baseColor = glm::vec4{1.0f};
+    a.roughness = 0.5f;
+    a.textures[library::Material::TEX_DIFFUSE] = &textures[0];
+    library::Material b = a;
+    b.name = "copy";
+    b.textures[library::Material::TEX_DIFFUSE] = &textures[1];
+    EXPECT_EQ(gpu::contentKey(a), gpu::contentKey(b));
+    EXPECT_EQ(gpu::contentKey(a).size, sizeof(pixels[0]));
+
+    b.textures[library::Material::TEX_DIFFUSE] = &textures[2];
+    EXPECT_NE(gpu::contentKey(a), gpu::contentKey(b));
+    b.textures[library::Material::TEX_DIFFUSE] = &textures[1];
+    b.roughness = 1.0f;
+    EXPECT_NE(gpu::contentKey(a), gpu::contentKey(b));
+    // the images are on the stack
+    gpu::forgetImageKeys();
+}
+
+TEST(TestResourceCache, TextureKeyIsHashedOnce) {
+    uint8_t pixels[4] = {1, 2, 3, 4};
+    library::Buffer buffer{pixels, sizeof(pixels)};
+    library::Bufferview view{&buffer, sizeof(pixels), 0, 0};
+    library::Image image{};
+    image.view = &view;
+    library::Texture textures[2]{};
+    textures[0].image = &image;
+    textures[1].image = &image;
+    const gpu::ContentKey key = gpu::contentKey(textures[0]);
+    EXPECT_EQ(key.size, sizeof(pixels));
+    // the image is not read again, not even for another texture of it
+    pixels[0] = 0;
+    EXPECT_EQ(gpu::contentKey(textures[0]), key);
+    EXPECT_EQ(gpu::contentKey(textures[1]), key);
+    gpu::forgetImageKeys();
+    EXPECT_NE(gpu::contentKey(textures[1]), key);
+    gpu::forgetImageKeys();
+}
+
+TEST(TestResourceCache, CountsHitsAndForgetsErased) {
+    gpu::ContentCache<gpu::Primitive> cache;
+    gpu::Primitive primitive{};
+    const gpu::ContentKey key{42, 7, 100};
+    EXPECT_EQ(cache.find(key, 100), nullptr);
+    cache.insert(key, &primitive);
+    EXPECT_EQ(cache.find(key, 100), &primitive);
+    EXPECT_EQ(cache.find(key, 100), &primitive);
+
+    gpu::ResourceCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.entries, 1);
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.bytesSaved, 200);
+
+    cache.erase(&primitive);
+    EXPECT_EQ(cache.find(key, 100), nullptr);
+    EXPECT_EQ(cache.stats().entries, 0);
+}
+
+TEST(TestResourceCache, CollidingHashesAreNotHits) {
+    gpu::ContentCache<gpu::Primitive> cache;
+    gpu::Primitive first{};
+    gpu::Primitive second{};
+    cache.insert({42, 7, 100}, &first);
+    // the same hash of other content, told apart by the check or the size
+    EXPECT_EQ(cache.find({42, 8, 100}, 100), nullptr);
+    EXPECT_EQ(cache.find({42, 7, 99}, 99), nullptr);
+    EXPECT_EQ(cache.stats().hits, 0);
+    EXPECT_EQ(cache.stats().misses, 2);
+
+    cache.insert({42, 8, 100}, &second);
+    EXPECT_EQ(cache.find({42, 8, 100}, 100), &second);
+    EXPECT_EQ(cache.find({42, 7, 100}, 100), nullptr);
+    // first is no longer cached, freeing it leaves the entry of second alone
+    cache.erase(&first);
+    EXPECT_EQ(cache.find({42, 8, 100}, 100), &second);
+}
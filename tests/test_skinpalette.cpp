@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include "gpu.h"
+
+TEST(TestSkinPalette, SkinsBeyondAFullPaletteAreLeftOutOfTheBatch) {
+    // skins of MAX_BONES bones each, two more than the palette holds
+    constexpr size_t count = BYTESIZED_SKINPALETTE_BONES / gpu::MAX_BONES + 2;
+    gpu::Node joint{};
+    library::Skin librarySkin;
+    librarySkin.inverseBindMatrices.assign(gpu::MAX_BONES, glm::mat4{1.0f});
+    std::vector<gpu::Skin> skins(count);
+    std::vector<gpu::Node> nodes(count);
+    std::vector<gpu::Node *> skinned;
+    for (size_t i{0}; i < count; ++i) {
+        skins[i].librarySkin = &librarySkin;
+        skins[i].joints.assign(gpu::MAX_BONES, &joint);
+        skins[i].updateInterval = 1;
+        nodes[i].skin = &skins[i];
+        skinned.push_back(&nodes[i]);
+    }
+    gpu::updateSkinPalettes(skinned);
+
+    // batched skins never share rows, the last MAX_BONES are kept for the others
+    const uint32_t frame = skins[0].paletteFrame;
+    uint32_t batched{0};
+    for (const gpu::Skin &skin : skins) {
+        if (skin.paletteFrame == frame) {
+            EXPECT_EQ(skin.paletteOffset, batched * gpu::MAX_BONES);
+            ++batched;
+        }
+    }
+    EXPECT_EQ(batched, BYTESIZED_SKINPALETTE_BONES / gpu::MAX_BONES - 1);
+    EXPECT_NE(skins[count - 2].paletteFrame, frame);
+    EXPECT_NE(skins[count - 1].paletteFrame, frame);
+}
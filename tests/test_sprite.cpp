@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "sprite.h"
+
+static constexpr auto REGIONS = Spritesheet<3, 1>();
+
+struct SpriteFixture : public ::testing::Test {
+    SpriteRenderer renderer{320.0f, 240.0f};
+
+    void TearDown() override {
+        // the pool outlives the renderer
+        while (!renderer.sprites.empty()) {
+            renderer.freeSprite(renderer.sprites.back());
+        }
+    }
+};
+
+TEST_F(SpriteFixture, FreedSlotsAreReused) {
+    Sprite *first = renderer.createSprite({1.0f, 2.0f}, {3.0f, 4.0f});
+    Sprite *second = renderer.createSprite({5.0f, 6.0f}, {1.0f, 1.0f});
+    first->tint = glm::vec4{0.0f};
+    first->layer = 2;
+    renderer.freeSprite(first);
+    ASSERT_EQ(renderer.sprites.size(), 1u);
+
+    Sprite *third = renderer.createSprite({7.0f, 8.0f}, {2.0f, 2.0f});
+    EXPECT_EQ(third, first);
+    EXPECT_EQ(third->position(), glm::vec2(7.0f, 8.0f));
+    EXPECT_EQ(third->size(), glm::vec2(2.0f, 2.0f));
+    EXPECT_EQ(third->tint, glm::vec4{1.0f});
+    EXPECT_EQ(third->layer, 0);
+
+    // drawn in the order created, not by slot
+    ASSERT_EQ(renderer.sprites.size(), 2u);
+    EXPECT_EQ(renderer.sprites[0], second);
+    EXPECT_EQ(renderer.sprites[1], third);
+}
+
+TEST_F(SpriteFixture, UpdateAdvancesFramesAndWraps) {
+    Sprite *sprite = renderer.createSprite({0.0f, 0.0f}, {1.0f, 1.0f});
+    Sprite *still = renderer.createSprite({0.0f, 0.0f}, {1.0f, 1.0f});
+    sprite->animations.push_back(
+        {nullptr, {{REGIONS[0], 100}, {REGIONS[1], 50}, {REGIONS[2], 100}}});
+    ASSERT_TRUE(sprite->setAnimation(0));
+    auto &frames = sprite->animation_it->frames;
+
+    renderer.update(60);
+    EXPECT_EQ(sprite->frame_it, frames.begin());
+    EXPECT_EQ(sprite->frame_ms, 40);
+
+    // the time past the end of a frame is taken from the next
+    renderer.update(60);
+    EXPECT_EQ(sprite->frame_it, frames.begin() + 1);
+    EXPECT_EQ(sprite->frame_ms, 30);
+    renderer.update(30);
+    EXPECT_EQ(sprite->frame_it, frames.begin() + 2);
+    EXPECT_EQ(sprite->frame_ms, 100);
+    renderer.update(100);
+    EXPECT_EQ(sprite->frame_it, frames.begin());
+    EXPECT_EQ(sprite->frame_ms, 100);
+
+    EXPECT_TRUE(still->animations.empty());
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "staticbatch.h"
+
+#include <list>
+
+// a unit quad in the xy plane, two triangles
+static const glm::vec3 _positions[] = {
+    {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}};
+static const glm::vec3 _normals[] = {
+    {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}};
+static const uint16_t _indices[] = {0, 1, 2, 2, 1, 3};
+
+struct Quads {
+    library::Buffer positionBuffer{reinterpret_cast<const unsigned char *>(_positions),
+                                   sizeof(_positions)};
+    library::Buffer normalBuffer{reinterpret_cast<const unsigned char *>(_normals),
+                                 sizeof(_normals)};
+    library::Buffer indexBuffer{reinterpret_cast<const unsigned char *>(_indices),
+                                sizeof(_indices)};
+    library::Bufferview positionView{&positionBuffer, sizeof(_positions), 0, 0};
+    library::Bufferview normalView{&normalBuffer, sizeof(_normals), 0, 0};
+    library::Bufferview indexView{&indexBuffer, sizeof(_indices), 0, 0};
+    library::Accessor position{&positionView, GL_FLOAT, 4, library::Accessor::VEC3};
+    library::Accessor normal{&normalView, GL_FLOAT, 4, library::Accessor::VEC3};
+    library::Accessor index{&indexView, GL_UNSIGNED_SHORT, 6, library::Accessor::SCALAR};
+    library::Mesh libraryMesh;
+    gpu::Material materials[2]{};
+    gpu::Primitive primitive{};
+    std::list<gpu::Mesh> meshes;
+    std::list<gpu::Node> nodes;
+
+    Quads() {
+        library::Primitive &libraryPrimitive = libraryMesh.primitives.emplace_back();
+        libraryPrimitive.attributes[library::Primitive::POSITION] = &position;
+        libraryPrimitive.attributes[library::Primitive::NORMAL] = &normal;
+        libraryPrimitive.indices = &index;
+    }
+
+    gpu::Node *create(const glm::vec3 &translation, size_t material) {
+        gpu::Mesh &mesh = meshes.emplace_back();
+        mesh.libraryMesh = &libraryMesh;
+        mesh.primitives = {{&primitive, &materials[material]}};
+        gpu::Node &node = nodes.emplace_back();
+        node.mesh = &mesh;
+        node.translation = translation;
+        return &node;
+    }
+};
+
+TEST(TestStaticBatch, NodesGoToTheCellOfTheirPosition) {
+    Quads quads;
+    StaticBatch batch{10.0f};
+    batch.add(quads.create({1.0f, 0.0f, 1.0f}, 0));
+    batch.add(quads.create({9.0f, 0.0f, 9.0f}, 0));
+    batch.add(quads.create({-1.0f, 0.0f, 12.0f}, 0));
+    ASSERT_EQ(batch.cells.size(), 2);
+    EXPECT_EQ(batch.cells[0].key, (glm::ivec3{0, 0, 0}));
+    EXPECT_EQ(batch.cells[0].nodes.size(), 2);
+    EXPECT_EQ(batch.cells[1].key, (glm::ivec3{-1, 0, 1}));
+    EXPECT_EQ(batch.cells[1].nodes.size(), 1);
+}
+
+TEST(TestStaticBatch, BuildCellMergesPerMaterial) {
+    Quads quads;
+    StaticBatch batch;
+    batch.add(quads.create({2.0f, 0.0f, 0.0f}, 0));
+    batch.add(quads.create({4.0f, 0.0f, 0.0f}, 1));
+    gpu::Node *scaled = quads.create({6.0f, 0.0f, 0.0f}, 0);
+    scaled->scale = glm::vec3{2.0f, 2.0f, 1.0f};
+    batch.add(scaled);
+    gpu::Node *hidden = quads.create({8.0f, 0.0f, 0.0f}, 0);
+    hidden->hidden = true;
+    batch.add(hidden);
+    ASSERT_EQ(batch.cells.size(), 1);
+
+    std::vector<BakedGeometry> geometry;
+    batch.buildCell(batch.cells[0], geometry);
+    ASSERT_EQ(geometry.size(), 2);
+    EXPECT_EQ(geometry[0].material, &quads.materials[0]);
+    ASSERT_EQ(geometry[0].vertices.size(), 8);
+    EXPECT_EQ(geometry[0].indices,
+              (std::vector<uint32_t>{0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7}));
+    EXPECT_EQ(geometry[1].material, &quads.materials[1]);
+    EXPECT_EQ(geometry[1].indices.size(), 6);
+
+    // vertices are in world space
+    EXPECT_FLOAT_EQ(geometry[0].vertices[1].position.x, 3.0f);
+    EXPECT_FLOAT_EQ(geometry[0].vertices[7].position.x, 8.0f);
+    EXPECT_FLOAT_EQ(geometry[0].vertices[7].position.y, 2.0f);
+    EXPECT_FLOAT_EQ(geometry[0].vertices[7].normal.z, 1.0f);
+}
+
+TEST(TestStaticBatch, ExcludeDirtiesOnlyItsCell) {
+    Quads quads;
+    StaticBatch batch{10.0f};
+    gpu::Node *a = quads.create({1.0f, 0.0f, 0.0f}, 0);
+    gpu::Node *b = quads.create({21.0f, 0.0f, 0.0f}, 0);
+    batch.add(a);
+    batch.add(b);
+    for (auto &cell : batch.cells) {
+        cell.dirty = false;
+    }
+
+    EXPECT_EQ(batch.exclude(a), nullptr);
+    EXPECT_FALSE(batch.contains(a));
+    EXPECT_TRUE(batch.cells[0].dirty);
+    EXPECT_FALSE(batch.cells[1].dirty);
+    batch.cells[0].dirty = false;
+
+    // moved while excluded, comes back in the cell of its new position
+    a->translation = glm::vec3{25.0f, 0.0f, 0.0f};
+    EXPECT_EQ(batch.exclude(nullptr), a);
+    batch.add(a);
+    EXPECT_FALSE(batch.cells[0].dirty);
+    EXPECT_TRUE(batch.cells[1].dirty);
+    EXPECT_EQ(batch.cells[1].nodes.size(), 2);
+
+    batch.remove(b);
+    EXPECT_FALSE(batch.contains(b));
+    EXPECT_EQ(batch.cells[1].nodes, (std::vector<gpu::Node *>{a}));
+}
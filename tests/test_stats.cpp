@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "gpu.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+static std::string _read(const std::string &path) {
+    std::ifstream file{path};
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+static void _frame(uint32_t draws) {
+    gpu::Stats_beginFrame();
+    for (uint32_t i{0}; i < draws; ++i) {
+        gpu::Stats_draw(GL_TRIANGLES, 6);
+    }
+    gpu::Stats_endFrame();
+}
+
+class TestStats : public ::testing::Test {
+  protected:
+    void TearDown() override {
+        gpu::Stats_stopCapture();
+        gpu::Stats_setBudget({});
+    }
+};
+
+TEST_F(TestStats, CountsFrame) {
+    gpu::Stats_beginFrame();
+    gpu::Stats_draw(GL_TRIANGLES, 36);
+    gpu::Stats_draw(GL_TRIANGLE_STRIP, 4, 100);
+    gpu::Stats_draw(GL_LINES, 2);
+    gpu::Stats_stateChange(gpu::StateChange::PROGRAM);
+    gpu::Stats_stateChange(gpu::StateChange::TEXTURE);
+    gpu::Stats_stateChange(gpu::StateChange::TEXTURE);
+    gpu::Stats_uniformUpload();
+    gpu::Stats_bufferUpload(64);
+    gpu::Stats_textureUpload(1024);
+    gpu::Stats_endFrame();
+
+    const gpu::FrameStats &stats = gpu::Stats_lastFrame();
+    EXPECT_EQ(stats.drawCalls, 3);
+    EXPECT_EQ(stats.triangles, 12 + 200);
+    EXPECT_EQ(stats.stateChanges[static_cast<size_t>(gpu::StateChange::PROGRAM)], 1);
+    EXPECT_EQ(stats.stateChanges[static_cast<size_t>(gpu::StateChange::TEXTURE)], 2);
+    EXPECT_EQ(stats.uniformUploads, 1);
+    EXPECT_EQ(stats.bufferBytes, 64);
+    EXPECT_EQ(stats.textureBytes, 1024);
+    EXPECT_FALSE(gpu::Stats_pools().empty());
+
+    const uint64_t frame = stats.frame;
+    _frame(1);
+    EXPECT_EQ(gpu::Stats_lastFrame().frame, frame + 1);
+    EXPECT_EQ(gpu::Stats_lastFrame().drawCalls, 1);
+    EXPECT_EQ(gpu::Stats_lastFrame().bufferBytes, 0);
+}
+
+TEST_F(TestStats, Budget) {
+    gpu::Stats_setBudget({2, 0, 0, 0, 0});
+    _frame(2);
+    EXPECT_EQ(gpu::Stats_framesOverBudget(), 0);
+    _frame(3);
+    _frame(4);
+    _frame(1);
+    EXPECT_EQ(gpu::Stats_framesOverBudget(), 2);
+    gpu::Stats_setBudget({});
+    _frame(10);
+    EXPECT_EQ(gpu::Stats_framesOverBudget(), 0);
+}
+
+TEST_F(TestStats, CaptureCsv) {
+    const std::string path = testing::TempDir() + "stats.csv";
+    ASSERT_TRUE(gpu::Stats_startCapture(path.c_str()));
+    _frame(2);
+    _frame(5);
+    gpu::Stats_stopCapture();
+
+    std::istringstream lines{_read(path)};
+    std::string header, first, second, rest;
+    std::getline(lines, header);
+    std::getline(lines, first);
+    std::getline(lines, second);
+    EXPECT_FALSE(std::getline(lines, rest));
+    EXPECT_EQ(header.rfind("frame,cpu_ms,draw_calls,triangles,", 0), 0);
+    EXPECT_NE(header.find("NODES_used,NODES_high"), std::string::npos);
+    const auto columns = [](const std::string &line) {
+        return std::count(line.begin(), line.end(), ',');
+    };
+    EXPECT_EQ(columns(first), columns(header));
+    EXPECT_NE(second.find(",5,10,"), std::string::npos);
+}
+
+TEST_F(TestStats, CaptureJson) {
+    const std::string path = testing::TempDir() + "stats.json";
+    ASSERT_TRUE(gpu::Stats_startCapture(path.c_str()));
+    _frame(2);
+    _frame(3);
+    gpu::Stats_stopCapture();
+
+    const std::string json = _read(path);
+    EXPECT_EQ(json.front(), '[');
+    EXPECT_EQ(json.substr(json.size() - 3), "\n]\n");
+    EXPECT_NE(json.find("\"draw_calls\": 2,"), std::string::npos);
+    EXPECT_NE(json.find("}},\n  {\"frame\""), std::string::npos);
+    EXPECT_NE(json.find("\"draw_calls\": 3,"), std::string::npos);
+}
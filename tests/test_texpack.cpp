@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include "texpack.h"
+#include <algorithm>
+#include <cstring>
+
+static void _decodeBC1(const uint8_t block[8], uint8_t rgb[16][3]) {
+    const uint16_t c[2] = {static_cast<uint16_t>(block[0] | block[1] << 8),
+                           static_cast<uint16_t>(block[2] | block[3] << 8)};
+    int palette[4][3];
+    for (int i{0}; i < 2; ++i) {
+        palette[i][0] = (c[i] >> 11 & 0x1F) * 255 / 31;
+        palette[i][1] = (c[i] >> 5 & 0x3F) * 255 / 63;
+        palette[i][2] = (c[i] & 0x1F) * 255 / 31;
+    }
+    for (int j{0}; j < 3; ++j) {
+        palette[2][j] = (2 * palette[0][j] + palette[1][j]) / 3;
+        palette[3][j] = (palette[0][j] + 2 * palette[1][j]) / 3;
+    }
+    const uint32_t indices = block[4] | block[5] << 8 | block[6] << 16 | block[7] << 24;
+    for (int i{0}; i < 16; ++i) {
+        for (int j{0}; j < 3; ++j) {
+            rgb[i][j] = palette[indices >> (i * 2) & 3][j];
+        }
+    }
+}
+
+static int _decodeETCPixel(const uint8_t block[8], int x, int y, int channel) {
+    static constexpr int modifiers[8][4] = {
+        {2, 8, -2, -8},     {5, 17, -5, -17},   {9, 29, -9, -29},     {13, 42, -13, -42},
+        {18, 60, -18, -60}, {24, 80, -24, -80}, {33, 106, -33, -106}, {47, 183, -47, -183},
+    };
+    const bool diff = block[3] & 2;
+    const bool flip = block[3] & 1;
+    const int subblock = flip ? y >= 2 : x >= 2;
+    int base;
+    if (diff) {
+        int b = block[channel] >> 3;
+        if (subblock) {
+            int delta = block[channel] & 7;
+            b += delta >= 4 ? delta - 8 : delta;
+        }
+        base = b << 3 | b >> 2;
+    } else {
+        const int b = subblock ? block[channel] & 0xF : block[channel] >> 4;
+        base = b << 4 | b;
+    }
+    const int table = subblock ? block[3] >> 2 & 7 : block[3] >> 5;
+    const int p = x * 4 + y;
+    const int msb = block[5 - p / 8] >> (p % 8) & 1;
+    const int lsb = block[7 - p / 8] >> (p % 8) & 1;
+    return std::clamp(base + modifiers[table][msb << 1 | lsb], 0, 255);
+}
+
+static void _gradient(uint8_t rgba[64]) {
+    for (int i{0}; i < 16; ++i) {
+        rgba[i * 4 + 0] = 60 + i * 8;
+        rgba[i * 4 + 1] = 100 + i * 8;
+        rgba[i * 4 + 2] = 30 + i * 8;
+        rgba[i * 4 + 3] = 255 - i * 16;
+    }
+}
+
+TEST(TestTexpack, LevelSizes) {
+    EXPECT_EQ(texpack::levelCount(1, 1), 1);
+    EXPECT_EQ(texpack::levelCount(256, 64), 9);
+    EXPECT_EQ(texpack::levelSize(texpack::BC1, 256, 256), 64 * 64 * 8);
+    EXPECT_EQ(texpack::levelSize(texpack::BC3, 2, 2), 16);
+    EXPECT_EQ(texpack::levelSize(texpack::RGBA8, 3, 5), 3 * 5 * 4);
+}
+
+TEST(TestTexpack, Downsample) {
+    const uint8_t src[] = {0, 0, 0, 0, 100, 100, 100, 100, 200, 200, 200, 200, 44, 44, 44, 44};
+    uint8_t dst[4];
+    texpack::downsample(src, 2, 2, dst);
+    EXPECT_EQ(dst[0], 86);
+    EXPECT_EQ(dst[3], 86);
+}
+
+TEST(TestTexpack, BC1) {
+    uint8_t rgba[64];
+    _gradient(rgba);
+    uint8_t block[8];
+    texpack::encodeBC1(rgba, block);
+    uint8_t rgb[16][3];
+    _decodeBC1(block, rgb);
+    for (int i{0}; i < 16; ++i) {
+        for (int j{0}; j < 3; ++j) {
+            EXPECT_NEAR(rgb[i][j], rgba[i * 4 + j], 24);
+        }
+    }
+}
+
+TEST(TestTexpack, ETC2) {
+    uint8_t rgba[64];
+    _gradient(rgba);
+    uint8_t block[8];
+    texpack::encodeETC2RGB(rgba, block);
+    for (int i{0}; i < 16; ++i) {
+        for (int j{0}; j < 3; ++j) {
+            EXPECT_NEAR(_decodeETCPixel(block, i % 4, i / 4, j), rgba[i * 4 + j], 24);
+        }
+    }
+}
+
+TEST(TestTexpack, Pack) {
+    uint8_t rgba[8 * 4 * 4];
+    for (size_t i{0}; i < sizeof(rgba); ++i) {
+        rgba[i] = static_cast<uint8_t>(i * 7);
+    }
+    auto packed = texpack::pack(rgba, 8, 4, texpack::BC3);
+    texpack::Header header;
+    ASSERT_TRUE(texpack::header(packed.data(), packed.size(), header));
+    EXPECT_EQ(header.format, texpack::BC3);
+    EXPECT_EQ(header.levels, 4);
+    EXPECT_EQ(header.sizes[0], 2 * 16);
+    EXPECT_EQ(header.sizes[3], 16);
+    EXPECT_EQ(header.offsets[3] + header.sizes[3], packed.size());
+    EXPECT_FALSE(texpack::header(packed.data(), packed.size() - 1, header));
+    EXPECT_FALSE(texpack::header(rgba, sizeof(rgba), header));
+
+    // unaligned, and with a level size that does not match the dimensions
+    std::vector<uint8_t> shifted(packed.size() + 1);
+    std::copy(packed.begin(), packed.end(), shifted.begin() + 1);
+    EXPECT_TRUE(texpack::header(shifted.data() + 1, packed.size(), header));
+    header.sizes[1] = 8;
+    std::memcpy(shifted.data() + 1, &header, sizeof(header));
+    EXPECT_FALSE(texpack::header(shifted.data() + 1, packed.size(), header));
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "bdf.h"
+#include "gpu.h"
+
+struct FontFixture : public ::testing::Test {
+    bdf::Font font{};
+    gpu::Text text{};
+
+    void SetUp() override {
+        font.pw = 6;
+        font.ph = 10;
+        font.px = 1;
+        font.py = -2;
+        text.bdfFont = &font;
+    }
+};
+
+TEST_F(FontFixture, VersionChangesWithTheGlyphs) {
+    text.setText("hp", false);
+    const uint32_t version = text.version;
+    EXPECT_NE(version, 0u);
+
+    // the same value from another buffer lays out nothing new
+    const char again[] = "hp";
+    text.setText(again, false);
+    EXPECT_EQ(text.version, version);
+    EXPECT_EQ(text.value, text.content.c_str());
+
+    text.setText("hp", true);
+    EXPECT_GT(text.version, version);
+    const uint32_t centered = text.version;
+    text.setText("mp", true);
+    EXPECT_GT(text.version, centered);
+}
+
+TEST_F(FontFixture, GlyphsAdvanceAlongTheAtlas) {
+    text.setText("AB", false);
+    ASSERT_EQ(text.glyphs.size(), 2u);
+    EXPECT_EQ(text.glyphs[0], glm::vec4(1.0f, -2.0f, 1.0f / 16.0f, 3.0f / 8.0f));
+    EXPECT_EQ(text.glyphs[1], glm::vec4(7.0f, -2.0f, 2.0f / 16.0f, 3.0f / 8.0f));
+    EXPECT_EQ(text.width(), 12.0f);
+    EXPECT_EQ(text.height(), 10.0f);
+}
+
+TEST_F(FontFixture, CenteringOffsetsByHalfTheSize) {
+    text.setText("AB", true);
+    ASSERT_EQ(text.glyphs.size(), 2u);
+    EXPECT_EQ(text.glyphs[0].x, 1.0f - 6.0f);
+    EXPECT_EQ(text.glyphs[0].y, -2.0f - 5.0f);
+    EXPECT_EQ(text.glyphs[1].x, 1.0f);
+}
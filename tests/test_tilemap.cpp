@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "tilemap.h"
+
+#include <chrono>
+#include <glm/gtc/matrix_transform.hpp>
+
+static constexpr auto _regions = Spritesheet<4, 4>();
+
+TEST(TestTilemap, SetDirtiesOnlyItsChunk) {
+    TileLayer layer{100, 70, glm::vec2{16.0f}, nullptr, _regions};
+    EXPECT_EQ(layer.chunksX, 4);
+    EXPECT_EQ(layer.chunksY, 3);
+    for (auto &chunk : layer.chunks) {
+        chunk.dirty = false;
+    }
+    layer.set(40, 65, 3);
+    for (uint32_t i{0}; i < layer.chunks.size(); ++i) {
+        EXPECT_EQ(layer.chunks[i].dirty, i == 2 * 4 + 1);
+    }
+    layer.chunks[9].dirty = false;
+    layer.set(40, 65, 3);
+    EXPECT_FALSE(layer.chunks[9].dirty);
+    EXPECT_EQ(layer.get(40, 65), 3);
+}
+
+TEST(TestTilemap, BuildChunkSkipsEmptyTiles) {
+    TileLayer layer{40, 40, glm::vec2{8.0f}, nullptr, _regions};
+    layer.set(1, 2, 5);
+    layer.set(33, 1, 0);
+    std::vector<TileVertex> vertices;
+    EXPECT_EQ(layer.buildChunk(0, vertices), 1);
+    ASSERT_EQ(vertices.size(), 4);
+    EXPECT_FLOAT_EQ(vertices[0].position.x, 8.0f);
+    EXPECT_FLOAT_EQ(vertices[0].position.y, 16.0f);
+    EXPECT_FLOAT_EQ(vertices[3].position.x, 16.0f);
+    EXPECT_FLOAT_EQ(vertices[3].position.y, 24.0f);
+    EXPECT_FLOAT_EQ(vertices[0].uv.x, _regions[5].bottomLeft.x);
+    EXPECT_FLOAT_EQ(vertices[0].uv.y, _regions[5].bottomLeft.y);
+
+    vertices.clear();
+    EXPECT_EQ(layer.buildChunk(1, vertices), 1);
+    EXPECT_EQ(layer.buildChunk(2, vertices), 0);
+    EXPECT_EQ(vertices.size(), 4);
+}
+
+TEST(TestTilemap, VisibleChunks) {
+    TileLayer layer{256, 256, glm::vec2{16.0f}, nullptr, _regions};
+    std::vector<uint32_t> visible;
+    layer.visibleChunks(glm::ortho(0.0f, 800.0f, 0.0f, 600.0f, -1.0f, 1.0f), visible);
+    // chunks are 512 pixels wide
+    EXPECT_EQ(visible, (std::vector<uint32_t>{0, 1, 8, 9}));
+
+    visible.clear();
+    layer.origin = glm::vec2{-1000.0f, 0.0f};
+    layer.visibleChunks(glm::ortho(0.0f, 800.0f, 0.0f, 600.0f, -1.0f, 1.0f), visible);
+    EXPECT_EQ(visible, (std::vector<uint32_t>{1, 2, 3, 9, 10, 11}));
+
+    visible.clear();
+    layer.visibleChunks(glm::ortho(-3000.0f, -2000.0f, 0.0f, 600.0f, -1.0f, 1.0f), visible);
+    EXPECT_TRUE(visible.empty());
+}
+
+TEST(TestTilemap, BuildsAndCullsAFilledMap) {
+    // 100x100 tiles in 4x4 chunks of 32, the chunk at 2, 1 left empty
+    TileLayer layer{100, 100, glm::vec2{16.0f}, nullptr, _regions};
+    for (uint32_t y{0}; y < layer.height; ++y) {
+        for (uint32_t x{0}; x < layer.width; ++x) {
+            if (x / TileLayer::CHUNK_SIZE != 2 || y / TileLayer::CHUNK_SIZE != 1) {
+                layer.set(x, y, static_cast<uint16_t>((x * 7 + y * 13) % _regions.size()));
+            }
+        }
+    }
+    ASSERT_EQ(layer.chunks.size(), 16);
+
+    std::vector<TileVertex> vertices;
+    uint32_t quads{0};
+    for (uint32_t i{0}; i < layer.chunks.size(); ++i) {
+        vertices.clear();
+        layer.chunks[i].quads = layer.buildChunk(i, vertices);
+        EXPECT_EQ(vertices.size(), layer.chunks[i].quads * 4);
+        quads += layer.chunks[i].quads;
+    }
+    EXPECT_EQ(quads, 100 * 100 - 32 * 32);
+    EXPECT_EQ(layer.chunks[0].quads, 32 * 32);
+    EXPECT_EQ(layer.chunks[3].quads, 4 * 32);
+    EXPECT_EQ(layer.chunks[15].quads, 4 * 4);
+
+    // a 1280x720 view from 600, 500 overlaps 3x3 chunks, the empty one is not drawn
+    std::vector<uint32_t> visible;
+    layer.visibleChunks(glm::ortho(600.0f, 1880.0f, 500.0f, 1220.0f, -1.0f, 1.0f), visible);
+    EXPECT_EQ(visible, (std::vector<uint32_t>{1, 2, 3, 5, 6, 7, 9, 10, 11}));
+    uint32_t draws{0};
+    for (uint32_t index : visible) {
+        draws += layer.chunks[index].quads > 0;
+    }
+    EXPECT_EQ(draws, 8);
+}
+
+// timings only, run with --gtest_also_run_disabled_tests
+TEST(TestTilemap, DISABLED_Benchmark1MTiles) {
+    using clock = std::chrono::steady_clock;
+    TileLayer layer{1000, 1000, glm::vec2{16.0f}, nullptr, _regions};
+    for (uint32_t y{0}; y < layer.height; ++y) {
+        for (uint32_t x{0}; x < layer.width; ++x) {
+            layer.set(x, y, static_cast<uint16_t>((x * 7 + y * 13) % _regions.size()));
+        }
+    }
+
+    auto start = clock::now();
+    std::vector<TileVertex> vertices;
+    uint32_t quads{0};
+    for (uint32_t i{0}; i < layer.chunks.size(); ++i) {
+        vertices.clear();
+        quads += layer.buildChunk(i, vertices);
+    }
+    const std::chrono::duration<float, std::milli> build = clock::now() - start;
+    EXPECT_EQ(quads, 1000000);
+
+    // a 1280x720 view panned across the whole map, one frame per 4 pixels
+    start = clock::now();
+    std::vector<uint32_t> visible;
+    size_t visited{0};
+    for (float x{0.0f}; x < 16000.0f - 1280.0f; x += 4.0f) {
+        visible.clear();
+        layer.visibleChunks(glm::ortho(x, x + 1280.0f, x * 0.5f, x * 0.5f + 720.0f, -1.0f, 1.0f),
+                            visible);
+        EXPECT_LE(visible.size(), 12);
+        visited += visible.size();
+    }
+    const std::chrono::duration<float, std::milli> cull = clock::now() - start;
+
+    printf("1M tiles: %zu chunks built in %.2f ms, %zu visible chunks culled in %.2f ms\n",
+           layer.chunks.size(), build.count(), visited, cull.count());
+}
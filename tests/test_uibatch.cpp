@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "bdf.h"
+#include "gpu.h"
+
+struct UIBatchFixture : public ::testing::Test {
+    gpu::Texture panelTexture{1};
+    gpu::Texture atlas{2};
+    bdf::Font font{};
+    gpu::Node node{};
+    gpu::Text text{};
+    gpu::UIBatch batch;
+
+    void SetUp() override {
+        font.pw = 6;
+        font.ph = 10;
+        font.gpuInstance = &atlas;
+        text.bdfFont = &font;
+        text.node = &node;
+    }
+};
+
+TEST_F(UIBatchFixture, QuadCornersAndUvs) {
+    const glm::vec4 color{1.0f, 0.5f, 0.25f, 1.0f};
+    batch.quad(&panelTexture, {10.0f, 20.0f}, {4.0f, 2.0f}, {0.5f, 0.0f}, {0.5f, 0.25f}, color);
+    const auto &vertices = batch.vertices();
+    ASSERT_EQ(vertices.size(), 4u);
+    EXPECT_EQ(vertices[0].position, glm::vec2(10.0f, 20.0f));
+    EXPECT_EQ(vertices[1].position, glm::vec2(14.0f, 20.0f));
+    EXPECT_EQ(vertices[2].position, glm::vec2(10.0f, 22.0f));
+    EXPECT_EQ(vertices[3].position, glm::vec2(14.0f, 22.0f));
+    EXPECT_EQ(vertices[0].uv, glm::vec2(0.5f, 0.0f));
+    EXPECT_EQ(vertices[3].uv, glm::vec2(1.0f, 0.25f));
+    EXPECT_EQ(vertices[2].color, color);
+}
+
+TEST_F(UIBatchFixture, PanelsThenTextsMakeTwoRuns) {
+    text.setText("ok", false);
+    batch.quad(&panelTexture, {}, {1.0f, 1.0f}, {}, {1.0f, 1.0f}, glm::vec4{1.0f});
+    batch.quad(&panelTexture, {}, {1.0f, 1.0f}, {}, {1.0f, 1.0f}, glm::vec4{1.0f});
+    batch.text(&text, glm::vec4{1.0f});
+    batch.text(&text, glm::vec4{1.0f});
+    EXPECT_EQ(batch.pendingRuns(), 2u);
+    EXPECT_EQ(batch.vertices().size(), (2u + 4u) * 4u);
+
+    // interleaving breaks the runs up
+    batch.quad(&panelTexture, {}, {1.0f, 1.0f}, {}, {1.0f, 1.0f}, glm::vec4{1.0f});
+    EXPECT_EQ(batch.pendingRuns(), 3u);
+}
+
+TEST_F(UIBatchFixture, GlyphQuadsFollowTheLayout) {
+    node.translation = glm::vec3{100.0f, 50.0f, 0.0f};
+    text.setText("A", false);
+    batch.text(&text, glm::vec4{1.0f});
+    const auto &vertices = batch.vertices();
+    ASSERT_EQ(vertices.size(), 4u);
+    EXPECT_EQ(vertices[0].position, glm::vec2(100.0f, 50.0f));
+    EXPECT_EQ(vertices[3].position, glm::vec2(106.0f, 60.0f));
+    EXPECT_EQ(vertices[0].uv, glm::vec2(text.glyphs[0].z, text.glyphs[0].w));
+    EXPECT_EQ(vertices[3].uv, vertices[0].uv + glm::vec2(1.0f / 16.0f, 1.0f / 8.0f));
+}
+
+TEST_F(UIBatchFixture, OverflowIsDropped) {
+    for (uint32_t i{0}; i < BYTESIZED_UIBATCH_QUADS; ++i) {
+        batch.quad(&panelTexture, {}, {1.0f, 1.0f}, {}, {1.0f, 1.0f}, glm::vec4{1.0f});
+    }
+    text.setText("full", false);
+    batch.text(&text, glm::vec4{1.0f});
+    batch.quad(&panelTexture, {}, {1.0f, 1.0f}, {}, {1.0f, 1.0f}, glm::vec4{1.0f});
+    EXPECT_EQ(batch.vertices().size(), BYTESIZED_UIBATCH_QUADS * 4u);
+    EXPECT_EQ(batch.pendingRuns(), 1u);
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include "bytesized_info.h"
+#include "gpu_uniformstream.h"
+
+TEST(TestUniformStream, BlocksAreAlignedWithinTheRegion) {
+    gpu::UniformRing ring{256, 1024, 1, 0};
+    EXPECT_EQ(ring.alignUp(1), 256u);
+    EXPECT_EQ(ring.alignUp(256), 256u);
+    EXPECT_EQ(ring.take(64), 1024u);
+    EXPECT_EQ(ring.take(300), 1024u + 256u);
+    EXPECT_EQ(ring.offset, 768u);
+}
+
+TEST(TestUniformStream, FullRegionIsDetected) {
+    gpu::UniformRing ring{256, 1024, 0, 0};
+    ring.take(512);
+    EXPECT_TRUE(ring.fits(512));
+    ring.take(256);
+    EXPECT_TRUE(ring.fits(1));
+    EXPECT_FALSE(ring.fits(257));
+    ring.take(1);
+    EXPECT_FALSE(ring.fits(1));
+}
+
+TEST(TestUniformStream, RegionsWrapAfterTheLastFrame) {
+    gpu::UniformRing ring{256, 1024, 0, 0};
+    ring.take(16);
+    for (uint32_t i{1}; i <= BYTESIZED_UNIFORMSTREAM_FRAMES; ++i) {
+        ring.enter(ring.next());
+        EXPECT_EQ(ring.region, i % BYTESIZED_UNIFORMSTREAM_FRAMES);
+        EXPECT_EQ(ring.offset, 0u);
+    }
+    EXPECT_EQ(ring.take(16), 0u);
+}